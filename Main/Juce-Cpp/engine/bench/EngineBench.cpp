@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include "ChannelDSP.h"
+#include "FxDelay.h"
+#include "FxGrossBeat.h"
+#include "SampleVoice.h"
+#include "instruments/DrumRuntime.h"
+#include "instruments/FmInstrumentFactory.h"
+#include "instruments/InstrumentRegistry.h"
+#include "instruments/fm/FmEngine.h"
+#include "instruments/fm/FmVoice.h"
+
+/*
+  sls-engine-bench
+  ================
+  Repeatable micro-benchmarks for the engine's hot DSP kernels.
+
+  Usage: sls-engine-bench [--json] [--filter <substring>] [--seconds <s>] [--repeat <n>]
+
+  - Every case renders 512-frame blocks at 48 kHz for ~--seconds of audio per
+    run, --repeat runs, and reports the fastest run (least disturbed by the OS).
+  - nsPerSample is the cost of one stereo frame of one instance (voice, kit, FX);
+    cases rendering several voices at once divide by their voice count.
+  - voicesPerCore = how many such instances one core sustains in realtime at 48 kHz.
+  - --json prints one JSON document so runs can be diffed across commits.
+*/
+
+namespace {
+
+constexpr double kSampleRate = 48000.0;
+constexpr int    kBlockSize  = 512;
+
+struct BenchCase {
+  std::string name;
+  std::function<void()> prepare;              // called before every run
+  std::function<void(float*, float*, int)> render; // adds one block into l/r
+  int instances = 1;                           // voices rendered by one call
+};
+
+struct BenchResult {
+  std::string name;
+  double nsPerSample = 0.0;
+  double voicesPerCore = 0.0;
+};
+
+volatile float gSink = 0.0f; // keeps the optimizer from discarding the output
+
+// FM patches are compiled through a library, as in the engine.
+sls::engine::fm::FmPatchLibrary& benchPatches() {
+  static sls::engine::fm::FmPatchLibrary library;
+  return library;
+}
+
+BenchResult runCase(const BenchCase& c, double seconds, int repeat) {
+  std::vector<float> l((size_t)kBlockSize), r((size_t)kBlockSize);
+  const int blocks = std::max(1, (int)std::ceil(seconds * kSampleRate / (double)kBlockSize));
+
+  double best = std::numeric_limits<double>::max();
+  for (int run = 0; run < std::max(1, repeat); ++run) {
+    c.prepare();
+    float acc = 0.0f;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int b = 0; b < blocks; ++b) {
+      std::fill(l.begin(), l.end(), 0.0f);
+      std::fill(r.begin(), r.end(), 0.0f);
+      c.render(l.data(), r.data(), kBlockSize);
+      acc += l[(size_t)(b % kBlockSize)] + r[(size_t)((b * 7) % kBlockSize)];
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    gSink = gSink + acc;
+    best = std::min(best, (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+  }
+
+  BenchResult res;
+  res.name = c.name;
+  res.nsPerSample = best / ((double)blocks * (double)kBlockSize * (double)std::max(1, c.instances));
+  res.voicesPerCore = res.nsPerSample > 0.0 ? (1.0e9 / kSampleRate) / res.nsPerSample : 0.0;
+  return res;
+}
+
+// ------------------------------ Cases ------------------------------
+
+void addFmVoiceCases(std::vector<BenchCase>& cases) {
+  auto inst = sls::engine::FmInstrumentFactory::create("grand_piano");
+  const auto basePatch = inst ? inst->makePatch() : sls::engine::fm::FmPatch{};
+
+  for (int algo = 0; algo < 8; ++algo) {
+    auto voice = std::make_shared<sls::engine::fm::FmVoice>();
+    auto patch = basePatch;
+    patch.voice.algorithm = algo;
+    patch.voice.lfoRateHz = 5.0f;
+    patch.voice.lfoDepth = 0.002f;
+
+    cases.push_back({
+      "fm.voice.renderFrame.algo" + std::to_string(algo + 1),
+      [voice, patch] {
+        voice->reset();
+        voice->noteOn(benchPatches().compile(patch, kSampleRate), 60, 0.8f);
+      },
+      [voice](float* l, float* r, int n) {
+        for (int i = 0; i < n; ++i) {
+          const auto f = voice->renderFrame();
+          l[i] += f.first;
+          r[i] += f.second;
+        }
+      }
+    });
+  }
+
+  // The engine path: 16 held notes rendered together by FmEngine::renderBlock. The 2op case
+  // silences operators 3-6, so its kernel renders one two-operator stack.
+  struct EngineCase { int algo; int operators; };
+  for (const auto ec : { EngineCase { 0, 6 }, EngineCase { 4, 6 }, EngineCase { 1, 2 } }) {
+    auto engine = std::make_shared<sls::engine::fm::FmEngine>();
+    auto patch = basePatch;
+    patch.voice.algorithm = ec.algo;
+    patch.voice.lfoRateHz = 5.0f;
+    patch.voice.lfoDepth = 0.002f;
+    for (int op = ec.operators; op < (int)patch.operators.size(); ++op) patch.operators[(size_t)op].outputLevel = 0.0f;
+
+    cases.push_back({
+      "fm.engine.renderBlock16.algo" + std::to_string(ec.algo + 1) + (ec.operators < 6 ? ".2op" : ""),
+      [engine, patch] {
+        engine->prepare(16, benchPatches().compile(patch, kSampleRate));
+        for (int v = 0; v < 16; ++v) engine->noteOn(48 + v, 0.8f);
+      },
+      [engine](float* l, float* r, int n) { engine->renderBlock(l, r, n); },
+      16
+    });
+  }
+
+  // Four notes on a 64-voice engine: only sounding voices are visited, so the cost per note
+  // should match the 16-note case above rather than grow with the polyphony cap.
+  {
+    auto engine = std::make_shared<sls::engine::fm::FmEngine>();
+    cases.push_back({
+      "fm.engine.renderBlock64.4notes",
+      [engine, basePatch] {
+        engine->prepare(64, benchPatches().compile(basePatch, kSampleRate));
+        for (int v = 0; v < 4; ++v) engine->noteOn(48 + v, 0.8f);
+      },
+      [engine](float* l, float* r, int n) { engine->renderBlock(l, r, n); },
+      4
+    });
+  }
+}
+
+void addSampleVoiceCases(std::vector<BenchCase>& cases) {
+  auto data = std::make_shared<SampleData>();
+  data->sampleRate = kSampleRate;
+  data->buffer.setSize(2, (int)kSampleRate * 2);
+  juce::Random rng(1234);
+  for (int ch = 0; ch < 2; ++ch)
+    for (int i = 0; i < data->buffer.getNumSamples(); ++i)
+      data->buffer.setSample(ch, i, 0.5f * std::sin(0.01f * (float)i * (float)(ch + 1)) + 0.1f * (rng.nextFloat() - 0.5f));
+  data->addGuardFrames();
+
+  auto compact = std::make_shared<SampleData>();
+  compact->sampleRate = kSampleRate;
+  compact->buffer.makeCopyOf(data->buffer);
+  compact->compactToInt16();
+
+  auto voice = std::make_shared<SampleVoice>();
+  const auto makeVoiceOf = [](std::shared_ptr<const SampleData> sample, bool loop, double rate) {
+    SampleVoice sv;
+    sv.active = true;
+    sv.sample = sample;
+    sv.start = 0;
+    sv.end = sample->getNumLoadedFrames() - 1;
+    sv.setPosition(0.0);
+    sv.setRate(rate);
+    sv.gainL = sv.gainR = 0.7f;
+    sv.fadeInRemaining = sv.fadeInTotal;
+    sv.loopEnabled = loop;
+    sv.loopStart = 4800;
+    sv.loopEnd = sv.end - 4800;
+    return sv;
+  };
+  const auto makeVoice = [data, makeVoiceOf](bool loop, double rate) { return makeVoiceOf(data, loop, rate); };
+  const auto makeCompactVoice = [compact, makeVoiceOf](bool loop, double rate) { return makeVoiceOf(compact, loop, rate); };
+
+  constexpr double kSemitoneUp = 1.0594630943592953; // fractional positions every frame
+
+  cases.push_back({
+    "sample.voice.hermite",
+    [voice, makeVoice] { *voice = makeVoice(false, kSemitoneUp); },
+    [voice, makeVoice](float* l, float* r, int n) {
+      if (!voice->active) *voice = makeVoice(false, kSemitoneUp);
+      renderSampleVoiceBlock(*voice, l, r, n);
+    }
+  });
+
+  cases.push_back({
+    "sample.voice.unity",
+    [voice, makeVoice] { *voice = makeVoice(false, 1.0); },
+    [voice, makeVoice](float* l, float* r, int n) {
+      if (!voice->active) *voice = makeVoice(false, 1.0);
+      renderSampleVoiceBlock(*voice, l, r, n);
+    }
+  });
+
+  cases.push_back({
+    "sample.voice.hermite.int16",
+    [voice, makeCompactVoice] { *voice = makeCompactVoice(false, kSemitoneUp); },
+    [voice, makeCompactVoice](float* l, float* r, int n) {
+      if (!voice->active) *voice = makeCompactVoice(false, kSemitoneUp);
+      renderSampleVoiceBlock(*voice, l, r, n);
+    }
+  });
+
+  cases.push_back({
+    "sample.voice.unity.int16",
+    [voice, makeCompactVoice] { *voice = makeCompactVoice(false, 1.0); },
+    [voice, makeCompactVoice](float* l, float* r, int n) {
+      if (!voice->active) *voice = makeCompactVoice(false, 1.0);
+      renderSampleVoiceBlock(*voice, l, r, n);
+    }
+  });
+
+  cases.push_back({
+    "sample.voice.hermite.loopXfade",
+    [voice, makeVoice] { *voice = makeVoice(true, kSemitoneUp); },
+    [voice](float* l, float* r, int n) { renderSampleVoiceBlock(*voice, l, r, n); }
+  });
+}
+
+void addDrumCases(std::vector<BenchCase>& cases) {
+  const sls::inst::InstrumentRegistry registry;
+  const auto state = registry.defaultsForType("drums");
+
+  std::vector<int> notes;
+  for (const auto& [note, piece] : state.drumMap) notes.push_back(note);
+
+  auto drums = std::make_shared<sls::engine::DrumRuntime>(benchPatches());
+  auto frame = std::make_shared<int>(0);
+
+  // Retrigger every piece of the kit each 1/8 s so the whole kit keeps ringing.
+  const auto trigger = [drums, notes, frame](int n) {
+    if ((*frame % 6000) < n)
+      for (const int note : notes) drums->noteOn("bench", note, 0.9f, 1);
+    *frame += n;
+  };
+
+  const auto prepare = [drums, state, frame] {
+    drums->prepare(kSampleRate, 12);
+    drums->syncFromInstrumentState(state);
+    *frame = 0;
+  };
+
+  cases.push_back({
+    "drums.kit.renderFrame",
+    prepare,
+    [drums, trigger](float* l, float* r, int n) {
+      trigger(n);
+      for (int i = 0; i < n; ++i)
+        for (const auto& tap : drums->renderFrame()) {
+          l[i] += tap.left;
+          r[i] += tap.right;
+        }
+    }
+  });
+
+  cases.push_back({
+    "drums.kit.renderBus",
+    prepare,
+    [drums, trigger](float* l, float* r, int n) {
+      trigger(n);
+      for (int bus = 0; bus < 16; ++bus) drums->renderBus(bus, 16, l, r, n);
+    }
+  });
+}
+
+void addFxCases(std::vector<BenchCase>& cases) {
+  // Input signal shared by the FX cases: FX process in place, so each block starts from a copy.
+  auto input = std::make_shared<juce::AudioBuffer<float>>(2, kBlockSize);
+  juce::Random rng(99);
+  for (int ch = 0; ch < 2; ++ch)
+    for (int i = 0; i < kBlockSize; ++i) input->setSample(ch, i, rng.nextFloat() - 0.5f);
+
+  auto delay = std::make_shared<FxDelay>();
+  auto delayPos = std::make_shared<int64_t>(0);
+  cases.push_back({
+    "fx.delay.process",
+    [delay, delayPos] {
+      delay->prepare(kSampleRate, kBlockSize, 2);
+      delay->setParam("wet", 0.4f);
+      delay->setParam("feedback", 0.45f);
+      delay->setDivision("1:8");
+      *delayPos = 0;
+    },
+    [delay, delayPos, input](float* l, float* r, int n) {
+      juce::FloatVectorOperations::copy(l, input->getReadPointer(0), n);
+      juce::FloatVectorOperations::copy(r, input->getReadPointer(1), n);
+      float* chans[2] = { l, r };
+      delay->process(chans, 2, n, 128.0, *delayPos, true);
+      *delayPos += n;
+    }
+  });
+
+  auto gross = std::make_shared<FxGrossBeat>();
+  auto grossPos = std::make_shared<int64_t>(0);
+  cases.push_back({
+    "fx.grossbeat.process",
+    [gross, grossPos] {
+      gross->prepare(kSampleRate, kBlockSize, 2);
+      gross->setParam("wet", 1.0f);
+      gross->setDivision("1:16");
+      gross->setPattern({ 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.5f });
+      *grossPos = 0;
+    },
+    [gross, grossPos, input](float* l, float* r, int n) {
+      juce::FloatVectorOperations::copy(l, input->getReadPointer(0), n);
+      juce::FloatVectorOperations::copy(r, input->getReadPointer(1), n);
+      float* chans[2] = { l, r };
+      gross->process(chans, 2, n, 128.0, *grossPos, true);
+      *grossPos += n;
+    }
+  });
+
+  // Same parameter handling as the engine's reverb FX slot (parameters refreshed every block).
+  auto reverb = std::make_shared<juce::Reverb>();
+  cases.push_back({
+    "fx.reverb.processStereo",
+    [reverb] {
+      reverb->setSampleRate(kSampleRate);
+      reverb->reset();
+    },
+    [reverb, input](float* l, float* r, int n) {
+      juce::FloatVectorOperations::copy(l, input->getReadPointer(0), n);
+      juce::FloatVectorOperations::copy(r, input->getReadPointer(1), n);
+      juce::Reverb::Parameters p;
+      p.roomSize = 0.35f;
+      p.damping = 0.45f;
+      p.wetLevel = 0.25f;
+      p.dryLevel = 1.0f;
+      p.width = 1.0f;
+      reverb->setParameters(p);
+      reverb->processStereo(l, r, n);
+    }
+  });
+
+  // Channel strip EQ: the engine's ChannelDSP, low shelf / peak / high shelf per side.
+  auto eq = std::make_shared<ChannelDSP>();
+  cases.push_back({
+    "channel.eq.processEq",
+    [eq] {
+      eq->setEq(kSampleRate, 3.0f, -2.0f, 4.0f);
+      eq->lowL.reset(); eq->lowR.reset(); eq->midL.reset(); eq->midR.reset(); eq->highL.reset(); eq->highR.reset();
+    },
+    [eq, input](float* l, float* r, int n) {
+      juce::FloatVectorOperations::copy(l, input->getReadPointer(0), n);
+      juce::FloatVectorOperations::copy(r, input->getReadPointer(1), n);
+      eq->processEq(l, r, n);
+    }
+  });
+}
+
+juce::var resultsToJson(const std::vector<BenchResult>& results, double seconds, int repeat) {
+  juce::Array<juce::var> arr;
+  for (const auto& r : results) {
+    juce::DynamicObject::Ptr o = new juce::DynamicObject();
+    o->setProperty("name", juce::String(r.name));
+    o->setProperty("nsPerSample", r.nsPerSample);
+    o->setProperty("voicesPerCore", r.voicesPerCore);
+    arr.add(juce::var(o.get()));
+  }
+
+  juce::DynamicObject::Ptr d = new juce::DynamicObject();
+  d->setProperty("bench", "sls-engine-bench");
+  d->setProperty("sampleRate", kSampleRate);
+  d->setProperty("blockSize", kBlockSize);
+  d->setProperty("seconds", seconds);
+  d->setProperty("repeat", repeat);
+  d->setProperty("platform", juce::SystemStats::getOperatingSystemName());
+  d->setProperty("cpu", juce::SystemStats::getCpuModel());
+  d->setProperty("results", arr);
+  return juce::var(d.get());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  bool json = false;
+  juce::String filter;
+  double seconds = 2.0;
+  int repeat = 5;
+
+  for (int i = 1; i < argc; ++i) {
+    const juce::String arg(argv[i]);
+    if (arg == "--json") json = true;
+    else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+    else if (arg == "--seconds" && i + 1 < argc) seconds = std::max(0.01, juce::String(argv[++i]).getDoubleValue());
+    else if (arg == "--repeat" && i + 1 < argc) repeat = std::max(1, juce::String(argv[++i]).getIntValue());
+    else {
+      std::cerr << "usage: sls-engine-bench [--json] [--filter <substring>] [--seconds <s>] [--repeat <n>]" << std::endl;
+      return 2;
+    }
+  }
+
+  std::vector<BenchCase> cases;
+  addFmVoiceCases(cases);
+  addSampleVoiceCases(cases);
+  addDrumCases(cases);
+  addFxCases(cases);
+
+  std::vector<BenchResult> results;
+  for (const auto& c : cases) {
+    if (filter.isNotEmpty() && !juce::String(c.name).contains(filter)) continue;
+    results.push_back(runCase(c, seconds, repeat));
+    if (!json) {
+      const auto& r = results.back();
+      std::cout << juce::String(r.name).paddedRight(' ', 34)
+                << juce::String(r.nsPerSample, 2).paddedLeft(' ', 10) << " ns/sample"
+                << juce::String(r.voicesPerCore, 1).paddedLeft(' ', 12) << " voices/core" << std::endl;
+    }
+  }
+
+  if (json) std::cout << juce::JSON::toString(resultsToJson(results, seconds, repeat), false) << std::endl;
+  return 0;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <juce_core/juce_core.h>
+
+/*
+  AudioCallbackStats
+  ==================
+  Timing statistics for the device callback.
+
+  - blockRendered() is called by the audio thread once per callback with two
+    high-resolution tick stamps. It only does a few relaxed atomic stores:
+    no locks, no allocation, no system calls besides the tick reads.
+  - Load is measured against the block deadline (numSamples / sampleRate):
+    100 % means the callback used its whole period. A block above 100 % is
+    counted as an overrun.
+  - The histogram has one bin per percent of deadline (last bin = overflow),
+    so p50 / p99 come out in load percent at 1 % resolution.
+  - snapshot() and requestReset() may be called from any other thread. Resets
+    are applied by the audio thread at the start of its next block.
+*/
+
+class AudioCallbackStats {
+public:
+  static constexpr int kHistogramBins = 256;
+
+  struct Snapshot {
+    uint64_t blocks = 0;
+    uint64_t overruns = 0;
+    double loadPercent = 0.0;   // smoothed, ~300 ms time constant
+    double p50Percent = 0.0;
+    double p99Percent = 0.0;
+    double maxPercent = 0.0;
+    double lastMicros = 0.0;
+    double maxMicros = 0.0;
+    double deadlineMicros = 0.0;
+  };
+
+  AudioCallbackStats()
+    : mSecondsPerTick(1.0 / (double)std::max<juce::int64>(1, juce::Time::getHighResolutionTicksPerSecond())) {}
+
+  // Audio thread only.
+  void blockRendered(juce::int64 startTicks, juce::int64 endTicks, int numSamples, double sampleRate) noexcept {
+    if (mResetRequested.exchange(false, std::memory_order_acquire)) clear();
+    if (numSamples <= 0 || sampleRate <= 0.0) return;
+
+    const double elapsedSec = (double)(endTicks - startTicks) * mSecondsPerTick;
+    const double deadlineSec = (double)numSamples / sampleRate;
+    const double load = elapsedSec / deadlineSec;
+
+    const int bin = juce::jlimit(0, kHistogramBins - 1, (int)(load * 100.0));
+    mHistogram[(size_t)bin].store(mHistogram[(size_t)bin].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    const double alpha = 1.0 - std::exp(-deadlineSec / kSmoothingSec);
+    mSmoothedLoad += alpha * (load - mSmoothedLoad);
+
+    mBlocks.store(mBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (load > 1.0) mOverruns.store(mOverruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    mLoad.store((float)mSmoothedLoad, std::memory_order_relaxed);
+    mLastMicros.store((float)(elapsedSec * 1.0e6), std::memory_order_relaxed);
+    mDeadlineMicros.store((float)(deadlineSec * 1.0e6), std::memory_order_relaxed);
+    if (elapsedSec * 1.0e6 > mMaxMicros.load(std::memory_order_relaxed))
+      mMaxMicros.store((float)(elapsedSec * 1.0e6), std::memory_order_relaxed);
+    if (load > mMaxLoad.load(std::memory_order_relaxed))
+      mMaxLoad.store((float)load, std::memory_order_relaxed);
+  }
+
+  void requestReset() noexcept { mResetRequested.store(true, std::memory_order_release); }
+
+  uint64_t getOverrunCount() const noexcept { return mOverruns.load(std::memory_order_relaxed); }
+
+  // Any thread. Counters are read individually, so a snapshot may straddle one block.
+  Snapshot snapshot() const {
+    Snapshot s;
+    s.blocks = mBlocks.load(std::memory_order_relaxed);
+    s.overruns = mOverruns.load(std::memory_order_relaxed);
+    s.loadPercent = 100.0 * mLoad.load(std::memory_order_relaxed);
+    s.maxPercent = 100.0 * mMaxLoad.load(std::memory_order_relaxed);
+    s.lastMicros = mLastMicros.load(std::memory_order_relaxed);
+    s.maxMicros = mMaxMicros.load(std::memory_order_relaxed);
+    s.deadlineMicros = mDeadlineMicros.load(std::memory_order_relaxed);
+
+    std::array<uint32_t, kHistogramBins> bins {};
+    uint64_t total = 0;
+    for (size_t i = 0; i < bins.size(); ++i) {
+      bins[i] = mHistogram[i].load(std::memory_order_relaxed);
+      total += bins[i];
+    }
+    s.p50Percent = percentile(bins, total, 0.50);
+    s.p99Percent = percentile(bins, total, 0.99);
+    return s;
+  }
+
+private:
+  static constexpr double kSmoothingSec = 0.3;
+
+  static double percentile(const std::array<uint32_t, kHistogramBins>& bins, uint64_t total, double q) {
+    if (total == 0) return 0.0;
+    const auto target = (uint64_t)std::ceil(q * (double)total);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bins.size(); ++i) {
+      seen += bins[i];
+      if (seen >= target) return (double)(i + 1); // upper edge of the bin
+    }
+    return (double)kHistogramBins;
+  }
+
+  void clear() noexcept {
+    for (auto& b : mHistogram) b.store(0, std::memory_order_relaxed);
+    mSmoothedLoad = 0.0;
+    mBlocks.store(0, std::memory_order_relaxed);
+    mOverruns.store(0, std::memory_order_relaxed);
+    mLoad.store(0.0f, std::memory_order_relaxed);
+    mMaxLoad.store(0.0f, std::memory_order_relaxed);
+    mMaxMicros.store(0.0f, std::memory_order_relaxed);
+  }
+
+  const double mSecondsPerTick;
+  double mSmoothedLoad = 0.0; // audio thread only
+
+  std::array<std::atomic<uint32_t>, kHistogramBins> mHistogram {};
+  std::atomic<uint64_t> mBlocks { 0 };
+  std::atomic<uint64_t> mOverruns { 0 };
+  std::atomic<float> mLoad { 0.0f };
+  std::atomic<float> mMaxLoad { 0.0f };
+  std::atomic<float> mLastMicros { 0.0f };
+  std::atomic<float> mMaxMicros { 0.0f };
+  std::atomic<float> mDeadlineMicros { 0.0f };
+  std::atomic<bool> mResetRequested { false };
+};
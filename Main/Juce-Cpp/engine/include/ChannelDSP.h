@@ -0,0 +1,59 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+#include "FxBase.h"
+
+/*
+  ChannelDSP
+  ==========
+  Per-channel strip state of the mixer: the 3-band EQ and the FX chain.
+
+  - setEq() builds new filter coefficients: call it off the audio thread
+    (or where the engine already refreshes them), never per block.
+  - processEq() runs on the audio thread (or a render worker): no
+    allocation, no locks.
+*/
+
+struct FxUnit {
+  juce::String id;
+  juce::String type;
+  bool enabled = true;
+  bool bypass = false;
+  juce::NamedValueSet params;
+  juce::Reverb reverb;
+  std::unique_ptr<FxBase> dsp; // per-instance DSP (e.g., FxDelay)
+
+  float getParam(const juce::String& name, float def) const {
+    const auto v = params.getWithDefault(name, def);
+    if (v.isInt() || v.isDouble()) return (float)(double)v;
+    return def;
+  }
+};
+
+struct ChannelDSP {
+  juce::dsp::IIR::Filter<float> lowL, lowR, midL, midR, highL, highR;
+  std::vector<std::unique_ptr<FxUnit>> fx;
+
+  // Low shelf 120 Hz, peak 1.2 kHz, high shelf 8 kHz; gains in dB.
+  void setEq(double sampleRate, float lowDb, float midDb, float highDb) {
+    lowL.coefficients  = juce::dsp::IIR::Coefficients<float>::makeLowShelf (sampleRate, 120.0f,  0.707f, juce::Decibels::decibelsToGain(lowDb));
+    lowR.coefficients  = juce::dsp::IIR::Coefficients<float>::makeLowShelf (sampleRate, 120.0f,  0.707f, juce::Decibels::decibelsToGain(lowDb));
+    midL.coefficients  = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, 1200.0f, 0.9f,   juce::Decibels::decibelsToGain(midDb));
+    midR.coefficients  = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, 1200.0f, 0.9f,   juce::Decibels::decibelsToGain(midDb));
+    highL.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, 8000.0f,  0.707f, juce::Decibels::decibelsToGain(highDb));
+    highR.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, 8000.0f,  0.707f, juce::Decibels::decibelsToGain(highDb));
+  }
+
+  void processEq(float& l, float& r) {
+    l = highL.processSample(midL.processSample(lowL.processSample(l)));
+    r = highR.processSample(midR.processSample(lowR.processSample(r)));
+  }
+
+  void processEq(float* l, float* r, int n) {
+    for (int i = 0; i < n; ++i) l[i] = highL.processSample(midL.processSample(lowL.processSample(l[i])));
+    for (int i = 0; i < n; ++i) r[i] = highR.processSample(midR.processSample(lowR.processSample(r[i])));
+  }
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+struct SampleData;
+
+/*
+  LoopAnalysis
+  ============
+  Seamless loop points for Touski zones, worked out when a program loads or
+  its loop parameters change, never when a note starts.
+
+  - The requested loop start / end are first snapped to the quietest zero
+    crossing within searchRadius, then slid (start for the end, then end for
+    the new start) to the offset whose crossfade window matches best.
+  - A seam is scored by the squared difference between the window before the
+    loop end and the window after the loop start, plus the jump and slope
+    mismatch across the splice. All offsets in the search range are scored
+    in one pass: the window energies come from running sums and the cross
+    terms from one FFT cross-correlation per channel, so the cost grows with
+    (radius + window) log(radius + window) instead of radius x window.
+  - LoopPointCache keeps the result per (sample, LoopSpec), so flipping a
+    parameter back and forth or loading the same file in several programs
+    analyses it once.
+*/
+
+namespace sls::sampler {
+
+// Loop request in sample frames, already clamped to the sample:
+// start <= loopStart < loopEnd <= releaseEnd <= length.
+struct LoopSpec {
+  int start = 0;           // the loop never starts before it
+  int loopStart = 0;
+  int loopEnd = 0;
+  int releaseEnd = 0;      // the loop never ends past it
+  int searchRadius = 0;    // zero-crossing search, frames; 0 keeps the points as requested
+  int crossfade = 0;       // loop crossfade, frames; sets the seam window
+
+  bool operator==(const LoopSpec& o) const noexcept {
+    return start == o.start && loopStart == o.loopStart && loopEnd == o.loopEnd
+        && releaseEnd == o.releaseEnd && searchRadius == o.searchRadius && crossfade == o.crossfade;
+  }
+  bool operator!=(const LoopSpec& o) const noexcept { return !(*this == o); }
+};
+
+struct LoopPoints {
+  LoopSpec spec;           // request these points answer
+  int loopStart = 0;
+  int loopEnd = 0;
+  bool valid = false;
+};
+
+// Any thread except the audio thread (allocates, O(n log n) in radius + window).
+LoopPoints findLoopPoints(const juce::AudioBuffer<float>& buffer, const LoopSpec& spec);
+
+class LoopPointCache {
+public:
+  struct Stats {
+    int entries = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  // Loader threads. Cached points for (sample, spec), analysed on first use.
+  LoopPoints get(const std::shared_ptr<const SampleData>& sample, const LoopSpec& spec);
+
+  Stats getStats() const;
+
+private:
+  static constexpr size_t kMaxEntries = 4096;
+
+  struct Key {
+    const SampleData* sample = nullptr;
+    LoopSpec spec;
+    bool operator==(const Key& o) const noexcept { return sample == o.sample && spec == o.spec; }
+  };
+  struct KeyHash {
+    size_t operator()(const Key& k) const noexcept;
+  };
+  struct Entry {
+    std::weak_ptr<const SampleData> sample; // a freed sample's address may be reused
+    LoopPoints points;
+  };
+
+  mutable std::mutex mMutex;
+  std::unordered_map<Key, Entry, KeyHash> mEntries;
+  uint64_t mHits = 0;
+  uint64_t mMisses = 0;
+};
+
+} // namespace sls::sampler
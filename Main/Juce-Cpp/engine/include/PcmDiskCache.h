@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <juce_core/juce_core.h>
+
+struct SampleData;
+
+/*
+  PcmDiskCache
+  ============
+  Decoded (and rate-converted) samples of compressed files (MP3, FLAC, Ogg)
+  kept on disk, so opening a project again maps the PCM instead of decoding
+  every file.
+
+  - One file per (source path, target rate, storage type): a 64-byte header,
+    then the channels back to back in the layout SampleData uses in memory
+    (float or int16, kGuardFrames edge frames on both sides). A hit is one
+    read-only memory mapping the sample refers to directly.
+  - The header records the size and modification time of the source; a
+    source that changed since misses, and its entry is written again.
+  - Files are written to a temporary name and renamed, so a reader never
+    sees a partial entry. After each write the oldest entries (by last use)
+    are deleted until the directory fits the budget.
+  - WAV / AIFF are not cached: they decode (or stream) about as fast as a
+    cache read.
+  - Loader threads only (file IO). load() touches every page of the mapping
+    so the audio thread does not fault them in.
+*/
+
+namespace sls::sampler {
+
+class PcmDiskCache {
+public:
+  static constexpr juce::int64 kDefaultBudgetBytes = (juce::int64)2048 << 20;
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;    // lookups of cacheable files that found nothing usable
+    uint64_t writes = 0;
+    uint64_t evictions = 0; // files deleted to fit the budget
+  };
+
+  PcmDiskCache();
+
+  // A budget of 0 disables the cache (entries already on disk are left alone).
+  void configure(const juce::File& directory, juce::int64 budgetBytes);
+  juce::File getDirectory() const;
+  juce::int64 getBudgetBytes() const;
+
+  static bool isCacheable(const juce::File& source);
+
+  // The cached sample for source at targetRate (0: file rate) in the given storage, nullptr on a miss.
+  // Pitch marks are not stored; the caller analyses the returned frames.
+  std::shared_ptr<SampleData> load(const juce::File& source, double targetRate, bool int16);
+
+  // Writes a fully decoded sample (guard framed, as loaders leave it), then trims the directory.
+  void store(const juce::File& source, double targetRate, const SampleData& sample);
+
+  Stats getStats() const;
+
+private:
+  juce::File entryFile(const juce::File& source, double targetRate, bool int16) const;
+  void trimToBudget();
+
+  mutable std::mutex mMutex; // directory and budget; trimming
+  juce::File mDirectory;
+  juce::int64 mBudgetBytes = kDefaultBudgetBytes;
+  std::atomic<uint64_t> mHits { 0 };
+  std::atomic<uint64_t> mMisses { 0 };
+  std::atomic<uint64_t> mWrites { 0 };
+  std::atomic<uint64_t> mEvictions { 0 };
+};
+
+} // namespace sls::sampler
@@ -0,0 +1,64 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+/*
+  PitchMarks
+  ==========
+  Pitch epochs of a decoded sample, found once when it loads, so the Touski
+  granular hold places grains with a table lookup instead of searching the
+  buffer at every spawn.
+
+  - The local period comes from a normalised autocorrelation of the first
+    two channels (one FFT per 1024-frame hop, 32..1024 frame lags). Frames
+    without a clear period are treated as unvoiced and marked every
+    kUnvoicedSpacing frames.
+  - Marks follow the period through the file; each one sits on the
+    quietest, flattest frame (the grain entry cost) within a quarter period
+    of where the period predicts it, so successive marks share the waveform
+    phase.
+  - Every mark gets a similarity in 0..1, the normalised correlation between
+    the period it starts and the next one, and a cost combining both: grains
+    prefer quiet entries in steady, periodic material.
+  - A bucket table (one entry per 64 frames) gives the marks around any
+    position in O(1). Read-only once built; shared with the sample.
+*/
+
+namespace sls::sampler {
+
+class PitchMarks {
+public:
+  static constexpr int kMinPeriod = 32;
+  static constexpr int kMaxPeriod = 1024;
+  static constexpr int kUnvoicedSpacing = 256;
+
+  struct Mark {
+    int pos = 0;
+    float similarity = 0.0f; // periodicity of the material after the mark
+    float cost = 0.0f;       // lower is a better grain entry
+  };
+
+  // Decoder threads. nullptr for buffers too short to analyse.
+  static std::shared_ptr<const PitchMarks> analyse(const juce::AudioBuffer<float>& buffer);
+
+  const std::vector<Mark>& getMarks() const noexcept { return mMarks; }
+
+  // Index of the first mark at or after pos (getMarks().size() if none). O(1), any thread.
+  int firstAtOrAfter(int pos) const noexcept {
+    if (mMarks.empty() || pos <= mMarks.front().pos) return 0;
+    const size_t bucket = (size_t)pos >> kBucketShift;
+    if (bucket >= mBuckets.size()) return (int)mMarks.size();
+    int i = mBuckets[bucket];
+    while (i < (int)mMarks.size() && mMarks[(size_t)i].pos < pos) ++i;
+    return i;
+  }
+
+private:
+  static constexpr int kBucketShift = 6;
+
+  std::vector<Mark> mMarks;    // ascending pos
+  std::vector<int> mBuckets;   // first mark at or after bucket * 64
+};
+
+} // namespace sls::sampler
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <juce_core/juce_core.h>
+
+/*
+  RenderWorkerPool
+  ================
+  Small pool of realtime-priority threads that help the audio thread run the
+  independent nodes of one render stage (e.g. "render every mixer channel").
+
+  - run() publishes numTasks tasks; workers and the calling (audio) thread
+    claim task indices from one shared atomic cursor, so idle threads pick up
+    whatever is left.
+  - The caller always participates and run() returns only when every task has
+    finished. If no worker wakes up in time the caller simply does all the
+    work itself, so results never depend on scheduling.
+  - No allocation and no locks on the run() path. Workers spin briefly after
+    each job and then sleep on their own semaphore, which run() posts only for
+    workers that are actually asleep.
+  - Each task must only touch state owned by its index.
+*/
+
+class RenderWorkerPool {
+public:
+  using TaskFn = void (*)(void* context, int taskIndex);
+
+  RenderWorkerPool();
+  ~RenderWorkerPool();
+
+  // (Re)starts numWorkers helper threads (0 = caller renders alone).
+  // samplesPerBlock / sampleRate give the realtime scheduler a deadline hint.
+  void start(int numWorkers, int samplesPerBlock, double sampleRate);
+  void stop();
+
+  int getNumWorkers() const noexcept { return (int)mWorkers.size(); }
+
+  // Runs fn(context, 0..numTasks-1) across the pool and the caller; blocks until done.
+  void run(int numTasks, TaskFn fn, void* context);
+
+private:
+  class Worker;
+
+  bool claimTask(uint32_t job, int& index);
+  void runTasks(uint32_t job);
+
+  std::vector<std::unique_ptr<Worker>> mWorkers;
+
+  // Job descriptor: written by run() before mCursor is published.
+  TaskFn mFn = nullptr;
+  void* mContext = nullptr;
+  std::atomic<int> mNumTasks { 0 };
+
+  // high 32 bits: job id, low 32 bits: next task index
+  alignas(64) std::atomic<uint64_t> mCursor { 0 };
+  alignas(64) std::atomic<int> mRemaining { 0 };
+  uint32_t mJob = 0;
+};
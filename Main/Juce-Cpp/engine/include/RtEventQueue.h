@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/*
+  RtEventQueue
+  ============
+  Bounded lock-free multi-producer / single-consumer queue (Vyukov ring with a
+  sequence number per cell).
+
+  - tryPush may be called from any number of threads (stdin IPC, MIDI input,
+    loader threads...). It never blocks; it returns false when the queue is full.
+  - tryPop must only be called from one thread (the audio thread). It never
+    blocks and never allocates.
+  - tryPop copies the value out and leaves the original in its cell until a
+    producer reuses that slot. Heavy payloads (juce::var, juce::String,
+    shared_ptr) are therefore normally released on a producer thread, not on
+    the audio thread.
+*/
+
+template <typename T>
+class RtEventQueue {
+public:
+  // capacity is rounded up to a power of two (minimum 2).
+  explicit RtEventQueue(size_t capacity) {
+    size_t cap = 2;
+    while (cap < capacity) cap <<= 1;
+    mMask = cap - 1;
+    mCells = std::make_unique<Cell[]>(cap);
+    for (size_t i = 0; i < cap; ++i) mCells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  RtEventQueue(const RtEventQueue&) = delete;
+  RtEventQueue& operator=(const RtEventQueue&) = delete;
+
+  size_t capacity() const noexcept { return mMask + 1; }
+
+  // Producer side (thread-safe).
+  bool tryPush(const T& value) {
+    Cell* cell = nullptr;
+    size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell = &mCells[pos & mMask];
+      const size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+      if (diff == 0) {
+        if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false; // full
+      } else {
+        pos = mEnqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = value;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side (single thread only).
+  bool tryPop(T& out) {
+    const size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+    Cell& cell = mCells[pos & mMask];
+    const size_t seq = cell.sequence.load(std::memory_order_acquire);
+    if ((intptr_t)seq - (intptr_t)(pos + 1) < 0) return false; // empty
+
+    out = cell.value;
+    cell.sequence.store(pos + mMask + 1, std::memory_order_release);
+    mDequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence { 0 };
+    T value {};
+  };
+
+  size_t mMask = 0;
+  std::unique_ptr<Cell[]> mCells;
+  alignas(64) std::atomic<size_t> mEnqueuePos { 0 };
+  alignas(64) std::atomic<size_t> mDequeuePos { 0 };
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+  RtReleasePool
+  =============
+  Keeps objects built for the audio thread alive until nothing else refers to
+  them, so the audio thread never drops the last reference and never frees.
+
+  - add() and collect() may be called from any thread except the audio thread.
+  - The audio thread only copies and overwrites shared_ptrs to pooled objects
+    (taken from an RtCommand), which never frees while the pool holds them.
+  - collect() frees the objects only the pool still refers to; call it from a
+    producer or a housekeeping thread.
+*/
+
+template <typename T>
+class RtReleasePool {
+public:
+  std::shared_ptr<T> add(std::shared_ptr<T> object) {
+    if (!object) return object;
+    std::scoped_lock lk(mMutex);
+    mObjects.push_back(object);
+    return object;
+  }
+
+  void collect() {
+    std::vector<std::shared_ptr<T>> unused;
+    {
+      std::scoped_lock lk(mMutex);
+      const auto it = std::stable_partition(mObjects.begin(), mObjects.end(),
+                                            [](const std::shared_ptr<T>& p) { return p.use_count() > 1; });
+      unused.assign(std::make_move_iterator(it), std::make_move_iterator(mObjects.end()));
+      mObjects.erase(it, mObjects.end());
+    }
+    // Destroyed here, outside the lock: freeing may be slow and may release other pooled objects.
+  }
+
+private:
+  std::mutex mMutex;
+  std::vector<std::shared_ptr<T>> mObjects;
+};
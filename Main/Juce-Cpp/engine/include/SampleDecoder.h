@@ -0,0 +1,52 @@
+#pragma once
+#include <functional>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+/*
+  SampleDecoder
+  =============
+  Background pool for heavy asset work (sample decoding, Touski programs), so
+  the IPC thread only validates requests and answers with a job id.
+
+  - submit() queues a job on one of the decoder threads; jobs run in FIFO
+    order, several at a time when there are several threads.
+  - decode() reads a file into a buffer. Long WAV / AIFF / FLAC files are
+    split into chunks that idle decoder threads help with, each through its
+    own reader (those formats seek sample-exactly). The calling job always
+    works on its own chunks too, so it never waits for a busy pool.
+  - Never used by the audio thread.
+*/
+
+namespace sls::sampler {
+
+class SampleDecoder {
+public:
+  using Progress = std::function<void(double fraction)>;
+
+  explicit SampleDecoder(int numThreads);
+  ~SampleDecoder();
+
+  int getNumThreads() const noexcept { return mNumThreads; }
+
+  void submit(std::function<void()> job);
+
+  // Blocks until every submitted job has finished.
+  void waitUntilIdle();
+
+  // Drops queued jobs and waits for the running ones (engine shutdown).
+  void stop();
+
+  // Decodes numFrames frames from the start of file into dest (sized by the caller,
+  // one channel per file channel). progress is called on the calling thread.
+  bool decode(juce::AudioFormatManager& formats, const juce::File& file,
+              juce::AudioBuffer<float>& dest, juce::int64 numFrames, const Progress& progress = {});
+
+private:
+  struct ChunkedRead;
+  static void readChunks(ChunkedRead& job, const Progress* progress = nullptr);
+
+  juce::ThreadPool mPool;
+  int mNumThreads = 1;
+};
+
+} // namespace sls::sampler
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <juce_core/juce_core.h>
+
+struct SampleData;
+
+/*
+  SamplePool
+  ==========
+  Engine-wide cache of decoded samples, shared by sampler.load,
+  sampler.trigger auto-loads and Touski programs.
+
+  - Entries are keyed by content: file size plus a 64-bit hash of the whole
+    file. The same audio reached through two paths (copies, links, another
+    sampleId) is decoded once. A path index remembers the content key of
+    every path with its size and modification time, so a known, unchanged
+    file is found without reading it again; a changed file is hashed again.
+  - The pool holds a reference to every entry. A sample is referenced while
+    anything else (a sampleId, a program zone, a voice, a scheduled event)
+    holds its shared_ptr; unreferenced entries stay cached and are evicted
+    least recently used first whenever the decoded bytes of the pool exceed
+    the budget. Referenced entries are never evicted.
+  - Streamed samples (head only, SampleStream.h) and fully decoded ones are
+    kept apart: a caller that needs the whole file (looping Touski voices)
+    never gets a streamed entry, a caller that allows streaming takes either.
+  - acquire() hashes and decodes outside the lock. find() never reads files.
+    Neither is for the audio thread: scheduled triggers carry their sample.
+  - getStats() only reads counters kept up to date by the pool, so polling it
+    never holds the lock while the entries are scanned.
+  - Fully decoded samples are converted to the pool's target rate by the
+    loader. retarget() converts the referenced ones again when it changes and
+    drops the unreferenced ones; an entry made for another rate is decoded
+    again by the next acquire().
+*/
+
+namespace sls::sampler {
+
+class SamplePool {
+public:
+  using Progress = std::function<void(double fraction)>;
+  using Loader = std::function<std::shared_ptr<SampleData>(const juce::File& file, bool allowStreaming, double targetRate,
+                                                             const Progress& progress)>;
+  // A copy of sample at targetRate, or nullptr when the sample is fine as it is.
+  using Converter = std::function<std::shared_ptr<const SampleData>(const SampleData& sample, double targetRate)>;
+  using Replacements = std::vector<std::pair<std::shared_ptr<const SampleData>, std::shared_ptr<const SampleData>>>;
+
+  static constexpr size_t kDefaultBudgetBytes = (size_t)512 << 20;
+
+  // entries .. cachedBytes are as of the last acquire, trim or retarget.
+  struct Stats {
+    int entries = 0;          // decoded samples held by the pool
+    int referenced = 0;       // of which something outside the pool still uses
+    size_t bytes = 0;         // decoded bytes of all entries
+    size_t cachedBytes = 0;   // of which unreferenced (evictable)
+    size_t budgetBytes = 0;
+    uint64_t hits = 0;        // acquire / find served from the pool
+    uint64_t misses = 0;      // acquire that had to decode
+    uint64_t deduplicated = 0; // hits reached through a path not seen before
+    uint64_t evictions = 0;
+  };
+
+  explicit SamplePool(Loader loader);
+
+  // Loader threads. The pooled sample for path, decoding it on first use; nullptr if unreadable.
+  std::shared_ptr<const SampleData> acquire(const juce::String& path, bool allowStreaming, const Progress& progress = {});
+
+  // Any thread but the audio thread: the pooled sample if path was acquired, nullptr if not.
+  std::shared_ptr<const SampleData> find(const juce::String& path, bool allowStreaming);
+
+  // Loader threads. Sets the rate new decodes are converted to and converts every referenced sample
+  // made for another rate; returns (old, new) pairs for the holders to swap.
+  Replacements retarget(double targetRate, const Converter& convert);
+  double getTargetRate() const;
+
+  // Bytes of decoded data the pool may hold before it evicts unreferenced entries (0 keeps none).
+  void setBudgetBytes(size_t bytes);
+
+  // Evicts unreferenced entries down to the budget; call after dropping references in bulk.
+  // Not on the audio thread (freeing happens here).
+  void trim();
+
+  Stats getStats() const;
+
+private:
+  struct Entry {
+    std::shared_ptr<const SampleData> full;
+    std::shared_ptr<const SampleData> streamed;
+    int64_t targetHz = 0; // rate the data was made for, in whole Hz (0: file rate)
+    uint64_t lastUse = 0;
+  };
+
+  struct PathRecord {
+    uint64_t key = 0;
+    juce::int64 fileSize = -1;
+    juce::Time modified;
+  };
+
+  static int64_t toHz(double rate) noexcept { return (int64_t)std::llround(rate); }
+  static uint64_t contentKey(const juce::File& file, juce::int64 size);
+  std::shared_ptr<const SampleData> lookup(Entry& e, bool allowStreaming);
+  static size_t entryBytes(const Entry& e);
+  static bool isReferenced(const Entry& e);
+  std::vector<Entry> evictToBudget();
+  void publishStats();
+
+  Loader mLoader;
+  double mTargetRate = 0.0; // 0: keep file rates
+  size_t mBudgetBytes = kDefaultBudgetBytes;
+  mutable std::mutex mMutex;
+  std::unordered_map<uint64_t, Entry> mEntries;
+  std::unordered_map<juce::String, PathRecord> mPaths;
+  uint64_t mClock = 0;
+
+  // Stats, readable without mMutex.
+  std::atomic<int> mStatEntries { 0 };
+  std::atomic<int> mStatReferenced { 0 };
+  std::atomic<size_t> mStatBytes { 0 };
+  std::atomic<size_t> mStatCachedBytes { 0 };
+  std::atomic<size_t> mStatBudgetBytes { kDefaultBudgetBytes };
+  std::atomic<uint64_t> mHits { 0 };
+  std::atomic<uint64_t> mMisses { 0 };
+  std::atomic<uint64_t> mDeduplicated { 0 };
+  std::atomic<uint64_t> mEvictions { 0 };
+};
+
+} // namespace sls::sampler
@@ -0,0 +1,27 @@
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+
+/*
+  SampleRateConverter
+  ===================
+  Converts decoded samples to the engine rate once, when they load (or when
+  the device rate changes), so voices at unity pitch read the source 1:1 and
+  transposed ones start from properly band-limited data instead of Hermite
+  doing the rate change on every frame.
+
+  - Windowed-sinc polyphase filter: Kaiser window (beta 8.6, about -85 dB
+    stopband), kZeroCrossings zero crossings each side of the centre tap,
+    widened when downsampling so the cutoff follows the lower Nyquist.
+  - Integer rate pairs with a small ratio (44.1k <-> 48k, 96k -> 48k ...)
+    get one exact phase per output position; other ratios interpolate
+    linearly between kTablePhases precomputed phases.
+  - Every phase is normalised to unity DC gain. Frames before the start and
+    after the end of the source count as silence.
+*/
+
+namespace sls::sampler {
+
+// Loader threads (allocates, O(frames x taps)). source resampled from sourceRate to targetRate.
+juce::AudioBuffer<float> convertSampleRate(const juce::AudioBuffer<float>& source, double sourceRate, double targetRate);
+
+} // namespace sls::sampler
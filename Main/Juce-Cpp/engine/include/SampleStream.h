@@ -0,0 +1,132 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+struct SampleData;
+
+/*
+  SampleStream
+  ============
+  Disk streaming for samples too long to keep decoded in memory.
+
+  - StreamSource wraps one file. Uncompressed WAV / AIFF are read through a
+    MemoryMappedAudioFormatReader (no decode, the OS pages the file in);
+    other formats go through their normal reader.
+  - Only the head of a streamed file is decoded into SampleData::buffer, so
+    triggering a voice never waits for the disk.
+  - Every playing streamed voice owns one StreamRing from the SampleStreamer.
+    The ring is primed when the voice is created (from the head, or from the
+    file for late start points off the audio thread); the streamer thread
+    then keeps it filled ahead of the voice.
+  - The audio thread only reads the ring and publishes how far it has got;
+    it never blocks. If the disk falls behind, the voice plays silence for
+    the missing frames and the underrun is counted.
+  - Ring memory is bounded by the budget given to configure(): rings are
+    allocated up front and a voice that finds none free plays its head only.
+*/
+
+namespace sls::sampler {
+
+class StreamSource {
+public:
+  // Returns nullptr if the file cannot be read.
+  static std::shared_ptr<StreamSource> open(juce::AudioFormatManager& formats, const juce::File& file);
+
+  juce::int64 getLengthInFrames() const noexcept { return mLength; }
+  double getSampleRate() const noexcept { return mSampleRate; }
+  int getNumChannels() const noexcept { return mNumChannels; }
+  bool isMemoryMapped() const noexcept { return mMapped; }
+
+  // Any thread except the audio thread. Frames outside the file repeat the first / last frame.
+  void read(float* const* dest, int numChannels, juce::int64 startFrame, int numFrames);
+
+private:
+  std::mutex mMutex;
+  std::unique_ptr<juce::AudioFormatReader> mReader;
+  juce::int64 mLength = 0;
+  double mSampleRate = 48000.0;
+  int mNumChannels = 0;
+  bool mMapped = false;
+};
+
+// Read-ahead ring of one voice. Frame f lives at index f & (capacity - 1); kGuard frames are
+// mirrored on both sides so 4-point interpolation reads across the wrap without masking.
+class StreamRing {
+public:
+  static constexpr int kGuard = 4;
+
+  // Audio thread.
+  const float* getChannel(int ch) const noexcept { return mData.get() + (size_t)ch * mStride + kGuard; }
+  int getNumChannels() const noexcept { return mNumChannels; }
+  int getCapacity() const noexcept { return mCapacity; }
+  juce::int64 getFilledEnd() const noexcept { return mFilledEnd.load(std::memory_order_acquire); }
+  void setReadFrame(juce::int64 frame) noexcept { mReadFrame.store(frame, std::memory_order_release); }
+  void countUnderrun() noexcept { mUnderruns.fetch_add(1, std::memory_order_relaxed); }
+  void release() noexcept { mState.store(Released, std::memory_order_release); }
+
+private:
+  friend class SampleStreamer;
+  enum State : int { Free, Priming, Active, Released };
+
+  void allocate(int capacity);
+  void write(juce::int64 frame, const float* const* src, int numChannels, int numFrames);
+
+  juce::HeapBlock<float> mData;
+  size_t mStride = 0;
+  int mCapacity = 0;
+  int mNumChannels = 1;
+
+  std::shared_ptr<StreamSource> mSource; // claiming thread while Priming, streamer thread otherwise
+  std::atomic<int> mState { Free };
+  std::atomic<juce::int64> mFilledEnd { 0 }; // first frame not yet written
+  std::atomic<juce::int64> mReadFrame { 0 }; // lowest frame the voice may still read
+  std::atomic<uint64_t> mUnderruns { 0 };
+};
+
+class SampleStreamer : private juce::Thread {
+public:
+  static constexpr int kRingFrames = 1 << 17;   // ~2.7 s ahead at 48 kHz
+  static constexpr int kHeadFrames = 1 << 16;   // decoded head of a streamed sample
+
+  struct Stats {
+    int rings = 0;
+    int ringsInUse = 0;
+    uint64_t underruns = 0;
+    uint64_t claimFailures = 0;
+    size_t ringBytes = 0;
+  };
+
+  SampleStreamer();
+  ~SampleStreamer() override;
+
+  // Allocates as many rings as fit in budgetBytes and starts the read-ahead thread.
+  // Message thread, while no voice holds a ring.
+  void configure(size_t budgetBytes);
+  size_t getBudgetBytes() const noexcept { return mBudgetBytes; }
+
+  // A ring primed from startFrame on, or nullptr when none is free. Lock-free; with
+  // mayReadDisk = false (audio thread) it only primes from the decoded head and fails
+  // for start points past it.
+  StreamRing* claim(const std::shared_ptr<const SampleData>& data, juce::int64 startFrame, bool mayReadDisk);
+
+  // Runs one fill pass on the calling thread (offline render, which outpaces the disk thread).
+  void fillNow();
+
+  Stats getStats() const;
+
+private:
+  void run() override;
+  void fill(StreamRing& ring);
+
+  std::vector<std::unique_ptr<StreamRing>> mRings;
+  size_t mBudgetBytes = 0;
+  std::mutex mFillMutex;
+  juce::AudioBuffer<float> mScratch;
+  std::atomic<uint64_t> mClaimFailures { 0 };
+};
+
+} // namespace sls::sampler
@@ -0,0 +1,613 @@
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "PitchMarks.h"
+#include "SampleStream.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON || defined (__ARM_NEON)
+ #include <arm_neon.h>
+ #define SLS_SAMPLE_VOICE_NEON 1
+#endif
+
+/*
+  SampleVoice
+  ===========
+  Decoded sample data and the one-shot / looping sample voice used by the
+  sampler and Touski paths of the engine, plus its block renderer.
+
+  - renderSampleVoiceBlock() runs on the audio thread (or a render worker):
+    no allocation, no locks. It adds into the output and deactivates the
+    voice when it reaches its end or finishes its release fade.
+  - Sample data carries kGuardFrames replicated edge frames on both sides of
+    every channel (SampleData::addGuardFrames), so the 4-point Hermite
+    interpolator reads its neighbours without clamping.
+  - Positions are 32.32 fixed point: the frame index is a shift, there is no
+    drift over long samples, and integer rates (1:1 playback) read the
+    source contiguously.
+  - A block is split into segments at the next event (fade-in end, loop
+    crossfade start, loop end, sample end). Plain segments run the
+    interpolator 4 frames at a time (SSE / NEON); loop crossfades and
+    releases have their own loops, so the common path tests nothing per
+    frame.
+  - Streamed samples (SampleStream.h) keep only their head in buffer; a
+    voice holding a StreamRing reads the rest from the ring, in segments
+    that stop at the ring wrap and at the last frame the disk has delivered.
+  - Fully decoded samples may be stored as int16 (SampleData::compactToInt16,
+    half the memory of float). The kernel is instantiated for both sample
+    types; int16 frames are widened to float 4 at a time as they are read.
+  - Kept header-only so the micro-benchmarks (bench/) exercise the exact
+    same kernel as the engine.
+*/
+
+struct SampleData {
+  static constexpr int kGuardFrames = 4;
+
+  double sampleRate = 48000.0;                         // rate of buffer: the engine's once converted
+  double sourceSampleRate = 48000.0;                   // rate of the file
+  juce::AudioBuffer<float> buffer;                     // whole sample, or the head of a streamed one
+  std::shared_ptr<const juce::AudioBuffer<float>> original; // unconverted data, when the engine keeps it
+  std::shared_ptr<sls::sampler::StreamSource> stream;  // set when the file is streamed from disk
+  std::shared_ptr<const sls::sampler::PitchMarks> pitchMarks; // fully decoded samples, found at load
+
+  juce::int64 getNumFrames() const noexcept { return stream ? stream->getLengthInFrames() : (juce::int64)getNumLoadedFrames(); }
+  int getNumLoadedFrames() const noexcept { return compactStride > 0 ? compactFrames : buffer.getNumSamples(); }
+  int getNumChannels() const noexcept { return compactStride > 0 ? compactChannels : buffer.getNumChannels(); }
+
+  // Moves buffer into guard-padded storage and points buffer at it. Call after filling
+  // (or modifying) buffer, before the data reaches the audio thread.
+  void addGuardFrames() {
+    const int chs = buffer.getNumChannels();
+    const int n = buffer.getNumSamples();
+    if (chs <= 0 || n <= 0) return;
+
+    const size_t stride = (size_t)n + 2 * kGuardFrames;
+    juce::HeapBlock<float> storage(stride * (size_t)chs);
+    std::vector<float*> channels((size_t)chs);
+
+    for (int ch = 0; ch < chs; ++ch) {
+      const float* src = buffer.getReadPointer(ch);
+      float* dst = storage.get() + (size_t)ch * stride;
+      std::fill(dst, dst + kGuardFrames, src[0]);
+      std::copy(src, src + n, dst + kGuardFrames);
+      std::fill(dst + kGuardFrames + n, dst + stride, src[n - 1]);
+      channels[(size_t)ch] = dst;
+    }
+
+    buffer.setDataToReferTo(channels.data(), chs, kGuardFrames, n);
+    guarded = std::move(storage);
+    guardedData = guarded.get();
+    guardedStride = stride;
+  }
+
+  bool hasGuardFrames() const noexcept { return guardedStride > 0 || compactStride > 0; }
+
+  // Frame 0 of a channel; frames -kGuardFrames .. numSamples + kGuardFrames - 1 are readable.
+  const float* getGuardedChannel(int ch) const noexcept {
+    return guardedData + (size_t)ch * guardedStride + kGuardFrames;
+  }
+
+  // Replaces the float frames with guard-padded int16 ones and empties buffer: half the
+  // memory, at 16-bit resolution. Not for streamed samples (their head stays float).
+  // Same rule as addGuardFrames: before the data reaches the audio thread.
+  void compactToInt16() {
+    const int chs = buffer.getNumChannels();
+    const int n = buffer.getNumSamples();
+    if (stream || chs <= 0 || n <= 0) return;
+
+    const size_t stride = (size_t)n + 2 * kGuardFrames;
+    juce::HeapBlock<int16_t> storage(stride * (size_t)chs);
+    for (int ch = 0; ch < chs; ++ch) {
+      const float* src = buffer.getReadPointer(ch);
+      int16_t* dst = storage.get() + (size_t)ch * stride;
+      for (int i = 0; i < n; ++i)
+        dst[kGuardFrames + i] = (int16_t)juce::jlimit(-32768, 32767, (int)std::lround(src[i] * 32768.0f));
+      std::fill(dst, dst + kGuardFrames, dst[kGuardFrames]);
+      std::fill(dst + kGuardFrames + n, dst + stride, dst[kGuardFrames + n - 1]);
+    }
+
+    buffer = juce::AudioBuffer<float>();
+    guarded.free();
+    guardedData = nullptr;
+    guardedStride = 0;
+    compact = std::move(storage);
+    compactData = compact.get();
+    compactStride = stride;
+    compactChannels = chs;
+    compactFrames = n;
+  }
+
+  bool isCompact() const noexcept { return compactStride > 0; }
+
+  // Frame 0 of an int16 channel, guard padded like getGuardedChannel.
+  const int16_t* getCompactChannel(int ch) const noexcept {
+    return compactData + (size_t)ch * compactStride + kGuardFrames;
+  }
+
+  // Uses frames laid out as the guarded (float) or compact (int16) storage, channels back to back,
+  // inside a read-only mapping the sample keeps open (PcmDiskCache). Instead of filling buffer.
+  void adoptMappedFrames(std::shared_ptr<const juce::MemoryMappedFile> file, const void* frames,
+                         int numChannels, int numFrames, bool int16) {
+    const size_t stride = (size_t)numFrames + 2 * kGuardFrames;
+    if (int16) {
+      compactData = static_cast<const int16_t*>(frames);
+      compactStride = stride;
+      compactChannels = numChannels;
+      compactFrames = numFrames;
+      buffer = juce::AudioBuffer<float>();
+    } else {
+      guardedData = static_cast<const float*>(frames);
+      guardedStride = stride;
+      std::vector<float*> channels((size_t)numChannels);
+      for (int ch = 0; ch < numChannels; ++ch)
+        channels[(size_t)ch] = const_cast<float*>(getGuardedChannel(ch)); // never written: samples are const once loaded
+      buffer.setDataToReferTo(channels.data(), numChannels, numFrames);
+    }
+    mapped = std::move(file);
+  }
+
+  // The loaded frames as float: buffer itself, or int16 frames widened into scratch.
+  // Decoder threads (analysis, rate conversion).
+  const juce::AudioBuffer<float>& getFloatFrames(juce::AudioBuffer<float>& scratch) const {
+    if (!isCompact()) return buffer;
+    scratch.setSize(compactChannels, compactFrames);
+    for (int ch = 0; ch < compactChannels; ++ch) {
+      const int16_t* src = getCompactChannel(ch);
+      float* dst = scratch.getWritePointer(ch);
+      for (int i = 0; i < compactFrames; ++i) dst[i] = (float)src[i] * (1.0f / 32768.0f);
+    }
+    return scratch;
+  }
+
+  // Bytes of sample data held (guard frames and a kept original included).
+  size_t getMemoryBytes() const noexcept {
+    size_t bytes = isCompact() ? compactStride * (size_t)compactChannels * sizeof(int16_t)
+                               : (guardedStride > 0 ? guardedStride : (size_t)buffer.getNumSamples())
+                                   * (size_t)buffer.getNumChannels() * sizeof(float);
+    if (original) bytes += (size_t)original->getNumSamples() * (size_t)original->getNumChannels() * sizeof(float);
+    return bytes;
+  }
+
+private:
+  juce::HeapBlock<float> guarded;
+  const float* guardedData = nullptr; // guarded, or inside mapped
+  size_t guardedStride = 0;
+  juce::HeapBlock<int16_t> compact;
+  const int16_t* compactData = nullptr;
+  size_t compactStride = 0;
+  int compactChannels = 0;
+  int compactFrames = 0;
+  std::shared_ptr<const juce::MemoryMappedFile> mapped;
+};
+
+struct SampleVoice {
+  static constexpr uint64_t kFxOne = (uint64_t)1 << 32;
+
+  bool active = false;
+  bool releasing = false;
+
+  juce::String instId = "sampler";
+  int note = 60;
+
+  std::shared_ptr<const SampleData> sample;
+  sls::sampler::StreamRing* stream = nullptr; // read-ahead ring when sample is streamed (owned by SampleStreamer)
+  int start = 0;
+  int end = 0;
+
+  uint64_t posFx = 0;       // 32.32 fixed-point frame position
+  uint64_t rateFx = kFxOne; // 32.32 fixed-point frames per output frame
+
+  float gainL = 1.0f;
+  float gainR = 1.0f;
+  int mixCh = 1;
+
+  int fadeOutTotal = 256;
+  int fadeOutRemaining = 0;
+  int fadeInTotal = 64;
+  int fadeInRemaining = 0;
+  int loopCrossfadeSamples = 192;
+  int zeroCrossSearchSamples = 0;
+  int releaseTailSamples = 192;
+
+  bool loopEnabled = false;
+  int loopStart = 0;
+  int loopEnd = 0;
+  int releaseEnd = 0;
+
+  void setPosition(double frames) noexcept { posFx = (uint64_t)std::llround(std::max(0.0, frames) * (double)kFxOne); }
+  double getPosition() const noexcept { return (double)posFx / (double)kFxOne; }
+  void setRate(double ratio) noexcept { rateFx = std::max<uint64_t>(1, (uint64_t)std::llround(std::max(0.0, ratio) * (double)kFxOne)); }
+
+  // Any thread: hands the read-ahead ring back to the streamer.
+  void releaseStream() noexcept {
+    if (stream) stream->release();
+    stream = nullptr;
+  }
+};
+
+namespace sls::sampler {
+
+constexpr float kFracScale = 1.0f / 4294967296.0f;
+constexpr float kInt16Scale = 1.0f / 32768.0f;
+
+inline float sampleValue(float x) noexcept { return x; }
+inline float sampleValue(int16_t x) noexcept { return (float)x * kInt16Scale; }
+
+// Loaded frames of a sample in either storage, read through the AudioBuffer-style calls the
+// Touski engines use. Refers to the sample's data; the sample must outlive it.
+class SampleFrames {
+public:
+  explicit SampleFrames(const SampleData& data) noexcept
+      : channels(data.getNumChannels()), frames(data.getNumLoadedFrames()) {
+    for (int ch = 0; ch < std::min(2, channels); ++ch) {
+      if (data.isCompact()) pcm16[ch] = data.getCompactChannel(ch);
+      else floats[ch] = data.buffer.getReadPointer(ch);
+    }
+  }
+
+  int getNumChannels() const noexcept { return channels; }
+  int getNumSamples() const noexcept { return frames; }
+  float getSample(int ch, int i) const noexcept { return pcm16[0] ? sampleValue(pcm16[ch][i]) : floats[ch][i]; }
+
+  // Channel 0 or 1, nullptr unless the sample is stored that way.
+  const float* getFloatChannel(int ch) const noexcept { return floats[ch]; }
+  const int16_t* getCompactChannel(int ch) const noexcept { return pcm16[ch]; }
+
+private:
+  const float* floats[2] = {};
+  const int16_t* pcm16[2] = {};
+  int channels = 0;
+  int frames = 0;
+};
+
+inline float hermite(float y0, float y1, float y2, float y3, float t) noexcept {
+  const float c0 = y1;
+  const float c1 = 0.5f * (y2 - y0);
+  const float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+  const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+  return ((c3 * t + c2) * t + c1) * t + c0;
+}
+
+// src must be guard padded (SampleData::getGuardedChannel / getCompactChannel).
+template <typename T>
+inline float hermiteAt(const T* src, uint64_t pos) noexcept {
+  const T* p = src + (pos >> 32);
+  return hermite(sampleValue(p[-1]), sampleValue(p[0]), sampleValue(p[1]), sampleValue(p[2]), (float)(uint32_t)pos * kFracScale);
+}
+
+// Number of frames starting at pos, stepping by rate, that stay below limit.
+inline int framesBefore(uint64_t pos, uint64_t rate, uint64_t limit) noexcept {
+  if (pos >= limit) return 0;
+  return (int)std::min<uint64_t>((limit - pos + rate - 1) / rate, (uint64_t)INT_MAX);
+}
+
+// Four frames side by side.
+struct Vec4 {
+ #if JUCE_USE_SSE_INTRINSICS
+  __m128 v;
+  static Vec4 load(const float* p) noexcept { return { _mm_loadu_ps(p) }; }
+  static Vec4 load(const int16_t* p) noexcept {
+    const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return { _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)), _mm_set1_ps(kInt16Scale)) };
+  }
+  static Vec4 fill(float x) noexcept { return { _mm_set1_ps(x) }; }
+  void addTo(float* p) const noexcept { _mm_storeu_ps(p, _mm_add_ps(_mm_loadu_ps(p), v)); }
+  friend Vec4 operator+(Vec4 a, Vec4 b) noexcept { return { _mm_add_ps(a.v, b.v) }; }
+  friend Vec4 operator-(Vec4 a, Vec4 b) noexcept { return { _mm_sub_ps(a.v, b.v) }; }
+  friend Vec4 operator*(Vec4 a, Vec4 b) noexcept { return { _mm_mul_ps(a.v, b.v) }; }
+ #elif SLS_SAMPLE_VOICE_NEON
+  float32x4_t v;
+  static Vec4 load(const float* p) noexcept { return { vld1q_f32(p) }; }
+  static Vec4 load(const int16_t* p) noexcept { return { vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(p))), kInt16Scale) }; }
+  static Vec4 fill(float x) noexcept { return { vdupq_n_f32(x) }; }
+  void addTo(float* p) const noexcept { vst1q_f32(p, vaddq_f32(vld1q_f32(p), v)); }
+  friend Vec4 operator+(Vec4 a, Vec4 b) noexcept { return { vaddq_f32(a.v, b.v) }; }
+  friend Vec4 operator-(Vec4 a, Vec4 b) noexcept { return { vsubq_f32(a.v, b.v) }; }
+  friend Vec4 operator*(Vec4 a, Vec4 b) noexcept { return { vmulq_f32(a.v, b.v) }; }
+ #else
+  float v[4];
+  static Vec4 load(const float* p) noexcept { return { { p[0], p[1], p[2], p[3] } }; }
+  static Vec4 load(const int16_t* p) noexcept { return { { sampleValue(p[0]), sampleValue(p[1]), sampleValue(p[2]), sampleValue(p[3]) } }; }
+  static Vec4 fill(float x) noexcept { return { { x, x, x, x } }; }
+  void addTo(float* p) const noexcept { for (int k = 0; k < 4; ++k) p[k] += v[k]; }
+  friend Vec4 operator+(Vec4 a, Vec4 b) noexcept { for (int k = 0; k < 4; ++k) a.v[k] += b.v[k]; return a; }
+  friend Vec4 operator-(Vec4 a, Vec4 b) noexcept { for (int k = 0; k < 4; ++k) a.v[k] -= b.v[k]; return a; }
+  friend Vec4 operator*(Vec4 a, Vec4 b) noexcept { for (int k = 0; k < 4; ++k) a.v[k] *= b.v[k]; return a; }
+ #endif
+};
+
+// Same arithmetic as hermite(), lane-wise.
+inline Vec4 hermite4(Vec4 y0, Vec4 y1, Vec4 y2, Vec4 y3, Vec4 t) noexcept {
+  const Vec4 c1 = Vec4::fill(0.5f) * (y2 - y0);
+  const Vec4 c2 = y0 - Vec4::fill(2.5f) * y1 + Vec4::fill(2.0f) * y2 - Vec4::fill(0.5f) * y3;
+  const Vec4 c3 = Vec4::fill(0.5f) * (y3 - y0) + Vec4::fill(1.5f) * (y1 - y2);
+  return ((c3 * t + c2) * t + c1) * t + y1;
+}
+
+// T: float, or int16_t for compact samples.
+template <typename T>
+struct SegmentParams {
+  const T* srcL;
+  const T* srcR;
+  uint64_t originFx; // absolute position of src[0] (non-zero for ring windows)
+  uint64_t rate;
+  float gainL, gainR;
+  int fadeDone;   // fade-in frames already played (FadeIn segments)
+  int fadeTotal;
+};
+
+template <bool FadeIn, typename T>
+inline float fadeInAmp(const SegmentParams<T>& s, int frame) noexcept {
+  return FadeIn ? (float)(s.fadeDone + frame) / (float)s.fadeTotal : 1.0f;
+}
+
+// Interpolates count frames starting at pos (no wrap, no end inside the segment).
+template <bool FadeIn, typename T>
+inline void renderPlainSegment(const SegmentParams<T>& s, uint64_t& pos, float* outL, float* outR, int count) noexcept {
+  const Vec4 gL = Vec4::fill(s.gainL);
+  const Vec4 gR = Vec4::fill(s.gainR);
+  int i = 0;
+
+  if (s.rate == SampleVoice::kFxOne) {
+    // Integer stride: every frame shares one fraction and reads the source contiguously.
+    const T* pL = s.srcL + (pos >> 32);
+    const T* pR = s.srcR + (pos >> 32);
+    const float t = (float)(uint32_t)pos * kFracScale;
+
+    if ((uint32_t)pos == 0 && !FadeIn) {
+      for (; i + 4 <= count; i += 4) {
+        (Vec4::load(pL + i) * gL).addTo(outL + i);
+        (Vec4::load(pR + i) * gR).addTo(outR + i);
+      }
+    } else {
+      const Vec4 t4 = Vec4::fill(t);
+      for (; i + 4 <= count; i += 4) {
+        Vec4 inL = hermite4(Vec4::load(pL + i - 1), Vec4::load(pL + i), Vec4::load(pL + i + 1), Vec4::load(pL + i + 2), t4) * gL;
+        Vec4 inR = hermite4(Vec4::load(pR + i - 1), Vec4::load(pR + i), Vec4::load(pR + i + 1), Vec4::load(pR + i + 2), t4) * gR;
+        if (FadeIn) {
+          const float a[4] = { fadeInAmp<FadeIn>(s, i), fadeInAmp<FadeIn>(s, i + 1), fadeInAmp<FadeIn>(s, i + 2), fadeInAmp<FadeIn>(s, i + 3) };
+          const Vec4 amp = Vec4::load(a);
+          inL = inL * amp;
+          inR = inR * amp;
+        }
+        inL.addTo(outL + i);
+        inR.addTo(outR + i);
+      }
+    }
+    pos += (uint64_t)i * s.rate;
+  } else {
+    // Fractional stride: gather 4 frames of taps, interpolate them together.
+    for (; i + 4 <= count; i += 4) {
+      alignas(16) float y[8][4];
+      alignas(16) float t[4];
+      for (int k = 0; k < 4; ++k) {
+        const T* pL = s.srcL + (pos >> 32);
+        const T* pR = s.srcR + (pos >> 32);
+        y[0][k] = sampleValue(pL[-1]); y[1][k] = sampleValue(pL[0]); y[2][k] = sampleValue(pL[1]); y[3][k] = sampleValue(pL[2]);
+        y[4][k] = sampleValue(pR[-1]); y[5][k] = sampleValue(pR[0]); y[6][k] = sampleValue(pR[1]); y[7][k] = sampleValue(pR[2]);
+        t[k] = (float)(uint32_t)pos * kFracScale;
+        pos += s.rate;
+      }
+      const Vec4 t4 = Vec4::load(t);
+      Vec4 inL = hermite4(Vec4::load(y[0]), Vec4::load(y[1]), Vec4::load(y[2]), Vec4::load(y[3]), t4) * gL;
+      Vec4 inR = hermite4(Vec4::load(y[4]), Vec4::load(y[5]), Vec4::load(y[6]), Vec4::load(y[7]), t4) * gR;
+      if (FadeIn) {
+        const float a[4] = { fadeInAmp<FadeIn>(s, i), fadeInAmp<FadeIn>(s, i + 1), fadeInAmp<FadeIn>(s, i + 2), fadeInAmp<FadeIn>(s, i + 3) };
+        const Vec4 amp = Vec4::load(a);
+        inL = inL * amp;
+        inR = inR * amp;
+      }
+      inL.addTo(outL + i);
+      inR.addTo(outR + i);
+    }
+  }
+
+  for (; i < count; ++i) {
+    const float amp = fadeInAmp<FadeIn>(s, i);
+    outL[i] += hermiteAt(s.srcL, pos) * s.gainL * amp;
+    outR[i] += hermiteAt(s.srcR, pos) * s.gainR * amp;
+    pos += s.rate;
+  }
+}
+
+// Equal-power crossfade between the loop tail and the frames before loopStart.
+template <typename T>
+inline void renderCrossfadeSegment(const SegmentParams<T>& s, bool fadeIn, uint64_t& pos,
+                                   uint64_t crossStartFx, uint64_t loopEndFx, uint64_t loopLenFx, int xfadeFrames,
+                                   float* outL, float* outR, int count) noexcept {
+  for (int i = 0; i < count; ++i) {
+    const uint64_t crossPos = std::max(pos, crossStartFx);
+    const double distToLoopEnd = (double)(loopEndFx - crossPos) / (double)SampleVoice::kFxOne;
+    const float t = (float)juce::jlimit(0.0, 1.0, 1.0 - distToLoopEnd / (double)xfadeFrames);
+    const uint64_t wrapPos = crossPos >= loopLenFx ? crossPos - loopLenFx : 0;
+    const float a = std::cos(t * juce::MathConstants<float>::halfPi);
+    const float b = std::sin(t * juce::MathConstants<float>::halfPi);
+
+    const float inL = hermiteAt(s.srcL, crossPos) * a + hermiteAt(s.srcL, wrapPos) * b;
+    const float inR = hermiteAt(s.srcR, crossPos) * a + hermiteAt(s.srcR, wrapPos) * b;
+    const float amp = fadeIn ? fadeInAmp<true>(s, i) : 1.0f;
+    outL[i] += inL * s.gainL * amp;
+    outR[i] += inR * s.gainR * amp;
+    pos += s.rate;
+  }
+}
+
+// Releasing voices: fade-out and release-tail ramps, checked per frame (short-lived).
+// Returns false when the voice finished inside the segment.
+template <typename T>
+inline bool renderReleaseSegment(SampleVoice& sv, const SegmentParams<T>& s, uint64_t& pos,
+                                 float* outL, float* outR, int count) noexcept {
+  for (int i = 0; i < count; ++i) {
+    float amp = 1.0f;
+    if (sv.fadeInRemaining > 0) {
+      const int done = sv.fadeInTotal - sv.fadeInRemaining;
+      amp *= (float)done / (float)std::max(1, sv.fadeInTotal);
+      --sv.fadeInRemaining;
+    }
+
+    if (sv.fadeOutRemaining > 0) {
+      amp *= (float)sv.fadeOutRemaining / (float)std::max(1, sv.fadeOutTotal);
+      if (--sv.fadeOutRemaining <= 0) return false;
+    }
+
+    if (sv.releaseTailSamples > 0) {
+      const double samplesToEnd = (double)sv.end - (double)(pos + s.originFx) / (double)SampleVoice::kFxOne;
+      if (samplesToEnd <= 0.0) return false;
+      if (samplesToEnd <= (double)sv.releaseTailSamples)
+        amp *= (float)(samplesToEnd / (double)sv.releaseTailSamples);
+    }
+
+    outL[i] += hermiteAt(s.srcL, pos) * s.gainL * amp;
+    outR[i] += hermiteAt(s.srcR, pos) * s.gainR * amp;
+    pos += s.rate;
+  }
+  return true;
+}
+
+// Disk fell behind: the voice keeps time but outputs nothing for the rest of the block.
+inline void skipFrames(SampleVoice& sv, uint64_t& pos, int count) noexcept {
+  pos += (uint64_t)count * sv.rateFx;
+  sv.fadeInRemaining = std::max(0, sv.fadeInRemaining - count);
+  if (sv.releasing && sv.fadeOutRemaining > 0) {
+    sv.fadeOutRemaining -= count;
+    if (sv.fadeOutRemaining <= 0) sv.active = false;
+  }
+}
+
+// The block loop of renderSampleVoiceBlock for one storage type. Streamed samples are always
+// float, so only that instantiation reads the ring.
+template <typename T>
+inline void renderSampleVoiceFrames(SampleVoice& sv, SegmentParams<T> s, StreamRing* ring, juce::int64 lastFrame,
+                                    float* outL, float* outR, int n) noexcept {
+  // Loop geometry (never for releasing or streamed voices). Crossfade frames: those whose
+  // next position passes crossStart.
+  const bool looping = !sv.releasing && !ring && sv.loopEnabled && sv.loopEnd > sv.loopStart;
+  const uint64_t loopStartFx = (uint64_t)std::max(0, sv.loopStart) << 32;
+  const uint64_t loopEndFx = (uint64_t)std::max(0, sv.loopEnd) << 32;
+  const uint64_t loopLenFx = loopEndFx - loopStartFx;
+  const int xfadeFrames = (looping && sv.loopCrossfadeSamples > 0)
+    ? std::min(sv.loopCrossfadeSamples, std::max(1, sv.loopEnd - sv.loopStart - 1))
+    : 0;
+  const uint64_t crossStartFx = loopEndFx - ((uint64_t)xfadeFrames << 32);
+  const uint64_t plainLimitFx = xfadeFrames > 0
+    ? (crossStartFx >= s.rate ? crossStartFx - s.rate + 1 : 0)
+    : loopEndFx;
+
+  const uint64_t lastFrameFx = (uint64_t)lastFrame << 32;
+  uint64_t pos = sv.posFx;
+  for (int i = 0; i < n;) {
+    if (looping && pos >= loopEndFx) pos = loopStartFx + (pos - loopStartFx) % loopLenFx;
+    if (pos >= lastFrameFx) {
+      sv.active = false;
+      break;
+    }
+
+    int count = std::min(n - i, framesBefore(pos, s.rate, lastFrameFx));
+
+    if constexpr (std::is_same_v<T, float>) {
+      if (ring) {
+        // Window of the ring that is contiguous and already delivered (all four taps).
+        const juce::int64 frame = (juce::int64)(pos >> 32);
+        const juce::int64 base = frame & ~(juce::int64)(ring->getCapacity() - 1);
+        const juce::int64 readyEnd = std::min(base + ring->getCapacity(), ring->getFilledEnd() - 2);
+        if (frame >= readyEnd) {
+          ring->countUnderrun();
+          skipFrames(sv, pos, n - i);
+          break;
+        }
+        count = std::min(count, framesBefore(pos, s.rate, (uint64_t)readyEnd << 32));
+        s.srcL = ring->getChannel(0);
+        s.srcR = ring->getChannel(ring->getNumChannels() > 1 ? 1 : 0);
+        s.originFx = (uint64_t)base << 32;
+      }
+    }
+
+    uint64_t local = pos - s.originFx;
+    if (sv.releasing) {
+      const bool alive = renderReleaseSegment(sv, s, local, outL + i, outR + i, count);
+      pos = local + s.originFx;
+      if (!alive) {
+        sv.active = false;
+        break;
+      }
+      i += count;
+      continue;
+    }
+
+    const bool fadeIn = sv.fadeInRemaining > 0;
+    if (fadeIn) count = std::min(count, sv.fadeInRemaining);
+    s.fadeDone = sv.fadeInTotal - sv.fadeInRemaining;
+
+    const bool crossfade = looping && xfadeFrames > 0 && pos >= plainLimitFx;
+    if (looping) count = std::min(count, framesBefore(pos, s.rate, crossfade ? loopEndFx : plainLimitFx));
+
+    if (crossfade)
+      renderCrossfadeSegment(s, fadeIn, local, crossStartFx, loopEndFx, loopLenFx, xfadeFrames, outL + i, outR + i, count);
+    else if (fadeIn)
+      renderPlainSegment<true>(s, local, outL + i, outR + i, count);
+    else
+      renderPlainSegment<false>(s, local, outL + i, outR + i, count);
+    pos = local + s.originFx;
+
+    if (fadeIn) sv.fadeInRemaining -= count;
+    i += count;
+  }
+
+  if (looping && pos >= loopEndFx) pos = loopStartFx + (pos - loopStartFx) % loopLenFx;
+  sv.posFx = pos;
+}
+
+} // namespace sls::sampler
+
+// Renders up to n frames of one sample voice, adding into outL/outR.
+inline void renderSampleVoiceBlock(SampleVoice& sv, float* outL, float* outR, int n) {
+  using namespace sls::sampler;
+
+  if (!sv.active || !sv.sample) return;
+
+  const auto& data = *sv.sample;
+  StreamRing* const ring = sv.stream;
+  const juce::int64 numFrames = ring ? data.getNumFrames() : (juce::int64)data.getNumLoadedFrames();
+  const juce::int64 lastFrame = std::min<juce::int64>(sv.end, numFrames - 1);
+  if (numFrames <= 1 || lastFrame <= 0 || !data.hasGuardFrames()) {
+    jassert(numFrames <= 1 || data.hasGuardFrames()); // loaders must call addGuardFrames()
+    sv.active = false;
+    sv.releaseStream();
+    return;
+  }
+
+  const int rch = data.getNumChannels() > 1 ? 1 : 0;
+  if (data.isCompact()) {
+    SegmentParams<int16_t> s;
+    s.srcL = data.getCompactChannel(0);
+    s.srcR = data.getCompactChannel(rch);
+    s.originFx = 0;
+    s.rate = sv.rateFx;
+    s.gainL = sv.gainL;
+    s.gainR = sv.gainR;
+    s.fadeTotal = std::max(1, sv.fadeInTotal);
+    renderSampleVoiceFrames(sv, s, nullptr, lastFrame, outL, outR, n);
+  } else {
+    SegmentParams<float> s;
+    s.srcL = data.getGuardedChannel(0);
+    s.srcR = data.getGuardedChannel(rch);
+    s.originFx = 0;
+    s.rate = sv.rateFx;
+    s.gainL = sv.gainL;
+    s.gainR = sv.gainR;
+    s.fadeTotal = std::max(1, sv.fadeInTotal);
+    renderSampleVoiceFrames(sv, s, ring, lastFrame, outL, outR, n);
+  }
+
+  if (ring) {
+    if (sv.active) ring->setReadFrame((juce::int64)(sv.posFx >> 32) - 1);
+    else sv.releaseStream();
+  }
+}
@@ -0,0 +1,312 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <juce_core/juce_core.h>
+
+/*
+  ShmIpc
+  ======
+  Binary IPC transport negotiated over the JSON-lines protocol (ipc.binary.open).
+
+  One memory-mapped file holds a header, a telemetry block and two
+  single-producer / single-consumer byte rings:
+    - telemetry: meters and transport position, republished by the audio
+                 thread every callback under a seqlock (read it at any rate)
+    - toEngine : client -> engine hot requests (notes, params, schedule, transport)
+    - toClient : engine -> client messages (meters, transport state, errors)
+
+  Every record is an 8-byte ShmMsgHeader followed by a fixed-layout payload,
+  padded to 8 bytes. Records never wrap: a producer that reaches the end of the
+  ring writes a Pad record and continues at offset 0. Positions are free-running
+  64-bit byte counters; the producer publishes writePos with release semantics
+  after the record is complete, the consumer publishes readPos the same way.
+
+  All integers are little-endian, strings are NUL-padded UTF-8. The layout is
+  versioned by kShmVersion and described in docs/PROTOCOL_IPC.md.
+*/
+
+namespace sls::ipc {
+
+constexpr uint32_t kShmVersion = 2;
+constexpr char kShmMagic[8] = { 'S', 'L', 'S', 'I', 'P', 'C', 'B', '1' };
+
+enum class ShmMsgType : uint16_t {
+  Pad            = 0,
+
+  // client -> engine
+  NoteOn         = 1,
+  NoteOff        = 2,
+  InstParamSet   = 3,
+  MixerParamSet  = 4,
+  SchedulePush   = 5,
+  Transport      = 6,
+
+  // engine -> client
+  MeterLevel     = 64,
+  TransportState = 65,
+  Error          = 66
+};
+
+struct ShmMsgHeader {
+  uint16_t type = 0;
+  uint16_t flags = 0;
+  uint32_t size = 0;     // payload bytes (record length = 8 + size rounded up to 8)
+};
+
+struct ShmNote {         // NoteOn / NoteOff
+  char instId[32];
+  int32_t mixCh;
+  int32_t note;
+  float velocity;
+  int32_t sampleOffset;  // frames into the next audio block, 0 = block start
+};
+
+struct ShmInstParam {    // InstParamSet: one numeric param
+  char instId[32];
+  char param[32];
+  float value;
+  int32_t reserved;
+};
+
+struct ShmMixerParam {   // MixerParamSet
+  int32_t scope;         // 0 = master, 1 = channel
+  int32_t ch;
+  char param[32];
+  float value;
+  int32_t reserved;
+};
+
+enum class ShmEventKind : int32_t { NoteOn = 0, NoteOff = 1, TouskiNoteOn = 2, TouskiNoteOff = 3 };
+
+struct ShmScheduleEvent {
+  double atPpq;
+  double durPpq;
+  char instId[32];
+  int32_t kind;          // ShmEventKind
+  int32_t mixCh;
+  int32_t note;
+  float velocity;
+};
+
+struct ShmSchedulePush { // followed by count ShmScheduleEvent
+  uint32_t count;
+  uint32_t reserved;
+};
+
+enum class ShmTransportAction : int32_t { Play = 0, Stop = 1, SeekPpq = 2, SeekSamples = 3, SetTempo = 4 };
+
+struct ShmTransport {
+  int32_t action;        // ShmTransportAction
+  int32_t reserved;
+  double value;          // ppq, samples or bpm depending on action
+};
+
+struct ShmTransportState {
+  int32_t playing;
+  int32_t reserved;
+  double bpm;
+  double ppq;
+  int64_t samplePos;
+};
+
+struct ShmMeterFrame {
+  int32_t ch;            // -1 = master
+  float rms[2];
+  float peak[2];
+};
+
+struct ShmMeterLevel {   // followed by count ShmMeterFrame
+  uint32_t count;
+  uint32_t reserved;
+};
+
+enum class ShmErrorCode : int32_t { QueueFull = 1, BadMessage = 2, Busy = 3 };
+
+struct ShmError {
+  uint16_t msgType;      // offending ShmMsgType
+  uint16_t reserved;
+  int32_t code;          // ShmErrorCode
+};
+
+static_assert(sizeof(ShmMsgHeader) == 8, "ShmMsgHeader layout");
+static_assert(sizeof(ShmNote) == 48, "ShmNote layout");
+static_assert(sizeof(ShmInstParam) == 72, "ShmInstParam layout");
+static_assert(sizeof(ShmMixerParam) == 48, "ShmMixerParam layout");
+static_assert(sizeof(ShmScheduleEvent) == 64, "ShmScheduleEvent layout");
+static_assert(sizeof(ShmTransport) == 16, "ShmTransport layout");
+static_assert(sizeof(ShmTransportState) == 32, "ShmTransportState layout");
+static_assert(sizeof(ShmMeterFrame) == 20, "ShmMeterFrame layout");
+constexpr int kTelemetryChannels = 64;
+
+// Seqlock payload: copied as a whole by the writer and by readers.
+struct ShmTelemetryData {
+  uint64_t blockCounter;     // audio callbacks since the engine started
+  int64_t hostTimeNs;        // device timestamp of the block start (monotonic clock when the driver has none)
+  int64_t samplePos;         // transport position at the end of the block
+  double ppq;
+  double bpm;
+  double sampleRate;
+  int32_t blockSize;
+  int32_t playing;
+  int32_t numChannels;       // valid entries in channels[]
+  int32_t reserved;
+  ShmMeterFrame master;      // ch = -1
+  ShmMeterFrame channels[kTelemetryChannels];
+};
+
+// Readers may set peakReset to 1 after reading: the engine then restarts peak hold
+// from its next block (peaks otherwise hold the maximum since the last reset).
+struct ShmTelemetry {
+  std::atomic<uint32_t> sequence;  // odd while the engine writes data
+  std::atomic<uint32_t> peakReset;
+  uint32_t reserved[2];
+  ShmTelemetryData data;
+};
+
+static_assert(sizeof(ShmError) == 8, "ShmError layout");
+static_assert(sizeof(ShmTelemetryData) == 1368, "ShmTelemetryData layout");
+static_assert(sizeof(ShmTelemetry) == 1384, "ShmTelemetry layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory rings need address-free 64-bit atomics");
+
+struct alignas(64) ShmRingHeader {
+  uint32_t capacity;     // data bytes (power of two, multiple of 8)
+  uint32_t dataOffset;   // from the start of the file
+  alignas(64) std::atomic<uint64_t> writePos;
+  alignas(64) std::atomic<uint64_t> readPos;
+};
+
+struct ShmFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t headerBytes;
+  std::atomic<uint32_t> engineAttached; // 1 while the engine serves the rings
+  uint32_t telemetryOffset;             // ShmTelemetry, inside the header page
+  ShmRingHeader toEngine;
+  ShmRingHeader toClient;
+};
+
+// Writer side (one thread). Never blocks.
+inline void publishTelemetry(ShmTelemetry& t, const ShmTelemetryData& d) noexcept {
+  const uint32_t seq = t.sequence.load(std::memory_order_relaxed);
+  t.sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(&t.data, &d, sizeof(d));
+  t.sequence.store(seq + 2, std::memory_order_release);
+}
+
+// Reader side (any thread or process). Returns false if every attempt overlapped a write.
+inline bool readTelemetry(const ShmTelemetry& t, ShmTelemetryData& out, int maxAttempts = 64) noexcept {
+  for (int i = 0; i < maxAttempts; ++i) {
+    const uint32_t before = t.sequence.load(std::memory_order_acquire);
+    if (before & 1u) continue;
+    std::memcpy(&out, &t.data, sizeof(out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (t.sequence.load(std::memory_order_relaxed) == before) return true;
+  }
+  return false;
+}
+
+// Process-local view of one ring inside the mapping.
+class ShmRing {
+public:
+  void attach(ShmRingHeader* header, uint8_t* data) noexcept { mHeader = header; mData = data; }
+  bool isAttached() const noexcept { return mHeader != nullptr; }
+
+  // Producer side (one thread at a time).
+  bool write(ShmMsgType type, const void* payload, uint32_t size) noexcept;
+
+  // Consumer side: calls fn(type, payload, size) for up to maxMessages records. Returns records read.
+  // A record header that cannot be valid (a Pad or record running past the published bytes or
+  // the end of the ring, or larger than capacity / 2) loses the framing: onBadRecord(type) is
+  // called and the reader resyncs by skipping everything published so far.
+  template <typename Fn, typename BadFn>
+  int read(Fn&& fn, BadFn&& onBadRecord, int maxMessages) {
+    if (!mHeader) return 0;
+    const uint64_t capacity = mHeader->capacity;
+    const uint64_t mask = capacity - 1;
+    uint64_t readPos = mHeader->readPos.load(std::memory_order_relaxed);
+    int count = 0;
+    while (count < maxMessages) {
+      const uint64_t writePos = mHeader->writePos.load(std::memory_order_acquire);
+      if (readPos == writePos) break;
+
+      ShmMsgHeader h;
+      std::memcpy(&h, mData + (readPos & mask), sizeof(h));
+      const uint64_t available = writePos - readPos;
+      const uint64_t toEnd = capacity - (readPos & mask);
+      if (h.type == (uint16_t)ShmMsgType::Pad) {
+        if (toEnd > available) {
+          onBadRecord((ShmMsgType)h.type);
+          readPos = writePos;
+          ++count;
+        } else {
+          readPos += toEnd;
+        }
+      } else {
+        const uint64_t recordBytes = recordSize(h.size);
+        if (recordBytes > capacity / 2 || recordBytes > toEnd || recordBytes > available) {
+          onBadRecord((ShmMsgType)h.type);
+          readPos = writePos;
+        } else {
+          fn((ShmMsgType)h.type, mData + (readPos & mask) + sizeof(h), h.size);
+          readPos += recordBytes;
+        }
+        ++count;
+      }
+      mHeader->readPos.store(readPos, std::memory_order_release);
+    }
+    return count;
+  }
+
+  static uint64_t recordSize(uint32_t payloadBytes) noexcept {
+    return (sizeof(ShmMsgHeader) + (uint64_t)payloadBytes + 7u) & ~(uint64_t)7u;
+  }
+
+private:
+  ShmRingHeader* mHeader = nullptr;
+  uint8_t* mData = nullptr;
+};
+
+// Owns the mapped file; the engine creates and initialises it, the client maps the same path.
+class ShmIpcTransport {
+public:
+  ShmIpcTransport();
+  ~ShmIpcTransport();
+
+  // ringBytes is rounded up to a power of two (64 KiB .. 16 MiB).
+  bool open(const juce::File& file, uint32_t ringBytes, juce::String& error);
+  void close();
+
+  bool isOpen() const noexcept { return mMap != nullptr; }
+  const juce::File& getFile() const noexcept { return mFile; }
+  uint32_t getRingBytes() const noexcept { return mRingBytes; }
+  uint32_t getToEngineOffset() const noexcept;
+  uint32_t getToClientOffset() const noexcept;
+  uint32_t getTelemetryOffset() const noexcept;
+
+  ShmTelemetry* telemetry() noexcept { return mTelemetry; }
+  ShmRing& toEngine() noexcept { return mToEngine; }
+  ShmRing& toClient() noexcept { return mToClient; }
+
+private:
+  std::unique_ptr<juce::MemoryMappedFile> mMap;
+  ShmFileHeader* mHeader = nullptr;
+  ShmTelemetry* mTelemetry = nullptr;
+  juce::File mFile;
+  uint32_t mRingBytes = 0;
+  ShmRing mToEngine;
+  ShmRing mToClient;
+};
+
+// Copies a NUL-padded fixed-size field into a juce::String (stops at the first NUL).
+template <size_t N>
+juce::String fixedString(const char (&field)[N]) {
+  size_t len = 0;
+  while (len < N && field[len] != '\0') ++len;
+  return juce::String::fromUTF8(field, (int)len);
+}
+
+} // namespace sls::ipc
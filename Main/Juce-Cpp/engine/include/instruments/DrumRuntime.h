@@ -32,6 +32,10 @@ public:
         juce::String pieceId;
     };
 
+    // Piece patches are compiled through patches, which must outlive the runtime.
+    explicit DrumRuntime(fm::FmPatchLibrary& patches) : patches_(patches) {}
+
+    // prepare and syncFromInstrumentState allocate; call them off the audio thread.
     void prepare(double sampleRate, int maxVoicesPerPiece);
     void reset();
     void syncFromInstrumentState(const sls::inst::InstrumentState& state);
@@ -42,13 +46,15 @@ public:
     void noteOn(const juce::String& instId, int midiNote, float velocity, int fallbackMixChannel = 1);
     void noteOff(int midiNote);
     std::vector<RenderTap> renderFrame();
+    // Adds numSamples frames of the pieces routed to bus (index = mixChannel - 1, clamped to numBuses).
+    // Different buses touch different pieces, so buses may be rendered concurrently.
+    void renderBus(int bus, int numBuses, float* left, float* right, int numSamples);
 
 private:
     struct PieceRuntime {
         sls::inst::DrumPieceSpec spec;
         PieceRouting routing;
         int fallbackMixChannel = 1;
-        bool prepared = false;
         fm::FmPatch patch;
         fm::FmEngine engine;
     };
@@ -56,6 +62,7 @@ private:
     PieceRuntime* findPieceRuntimeForNote(int midiNote);
     const PieceRuntime* findPieceRuntimeForNote(int midiNote) const;
 
+    fm::FmPatchLibrary& patches_;
     double sampleRate_ = 48000.0;
     int maxVoicesPerPiece_ = 8;
     FmDrumInstrument factory_;
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace sls::engine {
+
+enum class EnvelopeStage {
+    Idle,
+    Attack,
+    Decay,
+    Sustain,
+    Release
+};
+
+// Per-sample rates of one ADSR envelope at one sample rate, worked out once per patch
+// or note and copied into the envelope.
+struct EnvelopeRates {
+    float attackStep = 0.0f;     // 0 -> 1
+    float decayStep = 0.0f;      // 1 -> sustainLevel
+    float sustainLevel = 0.7f;
+    float releaseSamples = 1.0f; // linear release: from the current level to 0 over this many samples
+    float releaseFactor = 0.0f;  // > 0: exponential release instead, times this per sample...
+    float releaseFloor = 0.0f;   // ...until the level falls below this
+
+    static EnvelopeRates compute(double attackSeconds, double decaySeconds, float sustainLevel,
+                                 double releaseSeconds, double sampleRate);
+    // Release falling 1 -> floorLevel over releaseSeconds, multiplicatively.
+    void setExponentialRelease(double releaseSeconds, double sampleRate, float floorLevel);
+};
+
+// ADSR envelope run as segments: each stage is one linear ramp (start + step * k) or
+// exponential one (times factor per sample) whose length is worked out when the stage
+// begins, ending exactly on its target. Nothing is decided per sample but where the
+// current segment ends, so render() fills a block a segment at a time, four samples per
+// vector op. getNextSample() and render() give the same values on linear segments; on
+// exponential ones (only the legacy voices use them) they may differ by rounding.
+class Envelope {
+public:
+    void reset() noexcept;
+    void setRates(const EnvelopeRates& rates) noexcept { rates_ = rates; }
+
+    void noteOn() noexcept;  // attack from the current level
+    void noteOff() noexcept; // release from the current level
+    float getNextSample() noexcept;
+
+    // Writes the next numSamples values into out. Returns the index of the sample after
+    // which the envelope went idle (it reads 0 from there), or numSamples if it still runs.
+    int render(float* out, int numSamples) noexcept;
+
+    bool isActive() const noexcept { return stage_ != EnvelopeStage::Idle; }
+    EnvelopeStage stage() const noexcept { return stage_; }
+    float value() const noexcept { return value_; }
+
+private:
+    void beginLinear(EnvelopeStage stage, float target, float step, double samples) noexcept;
+    void beginExponential(float target, double samples) noexcept;
+    void finishSegment() noexcept;
+
+    EnvelopeRates rates_;
+    EnvelopeStage stage_ = EnvelopeStage::Idle;
+    float value_ = 0.0f;  // last value given out
+    float start_ = 0.0f;  // segment: value_ at its start
+    float step_ = 0.0f;   // linear segments
+    float factor_ = 0.0f; // > 0 on exponential segments
+    float target_ = 0.0f; // value of its last sample
+    int done_ = 0;        // samples of it given out
+    int length_ = 0;
+};
+
+// Renders a block of many envelopes, one row per envelope (rows are numFrames apart), and
+// remembers how long each ran: the FM block renderer reads a chunk of operator envelopes
+// from here instead of stepping every envelope once per frame.
+class EnvelopeBank {
+public:
+    void prepare(int maxEnvelopes, int maxFrames);
+    int maxFrames() const noexcept { return maxFrames_; }
+
+    // Renders envelopes[0, count) into rows [first, first + count). A null envelope's row
+    // reads 0, as an idle envelope's does.
+    void render(Envelope* const* envelopes, int first, int count, int numFrames) noexcept;
+
+    const float* row(int envelope) const noexcept { return values_.data() + envelope * maxFrames_; }
+    // Samples after which envelope e was still running: numFrames if it runs on, the sample
+    // it went idle at otherwise, -1 when it was idle before the block.
+    int runningFrames(int envelope) const noexcept { return running_[static_cast<std::size_t>(envelope)]; }
+
+private:
+    int maxFrames_ = 0;
+    std::vector<float> values_;
+    std::vector<int> running_;
+};
+
+} // namespace sls::engine
@@ -3,6 +3,7 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_core/juce_core.h>
 
+#include <array>
 #include <cmath>
 #include <functional>
 #include <limits>
@@ -10,15 +11,15 @@
 #include <unordered_map>
 #include <vector>
 
+#include "LoopAnalysis.h"
+#include "SampleVoice.h"
+
 namespace sls::inst {
 
 class SampleTouskiInstrument {
 public:
-  struct SampleData {
-    juce::AudioBuffer<float> buffer;
-    double sampleRate = 44100.0;
-    juce::String path;
-  };
+  // Decoded, guard-padded sample shared with the engine's sample pool.
+  using SampleData = ::SampleData;
 
   struct RuntimeParams {
     juce::String programPath;
@@ -46,7 +47,7 @@ public:
   struct Zone {
     int rootMidi = 60;
     juce::String samplePath;
-    std::shared_ptr<SampleData> sample;
+    std::shared_ptr<const SampleData> sample;
 
     float posAction = 0.0f;
     float posLoopStart = 0.15f;
@@ -64,21 +65,23 @@ public:
     float seamDiffuse = 0.35f;
 
     bool loopEnabled = true;
+
+    // Seamless loop points, analysed off the audio thread (analyseLoops). Used while
+    // loop.spec still matches the zone's parameters, otherwise voices loop as requested.
+    sls::sampler::LoopPoints loop;
   };
 
+  // Everything a voice needs, in frames and samples: no strings, so building one at note-on
+  // is a copy of the zone's prepared spec plus the note, channel and velocity.
   struct VoiceSpec {
     bool valid = false;
 
-    juce::String instId;
-    juce::String smartPlaybackMode = "hold_loop_then_release";
-    juce::String pitchEngine = "granular";
-
+    juce::int64 instKey = 0;  // instKeyFor(instId)
     int note = 60;
     int mixCh = 1;
 
-    juce::String samplePath;
     int rootMidi = 60;
-    std::shared_ptr<SampleData> sample;
+    std::shared_ptr<const SampleData> sample;
 
     float posAction = 0.0f;
     float posLoopStart = 0.15f;
@@ -97,6 +100,7 @@ public:
     float gainR = 1.0f;
 
     bool loopEnabled = false;
+    bool loopAnalysed = false; // loopStart / loopEnd are the zone's analysed seam, use as is
     bool releasing = false;
     bool useGranularHold = false;
 
@@ -117,13 +121,36 @@ public:
   struct ProgramState {
     RuntimeParams params;
     std::unordered_map<int, Zone> zones;
+
+    // Compiled from zones and params (compileProgram) whenever either or the sample rate
+    // changes: every MIDI note maps to its nearest zone's prepared voice.
+    struct KeyEntry {
+      int zoneVoice = -1;       // index into zoneVoices, -1 when no zone has a sample
+      double rateRatio = 1.0;
+    };
+    std::vector<VoiceSpec> zoneVoices;
+    std::array<KeyEntry, 128> keyMap;
+    bool holdLoopOnNoteOff = true;
   };
 
-  using LoadSampleFn = std::function<std::shared_ptr<SampleData>(const juce::String& absolutePath)>;
+  // Installed programs are never modified: a change installs a new ProgramState, so a copy of
+  // the table stays valid (and playable from the audio thread) however the instrument changes.
+  using ProgramTable = std::unordered_map<juce::String, std::shared_ptr<const ProgramState>>;
+
+  // Resolves a zone's file when the program loads, so note-on never touches the disk.
+  using LoadSampleFn = std::function<std::shared_ptr<const SampleData>(const juce::String& absolutePath)>;
+
+  // Finds (or looks up) the loop points of one zone; may be slow, never called on the audio thread.
+  using LoopAnalyseFn = std::function<sls::sampler::LoopPoints(const std::shared_ptr<const SampleData>& sample,
+                                                               const sls::sampler::LoopSpec& spec)>;
 
   explicit SampleTouskiInstrument(LoadSampleFn loadSampleFn = {});
 
+  // Voices and note-offs identify their instrument by this key instead of the id string.
+  static juce::int64 instKeyFor(const juce::String& instId) noexcept { return instId.hashCode64(); }
+
   void setLoadSampleFn(LoadSampleFn fn);
+  // Recompiles the installed programs (their ms settings are kept in frames).
   void setSampleRate(double sr);
   double getSampleRate() const noexcept;
 
@@ -131,12 +158,34 @@ public:
                    const juce::var& inlineProgramPayload,
                    juce::String* errorMessage = nullptr);
 
+  // loadProgram in two steps: prepareProgram parses and resolves every zone's sample
+  // (any thread, touches no instrument state); installProgram publishes the result and
+  // hands back the replaced program (null if none) so the caller chooses where it is released.
+  bool prepareProgram(const juce::var& inlineProgramPayload,
+                      ProgramState& outState,
+                      const LoadSampleFn& loadSample,
+                      juce::String* errorMessage = nullptr) const;
+  std::shared_ptr<const ProgramState> installProgram(const juce::String& instId, ProgramState state);
+
+  // Loop analysis, off the audio thread: analyseLoops fills every looping zone of state
+  // whose points are missing or stale; adoptLoopPoints copies them into the installed
+  // program for the zones whose parameters have not changed since.
+  void analyseLoops(ProgramState& state, const LoopAnalyseFn& analyse) const;
+  void adoptLoopPoints(const juce::String& instId, const ProgramState& analysed);
+
+  // Swaps zone samples for their replacement (nullptr keeps a sample) in every installed
+  // program and recompiles the programs that changed; returns their ids so their loops can
+  // be analysed again.
+  using RemapSampleFn = std::function<std::shared_ptr<const SampleData>(const std::shared_ptr<const SampleData>& sample)>;
+  std::vector<juce::String> replaceSamples(const RemapSampleFn& remap);
+
   bool setParams(const juce::String& instId,
                  const juce::var& paramsPayload,
                  juce::String* errorMessage = nullptr);
 
   bool hasProgram(const juce::String& instId) const;
   const ProgramState* getProgram(const juce::String& instId) const;
+  const ProgramTable& programs() const noexcept { return programs_; }
 
   bool buildVoiceOn(const juce::String& instId,
                     int mixCh,
@@ -145,6 +194,16 @@ public:
                     VoiceSpec& outVoice,
                     juce::String* errorMessage = nullptr) const;
 
+  // Key-map lookup in state and a copy of the zone's prepared voice. No allocation, so the
+  // audio thread may call it (with errorMessage null) on a program taken from a ProgramTable.
+  static bool buildVoiceOn(const ProgramState& state,
+                           const juce::String& instId,
+                           int mixCh,
+                           int note,
+                           float velocity,
+                           VoiceSpec& outVoice,
+                           juce::String* errorMessage = nullptr);
+
   bool applyNoteOff(const juce::String& instId,
                     int mixCh,
                     int note,
@@ -172,18 +231,22 @@ private:
 
   Zone makeZoneFromObject(const juce::DynamicObject* o,
                           const juce::File& baseDir,
-                          const RuntimeParams& parent) const;
+                          const RuntimeParams& parent,
+                          const LoadSampleFn& loadSample) const;
 
-  const Zone* findBestZone(const ProgramState& state, int midiNote) const;
+  sls::sampler::LoopSpec makeLoopSpec(const Zone& zone) const;
+  VoiceSpec makeZoneVoice(const ProgramState& state, const Zone& zone) const;
+  void compileProgram(ProgramState& state) const;
 
   bool loadProgramFromRootObject(ProgramState& state,
                                  const juce::DynamicObject* root,
                                  const juce::File& baseDir,
+                                 const LoadSampleFn& loadSample,
                                  juce::String* errorMessage) const;
 
   LoadSampleFn loadSampleFn_;
   double sampleRate_ = 44100.0;
-  std::unordered_map<juce::String, ProgramState> programs_;
+  ProgramTable programs_;
 };
 
 } // namespace sls::inst
@@ -46,11 +46,11 @@ public:
   static void enterRelease(State& state, int end) noexcept;
   static int currentSourceIndex(const State& state) noexcept;
   static RenderResult renderFrame(const State& state,
-                                  const juce::AudioBuffer<float>& buffer) noexcept;
+                                  const sls::sampler::SampleFrames& buffer) noexcept;
   static void advance(State& state) noexcept;
 
 private:
-  static float sampleAtHermite(const juce::AudioBuffer<float>& buffer, int channel, double pos) noexcept;
+  static float sampleAtHermite(const sls::sampler::SampleFrames& buffer, int channel, double pos) noexcept;
   static double wrapLoopPosition(double pos, int loopStart, int loopEnd) noexcept;
   static float hannFadeIn(double t) noexcept;
   static float hannFadeOut(double t) noexcept;
@@ -58,11 +58,6 @@ private:
 
 class GranularHoldEngine {
 public:
-  struct StereoFrame {
-    float left = 0.0f;
-    float right = 0.0f;
-  };
-
   struct Grain {
     bool active = false;
     double sourceStart = 0.0;
@@ -87,6 +82,7 @@ public:
     int crossfadeSamples = 0;
     int jitterSamples = 0;
     float seamDiffuse = 0.35f;
+    const sls::sampler::PitchMarks* pitchMarks = nullptr; // grain start candidates, owned by the sample
     std::uint32_t rngState = 0x9e3779b9u;
     std::array<Grain, 16> grains;
   };
@@ -100,21 +96,38 @@ public:
                          int crossfadeSamples,
                          int jitterSamples,
                          float seamDiffuse,
+                         const sls::sampler::PitchMarks* pitchMarks,
                          std::uint32_t seed) noexcept;
 
   static int currentSourceIndex(const State& state) noexcept;
-  static StereoFrame renderFrame(State& state,
-                                 const juce::AudioBuffer<float>& buffer) noexcept;
+
+  // Writes numFrames frames of the overlapped grains (normalised by their summed windows),
+  // spawning a grain every hopSamples. Allocation-free.
+  static void renderBlock(State& state,
+                          const sls::sampler::SampleFrames& buffer,
+                          float* left,
+                          float* right,
+                          int numFrames) noexcept;
 
 private:
-  static float sampleAtHermite(const juce::AudioBuffer<float>& buffer, int channel, double pos) noexcept;
+  static constexpr int kMixFrames = 64;
+  static constexpr int kMaxMarkCandidates = 16;
+
+  static float sampleAtHermite(const sls::sampler::SampleFrames& buffer, int channel, double pos) noexcept;
   static double wrapLoopPosition(double pos, int loopStart, int loopEnd) noexcept;
-  static float hannWindow(int age, int duration) noexcept;
+  static void hannWindow(float* dest, int firstAge, int duration, int numFrames) noexcept;
+  static void mixGrains(State& state,
+                        const sls::sampler::SampleFrames& buffer,
+                        float* left,
+                        float* right,
+                        int numFrames) noexcept;
   static float nextRandomSigned(State& state) noexcept;
+  // Lowest-cost pitch mark near the predicted start (at most kMaxMarkCandidates looked at),
+  // or a strided entry-cost search of the buffer when the sample has no marks.
   static int chooseGrainStart(const State& state,
-                              const juce::AudioBuffer<float>& buffer,
+                              const sls::sampler::SampleFrames& buffer,
                               int predictedStart) noexcept;
-  static void spawnGrain(State& state, const juce::AudioBuffer<float>& buffer) noexcept;
+  static void spawnGrain(State& state, const sls::sampler::SampleFrames& buffer) noexcept;
 };
 
 class SampleTouskiRuntime {
@@ -129,11 +142,11 @@ public:
     bool active = false;
     bool releasing = false;
 
-    juce::String instId;
+    juce::int64 instKey = 0;
     int note = 60;
     int mixCh = 1;
 
-    std::shared_ptr<SampleData> sample;
+    std::shared_ptr<const SampleData> sample;
 
     int start = 0;
     int loopStart = 0;
@@ -171,13 +184,18 @@ public:
   void setSampleRate(double sr) noexcept;
   double getSampleRate() const noexcept;
 
+  // Voice slots (grain state included) are allocated here, never at note-on.
   void setMaxVoices(int maxVoices);
   int getMaxVoices() const noexcept;
 
+  // Fills a free slot; fails when all are playing. Loop points are taken from the spec
+  // (analysed when the program loaded), so this is safe on the audio thread.
   bool spawnVoice(const VoiceSpec& spec, juce::String* errorMessage = nullptr);
-  bool noteOff(const juce::String& instId, int mixCh, int note, bool holdLoopThenRelease);
+  bool noteOff(juce::int64 instKey, int mixCh, int note, bool holdLoopThenRelease);
 
-  void renderNextSample(std::vector<float>& busL, std::vector<float>& busR) noexcept;
+  // Adds numFrames frames of voice voiceIndex (see getVoices) into left/right. The caller
+  // groups voices by mixCh, so voices on different buses may be rendered concurrently.
+  void renderVoice(int voiceIndex, float* left, float* right, int numFrames) noexcept;
 
   void clear();
   void stopAll() noexcept;
@@ -186,11 +204,6 @@ public:
   int getNumActiveVoices() const noexcept;
 
 private:
-  static int snapToNearestZeroCrossing(const juce::AudioBuffer<float>& buffer,
-                                       int target,
-                                       int searchRadius,
-                                       int minBound,
-                                       int maxBound) noexcept;
   static bool validateVoiceBoundaries(Voice& voice) noexcept;
 
   bool initialiseVoiceFromSpec(Voice& outVoice,
@@ -198,6 +211,13 @@ private:
                                juce::String* errorMessage) const;
   static void beginRelease(Voice& voice) noexcept;
 
+  static constexpr int kRenderChunk = 64;
+
+  static void renderVoice(Voice& voice, float* left, float* right, int numFrames) noexcept;
+  static int renderAttack(Voice& voice, const sls::sampler::SampleFrames& buffer, float* left, float* right, int numFrames) noexcept;
+  static int renderSustain(Voice& voice, const sls::sampler::SampleFrames& buffer, float* left, float* right, int numFrames) noexcept;
+  static int renderRelease(Voice& voice, const sls::sampler::SampleFrames& buffer, float* left, float* right, float* amp, int numFrames) noexcept;
+
   std::vector<Voice> voices_;
   double sampleRate_ = 44100.0;
   int maxVoices_ = 128;
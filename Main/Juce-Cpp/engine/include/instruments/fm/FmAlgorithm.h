@@ -2,11 +2,16 @@
 
 #include <array>
 #include <cstddef>
+#include <type_traits>
+#include <utility>
 
 namespace sls::engine::fm {
 
 constexpr std::size_t kMaxFmOperators = 6;
+constexpr std::size_t kFmAlgorithmCount = 8;
 
+// Operators are rendered from the last to the first: every modulator of a node has a
+// higher index than the node, and the modulator list is packed (-1 after the last one).
 struct FmAlgorithmNode {
     std::array<int, 4> modulators { -1, -1, -1, -1 };
     bool isCarrier = false;
@@ -17,6 +22,90 @@ struct FmAlgorithm {
     int carrierCount = 0;
 };
 
+// The topologies as constants, so the voice and block renderers can compile one kernel
+// per algorithm (FmVoice::renderFrame, FmBlockRenderer).
+inline constexpr std::array<FmAlgorithm, kFmAlgorithmCount> kFmAlgorithmTable {{
+    // 1: one six-operator stack
+    { {{ { { 1, -1, -1, -1 }, true }, { { 2, -1, -1, -1 }, false }, { { 3, -1, -1, -1 }, false },
+         { { 4, -1, -1, -1 }, false }, { { 5, -1, -1, -1 }, false }, { { -1, -1, -1, -1 }, false } }}, 1 },
+    // 2: three two-operator stacks
+    { {{ { { 1, -1, -1, -1 }, true }, {}, { { 3, -1, -1, -1 }, true },
+         {}, { { 5, -1, -1, -1 }, true }, {} }}, 3 },
+    // 3: dual carrier (operator 6 unused)
+    { {{ { { 1, 2, -1, -1 }, true }, {}, {},
+         { { 4, -1, -1, -1 }, true }, {}, {} }}, 2 },
+    // 4: parallel
+    { {{ { { 1, -1, -1, -1 }, true }, {}, { { 3, 4, -1, -1 }, true },
+         {}, {}, { { -1, -1, -1, -1 }, true } }}, 3 },
+    // 5: wide
+    { {{ { { 1, 2, -1, -1 }, true }, {}, {},
+         { { 4, 5, -1, -1 }, true }, {}, {} }}, 2 },
+    // 6: noisy split
+    { {{ { { 1, -1, -1, -1 }, true }, {}, { { 3, -1, -1, -1 }, true },
+         {}, { { 5, -1, -1, -1 }, true }, {} }}, 3 },
+    // 7: cross modulation
+    { {{ { { 1, 2, -1, -1 }, true }, { { 3, -1, -1, -1 }, false }, { { 4, -1, -1, -1 }, false },
+         {}, {}, { { -1, -1, -1, -1 }, true } }}, 2 },
+    // 8: all carriers
+    { {{ { { -1, -1, -1, -1 }, true }, { { -1, -1, -1, -1 }, true }, { { -1, -1, -1, -1 }, true },
+         { { -1, -1, -1, -1 }, true }, { { -1, -1, -1, -1 }, true }, { { -1, -1, -1, -1 }, true } }}, 6 },
+}};
+
+// Operators the output stage reads besides the carriers: operator index 2 sets the stereo side
+// signal whenever a patch has stereo width (FmVoice::renderFrame).
+constexpr unsigned kFmSideTaps = 1u << 2;
+
+// Patch algorithm index to table slot (out of range plays algorithm 1, as byIndex).
+constexpr int fmAlgorithmSlot(int index) noexcept {
+    return index >= 0 && index < static_cast<int>(kFmAlgorithmCount) ? index : 0;
+}
+
+// Bit k set when operator k can be heard: a carrier, one of the taps (operators read
+// directly by the output stage), or a modulator of an audible operator. Operators in
+// silent are never audible and cut off everything that only feeds them.
+constexpr unsigned fmAudibleOperators(const FmAlgorithm& algorithm, unsigned silent = 0u, unsigned taps = 0u) noexcept {
+    unsigned audible = 0u;
+    for (std::size_t i = 0; i < kMaxFmOperators; ++i) {
+        if (algorithm.nodes[i].isCarrier || ((taps >> i) & 1u)) audible |= 1u << i;
+    }
+    audible &= ~silent;
+    for (std::size_t i = 0; i < kMaxFmOperators; ++i) {
+        if (!((audible >> i) & 1u)) continue;
+        for (int mod : algorithm.nodes[i].modulators) {
+            if (mod >= 0 && !((silent >> mod) & 1u)) audible |= 1u << mod;
+        }
+    }
+    return audible;
+}
+
+// Calls f(std::integral_constant<int, k>) for the operators in render order (last to first)
+// or in index order, so kernels can test the topology with if constexpr.
+template <typename F, std::size_t... K>
+inline void forEachFmOperator(F&& f, std::index_sequence<K...>) {
+    (f(std::integral_constant<int, static_cast<int>(K)> {}), ...);
+}
+
+template <typename F>
+inline void forEachFmOperatorInRenderOrder(F&& f) {
+    forEachFmOperator(std::forward<F>(f), std::index_sequence<5, 4, 3, 2, 1, 0> {});
+}
+
+template <typename F>
+inline void forEachFmOperatorInOrder(F&& f) {
+    forEachFmOperator(std::forward<F>(f), std::make_index_sequence<kMaxFmOperators> {});
+}
+
+// Sum of the modulators of operator K in algorithm slot A, in list order; zero when it has none.
+template <int A, int K, typename V>
+inline V fmModulation(const V* outputs, V zero) noexcept {
+    constexpr auto m = kFmAlgorithmTable[A].nodes[K].modulators;
+    if constexpr (m[0] < 0) return zero;
+    else if constexpr (m[1] < 0) return outputs[m[0]];
+    else if constexpr (m[2] < 0) return outputs[m[0]] + outputs[m[1]];
+    else if constexpr (m[3] < 0) return outputs[m[0]] + outputs[m[1]] + outputs[m[2]];
+    else return outputs[m[0]] + outputs[m[1]] + outputs[m[2]] + outputs[m[3]];
+}
+
 class FmAlgorithms {
 public:
     static const FmAlgorithm& byIndex(int index);
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include "FmAlgorithm.h"
+#include "FmEnvelope.h"
+
+namespace sls::engine::fm {
+
+class FmVoice;
+struct FmPatchSnapshot;
+
+// Renders the active voices of an FmEngine together, structure-of-arrays:
+// operator phase, increment, gain and feedback memory are gathered from the
+// voices into one array per operator at the start of a block, four voices
+// share each vector lane group, and the state is written back at the end.
+// Envelopes are rendered ahead a chunk at a time by an EnvelopeBank. Same samples as FmVoice::renderFrame per voice (see
+// FmSine.h); only the order voices are summed in differs.
+//
+// render() runs the kernel compiled for the snapshot's algorithm and skips the
+// operators it can: ones the topology never hears are not compiled in, ones the
+// patch silences (output level 0), and whatever only feeds them, are skipped,
+// and so is an operator whose envelope has ended in every voice.
+//
+// Audio thread: prepare() sizes the arrays, render() never allocates.
+class FmBlockRenderer {
+public:
+    void prepare(int maxVoices);
+
+    // Adds numSamples frames of voices[0, count) into left/right. Every voice
+    // plays patch (FmEngine groups them); count is at most the prepared maxVoices.
+    void render(FmVoice* const* voices, int count, const FmPatchSnapshot& patch,
+                float* left, float* right, int numSamples);
+
+private:
+    template <int Algorithm>
+    void renderWith(FmVoice* const* voices, int count, const FmPatchSnapshot& patch,
+                    float* left, float* right, int numSamples);
+
+    void gather(FmVoice* const* voices, int count);
+    void scatter(FmVoice* const* voices, int count) const;
+    void renderEnvelopes(FmVoice* const* voices, int count, unsigned liveOperators, int numFrames);
+
+    static constexpr int kEnvelopeChunk = 32; // frames of envelope rendered ahead
+
+    int capacity_ = 0; // lanes per array, a multiple of four
+    int lanes_ = 0;    // lanes in use this block, rounded up to four
+
+    // [operator * capacity_ + lane]
+    std::vector<float> phase_;
+    std::vector<float> increment_;
+    std::vector<float> gain_;
+    std::vector<float> previous_;
+    std::vector<float> runningFrames_; // frames of the chunk the envelope runs on after (EnvelopeBank)
+
+    // [lane]
+    std::vector<float> lfoPhase_;
+    std::vector<float> voiceFrames_; // the longest runningFrames_ of the voice's live operators
+
+    EnvelopeBank envelopes_;                   // rows [operator * capacity_ + lane]
+    std::vector<FmEnvelope*> envelopeSources_; // [lane], one operator at a time
+    float operatorFrames_[kMaxFmOperators] {}; // the longest runningFrames_ of each operator
+};
+
+} // namespace sls::engine::fm
@@ -3,29 +3,48 @@
 #include <memory>
 #include <utility>
 #include <vector>
+#include "FmBlockRenderer.h"
 #include "FmVoice.h"
 
 namespace sls::engine::fm {
 
+// Voices live in one contiguous pool. The ones sounding are listed in start order
+// (a ring of pool indices, oldest first) and only those are rendered; a voice leaves
+// the list when its envelopes end, so an idle engine renders nothing.
 class FmEngine {
 public:
-    void prepare(double sampleRate, int maxVoices);
+    // Sizes the voice pool and plays patch, compiled by an FmPatchLibrary for the output
+    // sample rate. Allocates; call off the audio thread.
+    void prepare(int maxVoices, std::shared_ptr<const FmPatchSnapshot> patch);
     void reset();
-    void setPatch(const FmPatch& patch);
+    // Plays patch from the next note-on; sounding notes keep theirs. patch must be compiled
+    // for the same sample rate as the one given to prepare(). Never allocates.
+    void setPatch(std::shared_ptr<const FmPatchSnapshot> patch);
+    const std::shared_ptr<const FmPatchSnapshot>& patch() const noexcept { return patch_; }
 
+    // Takes an idle voice, or steals the oldest sounding one when all are in use.
     void noteOn(int midiNote, float velocity);
     void noteOff(int midiNote);
 
+    int activeVoiceCount() const noexcept { return activeCount_; }
+
     std::pair<float, float> renderFrame();
+    // Adds numSamples frames of every active voice into left/right, all voices playing
+    // the same snapshot at once (FmBlockRenderer).
+    void renderBlock(float* left, float* right, int numSamples);
 
 private:
-    FmVoice* findVoice(int midiNote);
-    FmVoice* findFreeVoice();
-
-    double sampleRate_ = 48000.0;
-    int nextStealIndex_ = 0;
-    FmPatch patch_;
-    std::vector<std::unique_ptr<FmVoice>> voices_;
+    FmVoice& activeVoice(int position) noexcept;
+    void retireEndedVoices();
+
+    std::shared_ptr<const FmPatchSnapshot> patch_;
+    std::vector<FmVoice> voices_;
+    std::vector<int> active_;            // ring of voices_ indices, oldest at activeHead_
+    int activeHead_ = 0;
+    int activeCount_ = 0;
+    std::vector<int> idle_;              // voices_ indices not in active_
+    std::vector<FmVoice*> blockVoices_;  // renderBlock scratch, reserved for every voice
+    FmBlockRenderer blockRenderer_;
 };
 
 } // namespace sls::engine::fm
@@ -5,6 +5,9 @@
 
 namespace sls::engine::fm {
 
+class FmBlockRenderer;
+struct FmOperatorProgram;
+
 struct FmOperatorParams {
     double ratio = 1.0;
     double detuneHz = 0.0;
@@ -15,33 +18,29 @@ struct FmOperatorParams {
     double fixedFrequencyHz = 440.0;
 };
 
+// One operator of a playing voice. start() takes everything it needs from the compiled
+// patch (FmPatchSnapshot) once per note: increment, gain, feedback and envelope rates.
 class FmOperator {
 public:
-    void prepare(double sampleRate);
     void reset();
 
-    FmOperatorParams& params() noexcept { return params_; }
-    const FmOperatorParams& params() const noexcept { return params_; }
-
     FmEnvelope& envelope() noexcept { return envelope_; }
     const FmEnvelope& envelope() const noexcept { return envelope_; }
 
-    void start(double noteFrequency, float velocity);
+    void start(const FmOperatorProgram& program, double noteFrequency, float velocity);
     void stop();
 
     float render(float modulationRadians);
     bool isActive() const noexcept { return envelope_.isActive(); }
 
 private:
-    double currentFrequency(double noteFrequency) const noexcept;
+    friend class FmBlockRenderer;
 
-    double sampleRate_ = 48000.0;
-    double phase_ = 0.0;
-    float velocity_ = 1.0f;
+    float phase_ = 0.0f;     // turns, [-1/2, 1/2]
+    float increment_ = 0.0f; // turns per sample
+    float gain_ = 0.0f;      // output level scaled by velocity
+    float feedback_ = 0.0f;
     float previousSample_ = 0.0f;
-    double noteFrequency_ = 440.0;
-
-    FmOperatorParams params_;
     FmEnvelope envelope_;
 };
 
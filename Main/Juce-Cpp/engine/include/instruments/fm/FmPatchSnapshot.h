@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "FmEnvelope.h"
+#include "FmPatch.h"
+
+namespace sls::engine::fm {
+
+// One operator of a compiled patch: what FmOperator::start needs, worked out once.
+struct FmOperatorProgram {
+    FmOperatorParams params;
+    FmEnvelopeRates envelope;
+    double sampleRate = 48000.0;
+
+    float phaseIncrement(double noteFrequency) const noexcept; // turns per sample
+    float gain(float velocity) const noexcept;                 // output level scaled by velocity
+};
+
+// An FmPatch compiled for one sample rate. Immutable once built: voices keep a
+// pointer to the snapshot their note started with, so note-on copies a reference
+// instead of the patch, and a new snapshot only reaches the notes played after it.
+struct FmPatchSnapshot {
+    FmPatch patch;
+    double sampleRate = 48000.0;
+
+    int algorithmSlot = 0;
+    unsigned liveOperators = 0x3fu;   // operators that can be heard (fmAudibleOperators)
+    unsigned taps = 0u;               // kFmSideTaps when the patch has stereo width
+    unsigned feedbackOperators = 0u;  // operators with non-zero feedback
+    float lfoIncrement = 0.0f;        // turns per sample, 0 when the LFO is off
+    float lfoDepth = 0.0f;
+    float masterGain = 0.25f;
+    float width = 0.0f;               // stereo width clamped to [0, 1]
+    std::array<FmOperatorProgram, kMaxFmOperators> operators {};
+
+    // Allocates; call off the audio thread.
+    static std::shared_ptr<const FmPatchSnapshot> compile(const FmPatch& patch, double sampleRate);
+};
+
+// Keeps every snapshot it compiled alive until collect() finds it unused, so the
+// last reference is never dropped (and the snapshot never freed) on the audio thread.
+class FmPatchLibrary {
+public:
+    std::shared_ptr<const FmPatchSnapshot> compile(const FmPatch& patch, double sampleRate);
+    // Frees the snapshots nothing else refers to any more.
+    void collect();
+
+private:
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<const FmPatchSnapshot>> snapshots_;
+};
+
+} // namespace sls::engine::fm
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define SLS_FM_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define SLS_FM_NEON 1
+#endif
+
+namespace sls::engine::fm {
+
+// Oscillator sine shared by FmOperator::render and FmBlockRenderer.
+//
+// Phases are in turns (1.0 = one cycle). The argument is folded to [-1/4, 1/4]
+// turn and fed to an odd degree-11 polynomial (error below 1e-6 over the whole
+// circle). The scalar and the four-lane versions below run the same float
+// operations in the same order, so both render paths produce the same samples.
+
+constexpr float kFmTwoPi = 6.28318530717958647692f;
+constexpr float kFmInvTwoPi = 1.0f / kFmTwoPi;
+
+// Four lanes of float; only what the sine, the block renderer and the envelopes need.
+struct FmVec4 {
+#if SLS_FM_SSE2
+    __m128 v;
+    static FmVec4 load(const float* p) noexcept { return { _mm_loadu_ps(p) }; }
+    static FmVec4 fill(float x) noexcept { return { _mm_set1_ps(x) }; }
+    static FmVec4 gather(const float* p, int stride) noexcept { return { _mm_setr_ps(p[0], p[stride], p[2 * stride], p[3 * stride]) }; }
+    void store(float* p) const noexcept { _mm_storeu_ps(p, v); }
+    friend FmVec4 operator+(FmVec4 a, FmVec4 b) noexcept { return { _mm_add_ps(a.v, b.v) }; }
+    friend FmVec4 operator-(FmVec4 a, FmVec4 b) noexcept { return { _mm_sub_ps(a.v, b.v) }; }
+    friend FmVec4 operator*(FmVec4 a, FmVec4 b) noexcept { return { _mm_mul_ps(a.v, b.v) }; }
+    // Round to nearest, ties to even (the default MXCSR mode, as std::nearbyint). |x| < 2^31.
+    friend FmVec4 roundNearest(FmVec4 a) noexcept { return { _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v)) }; }
+    friend FmVec4 abs(FmVec4 a) noexcept { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+    friend FmVec4 min(FmVec4 a, FmVec4 b) noexcept { return { _mm_min_ps(a.v, b.v) }; }
+    // x where a < b, else 0.
+    friend FmVec4 selectBelow(FmVec4 a, FmVec4 b, FmVec4 x) noexcept { return { _mm_and_ps(_mm_cmplt_ps(a.v, b.v), x.v) }; }
+    friend FmVec4 copySign(FmVec4 magnitude, FmVec4 sign) noexcept {
+        const __m128 bit = _mm_set1_ps(-0.0f);
+        return { _mm_or_ps(_mm_andnot_ps(bit, magnitude.v), _mm_and_ps(bit, sign.v)) };
+    }
+#elif SLS_FM_NEON
+    float32x4_t v;
+    static FmVec4 load(const float* p) noexcept { return { vld1q_f32(p) }; }
+    static FmVec4 fill(float x) noexcept { return { vdupq_n_f32(x) }; }
+    static FmVec4 gather(const float* p, int stride) noexcept {
+        const float lanes[4] = { p[0], p[stride], p[2 * stride], p[3 * stride] };
+        return load(lanes);
+    }
+    void store(float* p) const noexcept { vst1q_f32(p, v); }
+    friend FmVec4 operator+(FmVec4 a, FmVec4 b) noexcept { return { vaddq_f32(a.v, b.v) }; }
+    friend FmVec4 operator-(FmVec4 a, FmVec4 b) noexcept { return { vsubq_f32(a.v, b.v) }; }
+    friend FmVec4 operator*(FmVec4 a, FmVec4 b) noexcept { return { vmulq_f32(a.v, b.v) }; }
+    friend FmVec4 abs(FmVec4 a) noexcept { return { vabsq_f32(a.v) }; }
+    friend FmVec4 min(FmVec4 a, FmVec4 b) noexcept { return { vminq_f32(a.v, b.v) }; }
+    friend FmVec4 selectBelow(FmVec4 a, FmVec4 b, FmVec4 x) noexcept {
+        return { vreinterpretq_f32_u32(vandq_u32(vcltq_f32(a.v, b.v), vreinterpretq_u32_f32(x.v))) };
+    }
+    friend FmVec4 copySign(FmVec4 magnitude, FmVec4 sign) noexcept {
+        return { vbslq_f32(vdupq_n_u32(0x80000000u), sign.v, magnitude.v) };
+    }
+  #if defined(__aarch64__)
+    friend FmVec4 roundNearest(FmVec4 a) noexcept { return { vrndnq_f32(a.v) }; }
+  #else
+    // ARMv7 has no round-to-nearest: ties go away from zero here, which only moves a fold
+    // point by one ulp.
+    friend FmVec4 roundNearest(FmVec4 a) noexcept {
+        const FmVec4 half = copySign(fill(0.5f), a);
+        return { vcvtq_f32_s32(vcvtq_s32_f32(vaddq_f32(a.v, half.v))) };
+    }
+  #endif
+#else
+    float v[4];
+    static FmVec4 load(const float* p) noexcept { return { { p[0], p[1], p[2], p[3] } }; }
+    static FmVec4 fill(float x) noexcept { return { { x, x, x, x } }; }
+    static FmVec4 gather(const float* p, int stride) noexcept { return { { p[0], p[stride], p[2 * stride], p[3 * stride] } }; }
+    void store(float* p) const noexcept { for (int k = 0; k < 4; ++k) p[k] = v[k]; }
+    friend FmVec4 operator+(FmVec4 a, FmVec4 b) noexcept { for (int k = 0; k < 4; ++k) a.v[k] += b.v[k]; return a; }
+    friend FmVec4 operator-(FmVec4 a, FmVec4 b) noexcept { for (int k = 0; k < 4; ++k) a.v[k] -= b.v[k]; return a; }
+    friend FmVec4 operator*(FmVec4 a, FmVec4 b) noexcept { for (int k = 0; k < 4; ++k) a.v[k] *= b.v[k]; return a; }
+    friend FmVec4 roundNearest(FmVec4 a) noexcept { for (auto& x : a.v) x = std::nearbyint(x); return a; }
+    friend FmVec4 abs(FmVec4 a) noexcept { for (auto& x : a.v) x = std::fabs(x); return a; }
+    friend FmVec4 min(FmVec4 a, FmVec4 b) noexcept { for (int k = 0; k < 4; ++k) a.v[k] = std::min(a.v[k], b.v[k]); return a; }
+    friend FmVec4 selectBelow(FmVec4 a, FmVec4 b, FmVec4 x) noexcept { for (int k = 0; k < 4; ++k) x.v[k] = a.v[k] < b.v[k] ? x.v[k] : 0.0f; return x; }
+    friend FmVec4 copySign(FmVec4 a, FmVec4 b) noexcept { for (int k = 0; k < 4; ++k) a.v[k] = std::copysign(a.v[k], b.v[k]); return a; }
+#endif
+};
+
+namespace detail {
+inline float splat(float x, float) noexcept { return x; }
+inline FmVec4 splat(float x, FmVec4) noexcept { return FmVec4::fill(x); }
+#if SLS_FM_SSE2
+inline float roundNearest(float x) noexcept { return static_cast<float>(_mm_cvtss_si32(_mm_set_ss(x))); }
+#else
+inline float roundNearest(float x) noexcept { return std::nearbyint(x); }
+#endif
+inline float abs(float x) noexcept { return std::fabs(x); }
+inline float min(float a, float b) noexcept { return a < b ? a : b; }
+inline float copySign(float magnitude, float sign) noexcept { return std::copysign(magnitude, sign); }
+
+template <typename V>
+inline V sinTurns(V turns) noexcept {
+    const V y = turns - roundNearest(turns);                          // [-1/2, 1/2]
+    const V a = abs(y);
+    const V folded = copySign(min(a, splat(0.5f, y) - a), y);         // sin(pi - x) = sin(x)
+    const V x = folded * splat(kFmTwoPi, y);                          // [-pi/2, pi/2]
+    const V x2 = x * x;
+    V p = splat(-2.5052108385e-8f, y);
+    p = p * x2 + splat(2.7557319224e-6f, y);
+    p = p * x2 + splat(-1.9841269841e-4f, y);
+    p = p * x2 + splat(8.3333333333e-3f, y);
+    p = p * x2 + splat(-1.6666666667e-1f, y);
+    p = p * x2 + splat(1.0f, y);
+    return x * p;
+}
+} // namespace detail
+
+// sin(2 pi turns), for any finite turns with |turns| < 2^31.
+inline float fmSinTurns(float turns) noexcept { return detail::sinTurns(turns); }
+inline FmVec4 fmSinTurns(FmVec4 turns) noexcept { return detail::sinTurns(turns); }
+
+// Wraps a phase in turns to [-1/2, 1/2].
+inline float fmWrapTurns(float turns) noexcept { return turns - detail::roundNearest(turns); }
+inline FmVec4 fmWrapTurns(FmVec4 turns) noexcept { return turns - roundNearest(turns); }
+
+} // namespace sls::engine::fm
@@ -1,32 +1,38 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <utility>
-#include "FmPatch.h"
+#include "FmPatchSnapshot.h"
 
 namespace sls::engine::fm {
 
-class FmVoice {
+// Cache-line aligned: FmEngine keeps its voices side by side in one pool.
+class alignas(64) FmVoice {
 public:
-    void prepare(double sampleRate);
     void reset();
-    void setPatch(const FmPatch& patch);
 
-    void noteOn(int midiNote, float velocity);
+    // Plays the note with the given snapshot; keeps a reference to it, not a copy.
+    void noteOn(const std::shared_ptr<const FmPatchSnapshot>& patch, int midiNote, float velocity);
     void noteOff();
 
+    // Runs the kernel compiled for the algorithm of the snapshot the note started with.
     std::pair<float, float> renderFrame();
     bool isActive() const noexcept;
     int currentMidiNote() const noexcept { return midiNote_; }
+    const FmPatchSnapshot* patch() const noexcept { return patch_.get(); }
 
 private:
+    friend class FmBlockRenderer;
+
     double midiNoteToFrequency(int midiNote) const noexcept;
+    template <int Algorithm>
+    std::pair<float, float> renderFrameWith();
 
-    double sampleRate_ = 48000.0;
     int midiNote_ = -1;
     float velocity_ = 0.0f;
-    float lfoPhase_ = 0.0f;
-    FmPatch patch_;
+    float lfoPhase_ = 0.0f; // turns
+    std::shared_ptr<const FmPatchSnapshot> patch_;
     std::array<FmOperator, kMaxFmOperators> operators_ {};
 };
 
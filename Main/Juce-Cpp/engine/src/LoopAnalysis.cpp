@@ -0,0 +1,225 @@
+#include "LoopAnalysis.h"
+#include "SampleVoice.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <vector>
+#include <juce_dsp/juce_dsp.h>
+
+namespace sls::sampler {
+
+namespace {
+constexpr int kMinSeamWindow = 16;
+constexpr int kMaxSeamRadius = 8192; // ~170 ms at 48 kHz
+
+int snapToZeroCrossing(const juce::AudioBuffer<float>& b, int target, int radius, int minBound, int maxBound) {
+  const int n = b.getNumSamples();
+  if (n <= 2) return target;
+
+  minBound = juce::jlimit(0, n - 2, minBound);
+  maxBound = juce::jlimit(minBound + 1, n - 1, maxBound);
+  target = juce::jlimit(minBound, maxBound, target);
+  if (radius <= 0) return target;
+
+  const int lo = juce::jlimit(minBound, maxBound, target - radius);
+  const int hi = juce::jlimit(minBound, maxBound, target + radius);
+  const auto* rd = b.getReadPointer(0);
+
+  int best = target;
+  float bestScore = std::numeric_limits<float>::max();
+  for (int i = lo; i < hi; ++i) {
+    const float x0 = rd[i];
+    const float x1 = rd[i + 1];
+    const bool crosses = (x0 <= 0.0f && x1 >= 0.0f) || (x0 >= 0.0f && x1 <= 0.0f);
+    if (!crosses) continue;
+
+    const float score = std::abs(x0) + std::abs(x1) + 0.0001f * (float)std::abs(i - target);
+    if (score < bestScore) {
+      bestScore = score;
+      best = i;
+    }
+  }
+  return best;
+}
+
+// out[k] = sum_i ref[i] * seg[k + i] for k < numLags; seg holds numLags + refLen - 1 values.
+void crossCorrelate(const float* ref, int refLen, const float* seg, int numLags, std::vector<float>& out) {
+  const int needed = numLags + refLen - 1;
+  int order = 1;
+  while ((1 << order) < needed) ++order;
+  const int size = 1 << order;
+
+  juce::dsp::FFT fft(order);
+  std::vector<float> a((size_t)size * 2, 0.0f);
+  std::vector<float> r((size_t)size * 2, 0.0f);
+  std::copy(seg, seg + needed, a.begin());
+  std::copy(ref, ref + refLen, r.begin());
+  fft.performRealOnlyForwardTransform(a.data(), true);
+  fft.performRealOnlyForwardTransform(r.data(), true);
+
+  // seg spectrum times the conjugate ref spectrum: correlation instead of convolution.
+  for (int bin = 0; bin <= size / 2; ++bin) {
+    const float ar = a[(size_t)bin * 2], ai = a[(size_t)bin * 2 + 1];
+    const float rr = r[(size_t)bin * 2], ri = r[(size_t)bin * 2 + 1];
+    a[(size_t)bin * 2] = ar * rr + ai * ri;
+    a[(size_t)bin * 2 + 1] = ai * rr - ar * ri;
+  }
+  fft.performRealOnlyInverseTransform(a.data());
+  out.assign(a.begin(), a.begin() + numLags);
+}
+
+// Seam error of every loop with one point fixed and the other at lo..hi (all valid:
+// the loop stays longer than window + 2). Mean squared window difference plus
+// the jump and slope mismatch across the splice, summed over the first two channels.
+std::vector<double> seamErrors(const juce::AudioBuffer<float>& b, int fixedPoint, bool fixedIsEnd,
+                               int lo, int hi, int window) {
+  const int channels = std::max(1, std::min(2, b.getNumChannels()));
+  const int numLags = hi - lo + 1;
+  std::vector<double> err((size_t)numLags, 0.0);
+  std::vector<float> corr;
+
+  for (int ch = 0; ch < channels; ++ch) {
+    const auto* rd = b.getReadPointer(ch);
+    // Fixed window: the tail before a fixed end, or the head after a fixed start.
+    const float* ref = fixedIsEnd ? rd + fixedPoint - window : rd + fixedPoint;
+    // Moving windows: heads after each candidate start, or tails before each candidate end.
+    const float* seg = fixedIsEnd ? rd + lo : rd + lo - window;
+
+    crossCorrelate(ref, window, seg, numLags, corr);
+
+    double refEnergy = 0.0, segEnergy = 0.0;
+    for (int i = 0; i < window; ++i) {
+      refEnergy += (double)ref[i] * ref[i];
+      segEnergy += (double)seg[i] * seg[i];
+    }
+
+    for (int k = 0; k < numLags; ++k) {
+      if (k > 0) segEnergy += (double)seg[k + window - 1] * seg[k + window - 1] - (double)seg[k - 1] * seg[k - 1];
+      const double diff = std::max(0.0, refEnergy + segEnergy - 2.0 * (double)corr[(size_t)k]);
+
+      const int loopStart = fixedIsEnd ? lo + k : fixedPoint;
+      const int loopEnd = fixedIsEnd ? fixedPoint : lo + k;
+      const double amp = (double)rd[loopEnd - 1] - (double)rd[loopStart];
+      const double slope = ((double)rd[loopEnd - 1] - (double)rd[loopEnd - 2])
+                         - ((double)rd[loopStart + 1] - (double)rd[loopStart]);
+      err[(size_t)k] += diff + amp * amp * 4.0 + slope * slope * 2.0;
+    }
+  }
+
+  const double count = (double)(channels * window);
+  for (auto& e : err) e /= count;
+  return err;
+}
+
+// Slides one loop point within radius of target (clamped to the bounds) to the best seam
+// against the fixed one. Ties keep the lower offset, the target itself wins over both.
+int refineSeam(const juce::AudioBuffer<float>& b, int target, int fixedPoint, bool fixedIsEnd,
+               int radius, int window, int minBound, int maxBound) {
+  const int best = juce::jlimit(minBound, maxBound, target);
+  int lo = juce::jlimit(minBound, maxBound, target - radius);
+  int hi = juce::jlimit(minBound, maxBound, target + radius);
+  if (fixedIsEnd) hi = std::min(hi, fixedPoint - window - 3);
+  else lo = std::max(lo, fixedPoint + window + 3);
+  if (lo > hi) return best;
+
+  const auto scores = seamErrors(b, fixedPoint, fixedIsEnd, lo, hi, window);
+  int bestIndex = best;
+  double bestScore = (best >= lo && best <= hi) ? scores[(size_t)(best - lo)] : std::numeric_limits<double>::max();
+  for (int k = 0; k <= hi - lo; ++k) {
+    if (scores[(size_t)k] < bestScore) {
+      bestScore = scores[(size_t)k];
+      bestIndex = lo + k;
+    }
+  }
+  return bestIndex;
+}
+}
+
+LoopPoints findLoopPoints(const juce::AudioBuffer<float>& b, const LoopSpec& spec) {
+  LoopPoints out;
+  out.spec = spec;
+  out.loopStart = spec.loopStart;
+  out.loopEnd = spec.loopEnd;
+  out.valid = true;
+
+  const int total = b.getNumSamples();
+  if (total <= 2 || spec.searchRadius <= 0) return out;
+
+  const int start = spec.start;
+  int releaseEnd = spec.releaseEnd;
+  int loopStart = snapToZeroCrossing(b, spec.loopStart, spec.searchRadius, start, std::max(start + 1, releaseEnd - 2));
+  int loopEnd = snapToZeroCrossing(b, spec.loopEnd, spec.searchRadius,
+                                   std::min(loopStart + 2, releaseEnd - 1), std::max(loopStart + 2, releaseEnd - 1));
+
+  const auto clampLoop = [&] {
+    loopStart = juce::jlimit(start, total - 1, loopStart);
+    loopEnd = juce::jlimit(loopStart + 1, total, std::max(loopStart + 1, loopEnd));
+    releaseEnd = juce::jlimit(loopEnd, total, std::max(loopEnd, releaseEnd));
+  };
+  clampLoop();
+
+  const int loopLen = std::max(4, loopEnd - loopStart);
+  const int window = std::min(std::max(kMinSeamWindow, spec.crossfade), std::max(kMinSeamWindow, loopLen - 4));
+  const int radius = std::min(std::max(spec.searchRadius, spec.crossfade / 2), kMaxSeamRadius);
+
+  if (loopLen > window + 2) {
+    const int startMax = std::max(start + 1, releaseEnd - window - 3);
+    loopStart = refineSeam(b, loopStart, loopEnd, /*fixedIsEnd*/true, radius, window, start, startMax);
+
+    const int endMin = std::min(releaseEnd - 1, loopStart + window + 2);
+    loopEnd = refineSeam(b, loopEnd, loopStart, /*fixedIsEnd*/false, radius, window, endMin, releaseEnd - 1);
+    clampLoop();
+  }
+
+  out.loopStart = loopStart;
+  out.loopEnd = loopEnd;
+  return out;
+}
+
+size_t LoopPointCache::KeyHash::operator()(const Key& k) const noexcept {
+  size_t h = std::hash<const void*>{}(k.sample);
+  for (int v : { k.spec.start, k.spec.loopStart, k.spec.loopEnd, k.spec.releaseEnd, k.spec.searchRadius, k.spec.crossfade })
+    h = h * 1000003u ^ std::hash<int>{}(v);
+  return h;
+}
+
+LoopPoints LoopPointCache::get(const std::shared_ptr<const SampleData>& sample, const LoopSpec& spec) {
+  if (!sample) return {};
+  const Key key { sample.get(), spec };
+
+  {
+    std::scoped_lock lk(mMutex);
+    auto it = mEntries.find(key);
+    if (it != mEntries.end() && it->second.sample.lock() == sample) {
+      ++mHits;
+      return it->second.points;
+    }
+  }
+
+  juce::AudioBuffer<float> widened;
+  const auto points = findLoopPoints(sample->getFloatFrames(widened), spec);
+
+  std::scoped_lock lk(mMutex);
+  ++mMisses;
+  if (mEntries.size() >= kMaxEntries) {
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+      if (it->second.sample.expired()) it = mEntries.erase(it);
+      else ++it;
+    }
+    if (mEntries.size() >= kMaxEntries) mEntries.clear();
+  }
+  mEntries[key] = Entry { sample, points };
+  return points;
+}
+
+LoopPointCache::Stats LoopPointCache::getStats() const {
+  std::scoped_lock lk(mMutex);
+  Stats s;
+  s.entries = (int)mEntries.size();
+  s.hits = mHits;
+  s.misses = mMisses;
+  return s;
+}
+
+} // namespace sls::sampler
@@ -0,0 +1,186 @@
+#include "PcmDiskCache.h"
+#include "SampleVoice.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+namespace sls::sampler {
+
+namespace {
+constexpr char kMagic[8] = { 'S', 'L', 'S', 'P', 'C', 'M', '0', '1' };
+constexpr size_t kPageBytes = 4096;
+constexpr uint32_t kMaxChannels = 64;
+
+struct Header {
+  char magic[8];
+  uint32_t int16 = 0;          // 1: int16 frames, 0: float
+  uint32_t numChannels = 0;
+  uint32_t guardFrames = 0;
+  uint32_t reserved = 0;
+  int64_t numFrames = 0;
+  double sampleRate = 0.0;
+  double sourceSampleRate = 0.0;
+  int64_t sourceSize = 0;
+  int64_t sourceModifiedMs = 0;
+};
+static_assert(sizeof(Header) == 64, "cache files start with a 64-byte header");
+
+size_t frameBytes(bool int16) { return int16 ? sizeof(int16_t) : sizeof(float); }
+}
+
+PcmDiskCache::PcmDiskCache()
+    : mDirectory(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                   .getChildFile("SaladeLoopsStudio").getChildFile("pcm-cache")) {}
+
+void PcmDiskCache::configure(const juce::File& directory, juce::int64 budgetBytes) {
+  {
+    std::scoped_lock lk(mMutex);
+    mDirectory = directory;
+    mBudgetBytes = std::max<juce::int64>(0, budgetBytes);
+  }
+  if (budgetBytes > 0) trimToBudget();
+}
+
+juce::File PcmDiskCache::getDirectory() const {
+  std::scoped_lock lk(mMutex);
+  return mDirectory;
+}
+
+juce::int64 PcmDiskCache::getBudgetBytes() const {
+  std::scoped_lock lk(mMutex);
+  return mBudgetBytes;
+}
+
+bool PcmDiskCache::isCacheable(const juce::File& source) {
+  return !source.hasFileExtension("wav;wave;bwf;aif;aiff;aifc");
+}
+
+// Under mMutex.
+juce::File PcmDiskCache::entryFile(const juce::File& source, double targetRate, bool int16) const {
+  const auto id = source.getFullPathName() + "|" + juce::String(targetRate, 3) + (int16 ? "|i16" : "|f32");
+  return mDirectory.getChildFile(juce::String::toHexString(id.hashCode64()) + ".pcm");
+}
+
+std::shared_ptr<SampleData> PcmDiskCache::load(const juce::File& source, double targetRate, bool int16) {
+  if (!isCacheable(source)) return nullptr;
+  juce::File file;
+  {
+    std::scoped_lock lk(mMutex);
+    if (mBudgetBytes <= 0) return nullptr;
+    file = entryFile(source, targetRate, int16);
+  }
+
+  const auto miss = [this] {
+    mMisses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  };
+  if (!file.existsAsFile()) return miss();
+
+  auto map = std::make_shared<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+  const auto* base = static_cast<const char*>(map->getData());
+  if (!base || map->getSize() < sizeof(Header)) return miss();
+
+  Header h;
+  std::memcpy(&h, base, sizeof(Header));
+  if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.int16 != (int16 ? 1u : 0u)
+      || h.guardFrames != (uint32_t)SampleData::kGuardFrames || h.numChannels == 0 || h.numChannels > kMaxChannels
+      || h.numFrames <= 1 || h.numFrames > std::numeric_limits<int>::max())
+    return miss();
+  // numFrames and numChannels are bounded above, so this cannot overflow; a file too short for them is a miss.
+  const uint64_t channelBytes = ((uint64_t)h.numFrames + 2 * SampleData::kGuardFrames) * frameBytes(int16);
+  if ((uint64_t)(map->getSize() - sizeof(Header)) / h.numChannels < channelBytes)
+    return miss();
+  if (h.sourceSize != source.getSize() || h.sourceModifiedMs != source.getLastModificationTime().toMilliseconds())
+    return miss(); // the source changed: decoded again and rewritten by the caller
+
+  // Fault the pages in here rather than on the audio thread.
+  volatile char touch = 0;
+  for (size_t i = 0; i < map->getSize(); i += kPageBytes) touch = (char)(touch + base[i]);
+
+  auto sd = std::make_shared<SampleData>();
+  sd->sampleRate = h.sampleRate;
+  sd->sourceSampleRate = h.sourceSampleRate;
+  sd->adoptMappedFrames(map, base + sizeof(Header), (int)h.numChannels, (int)h.numFrames, int16);
+  file.setLastAccessTime(juce::Time::getCurrentTime());
+  mHits.fetch_add(1, std::memory_order_relaxed);
+  return sd;
+}
+
+void PcmDiskCache::store(const juce::File& source, double targetRate, const SampleData& sample) {
+  if (!isCacheable(source) || sample.stream || !sample.hasGuardFrames()
+      || sample.getNumChannels() > (int)kMaxChannels) return;
+  const bool int16 = sample.isCompact();
+  juce::File file;
+  {
+    std::scoped_lock lk(mMutex);
+    if (mBudgetBytes <= 0) return;
+    file = entryFile(source, targetRate, int16);
+  }
+  if (!file.getParentDirectory().createDirectory()) return;
+
+  Header h;
+  std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.int16 = int16 ? 1u : 0u;
+  h.numChannels = (uint32_t)sample.getNumChannels();
+  h.guardFrames = (uint32_t)SampleData::kGuardFrames;
+  h.numFrames = sample.getNumLoadedFrames();
+  h.sampleRate = sample.sampleRate;
+  h.sourceSampleRate = sample.sourceSampleRate;
+  h.sourceSize = source.getSize();
+  h.sourceModifiedMs = source.getLastModificationTime().toMilliseconds();
+
+  const size_t channelBytes = ((size_t)h.numFrames + 2 * SampleData::kGuardFrames) * frameBytes(int16);
+  juce::TemporaryFile temp(file);
+  {
+    juce::FileOutputStream out(temp.getFile());
+    if (!out.openedOk() || !out.write(&h, sizeof(Header))) return;
+    for (int ch = 0; ch < (int)h.numChannels; ++ch) {
+      const void* first = int16 ? (const void*)(sample.getCompactChannel(ch) - SampleData::kGuardFrames)
+                                : (const void*)(sample.getGuardedChannel(ch) - SampleData::kGuardFrames);
+      if (!out.write(first, channelBytes)) return;
+    }
+    out.flush();
+    if (out.getStatus().failed()) return;
+  }
+  if (!temp.overwriteTargetFileWithTemporary()) return;
+
+  mWrites.fetch_add(1, std::memory_order_relaxed);
+  trimToBudget();
+}
+
+// Least recently used first. A file still mapped by a sample stays readable where the
+// platform allows deleting it, and is skipped where it does not.
+void PcmDiskCache::trimToBudget() {
+  std::scoped_lock lk(mMutex);
+  if (mBudgetBytes <= 0 || !mDirectory.isDirectory()) return;
+
+  std::vector<std::tuple<juce::int64, juce::int64, juce::File>> files; // (last use ms, size, file)
+  juce::int64 total = 0;
+  for (const auto& f : mDirectory.findChildFiles(juce::File::findFiles, false, "*.pcm")) {
+    files.emplace_back(f.getLastAccessTime().toMilliseconds(), f.getSize(), f);
+    total += std::get<1>(files.back());
+  }
+  if (total <= mBudgetBytes) return;
+
+  std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return std::get<0>(a) < std::get<0>(b); });
+  for (const auto& [lastUse, size, f] : files) {
+    if (total <= mBudgetBytes) break;
+    if (f.deleteFile()) {
+      total -= size;
+      mEvictions.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+PcmDiskCache::Stats PcmDiskCache::getStats() const {
+  Stats s;
+  s.hits = mHits.load(std::memory_order_relaxed);
+  s.misses = mMisses.load(std::memory_order_relaxed);
+  s.writes = mWrites.load(std::memory_order_relaxed);
+  s.evictions = mEvictions.load(std::memory_order_relaxed);
+  return s;
+}
+
+} // namespace sls::sampler
@@ -0,0 +1,168 @@
+#include "PitchMarks.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <juce_dsp/juce_dsp.h>
+
+namespace sls::sampler {
+
+namespace {
+constexpr int kFftOrder = 12;            // 4096 >= window + kMaxPeriod, no circular wrap
+constexpr int kWindow = 2048;
+constexpr int kHop = 1024;
+constexpr double kVoicedThreshold = 0.3; // normalised autocorrelation peak
+constexpr double kSilence = 1.0e-8;      // mean square below which a frame is unvoiced
+
+// Same measure the granular engine used per spawn: level plus slope at the entry frame.
+float entryCost(const juce::AudioBuffer<float>& b, int channels, int pos) {
+  const int n = b.getNumSamples();
+  const int prev = std::max(0, pos - 1);
+  const int next = std::min(n - 1, pos + 1);
+  float cost = 0.0f;
+  for (int ch = 0; ch < channels; ++ch) {
+    const auto* rd = b.getReadPointer(ch);
+    cost += std::abs(rd[pos]) * 0.7f + std::abs(rd[next] - rd[prev]) * 0.3f;
+  }
+  return cost;
+}
+
+// Period of every kHop frame in frames, 0 where unvoiced.
+std::vector<int> detectPeriods(const std::vector<float>& mono) {
+  const int n = (int)mono.size();
+  const int size = 1 << kFftOrder;
+  juce::dsp::FFT fft(kFftOrder);
+  std::vector<float> spectrum((size_t)size * 2);
+  std::vector<double> prefix((size_t)kWindow + 1);
+  std::vector<int> periods;
+
+  for (int frameStart = 0; frameStart < n; frameStart += kHop) {
+    const int len = std::min(kWindow, n - frameStart);
+    const float* x = mono.data() + frameStart;
+    int period = 0;
+
+    prefix[0] = 0.0;
+    for (int i = 0; i < len; ++i) prefix[(size_t)i + 1] = prefix[(size_t)i] + (double)x[i] * x[i];
+
+    const int maxLag = std::min(PitchMarks::kMaxPeriod, len / 2);
+    if (maxLag > PitchMarks::kMinPeriod && prefix[(size_t)len] / len > kSilence) {
+      std::fill(spectrum.begin(), spectrum.end(), 0.0f);
+      std::copy(x, x + len, spectrum.begin());
+      fft.performRealOnlyForwardTransform(spectrum.data(), true);
+      for (int bin = 0; bin <= size / 2; ++bin) {
+        const float re = spectrum[(size_t)bin * 2], im = spectrum[(size_t)bin * 2 + 1];
+        spectrum[(size_t)bin * 2] = re * re + im * im;
+        spectrum[(size_t)bin * 2 + 1] = 0.0f;
+      }
+      fft.performRealOnlyInverseTransform(spectrum.data());
+
+      // Normalised by the energy of both overlapping parts, so a lag scores 1 for a perfect repeat.
+      std::vector<double> nac((size_t)maxLag + 1, 0.0);
+      double best = 0.0;
+      for (int lag = PitchMarks::kMinPeriod; lag <= maxLag; ++lag) {
+        const double head = prefix[(size_t)(len - lag)];
+        const double tail = prefix[(size_t)len] - prefix[(size_t)lag];
+        const double denom = std::sqrt(head * tail);
+        nac[(size_t)lag] = denom > 0.0 ? (double)spectrum[(size_t)lag] / denom : 0.0;
+        best = std::max(best, nac[(size_t)lag]);
+      }
+
+      // First peak close to the best one: the fundamental rather than one of its multiples.
+      if (best >= kVoicedThreshold) {
+        for (int lag = PitchMarks::kMinPeriod + 1; lag < maxLag; ++lag) {
+          const double v = nac[(size_t)lag];
+          if (v >= 0.9 * best && v >= nac[(size_t)lag - 1] && v >= nac[(size_t)lag + 1]) {
+            period = lag;
+            break;
+          }
+        }
+      }
+    }
+    periods.push_back(period);
+  }
+  return periods;
+}
+
+// Normalised correlation of the len frames after a and after b, clamped to 0..1.
+float similarity(const std::vector<float>& mono, int a, int b, int len) {
+  len = std::min(len, (int)mono.size() - b);
+  if (len <= 0) return 0.0f;
+  double ab = 0.0, aa = 0.0, bb = 0.0;
+  for (int i = 0; i < len; ++i) {
+    const double x = mono[(size_t)(a + i)], y = mono[(size_t)(b + i)];
+    ab += x * y;
+    aa += x * x;
+    bb += y * y;
+  }
+  const double denom = std::sqrt(aa * bb);
+  return denom > 0.0 ? (float)juce::jlimit(0.0, 1.0, ab / denom) : 0.0f;
+}
+}
+
+std::shared_ptr<const PitchMarks> PitchMarks::analyse(const juce::AudioBuffer<float>& b) {
+  const int n = b.getNumSamples();
+  const int channels = std::min(2, b.getNumChannels());
+  if (channels <= 0 || n < 2 * kMinPeriod) return nullptr;
+
+  std::vector<float> mono((size_t)n, 0.0f);
+  for (int ch = 0; ch < channels; ++ch) {
+    const auto* rd = b.getReadPointer(ch);
+    for (int i = 0; i < n; ++i) mono[(size_t)i] += rd[i] / (float)channels;
+  }
+
+  const auto periods = detectPeriods(mono);
+  const auto periodAt = [&](int pos) {
+    const int p = periods[(size_t)std::min((int)periods.size() - 1, pos / kHop)];
+    return p > 0 ? p : kUnvoicedSpacing;
+  };
+
+  auto out = std::make_shared<PitchMarks>();
+
+  // Best entry within radius of target, ties going to the frame nearest the target.
+  const auto settle = [&](int target, int radius, int lo) {
+    const int from = std::max(lo, target - radius);
+    const int to = std::min(n - 1, target + radius);
+    int best = juce::jlimit(from, to, target);
+    float bestCost = std::numeric_limits<float>::max();
+    for (int i = from; i <= to; ++i) {
+      const float cost = entryCost(b, channels, i) + 1.0e-4f * (float)std::abs(i - target);
+      if (cost < bestCost) {
+        bestCost = cost;
+        best = i;
+      }
+    }
+    return best;
+  };
+
+  int pos = settle(0, periodAt(0) / 2, 0);
+  while (pos < n) {
+    out->mMarks.push_back({ pos, 0.0f, 0.0f });
+    const int period = periodAt(pos);
+    const int target = pos + period;
+    if (target >= n) break;
+    pos = settle(target, period / 4, pos + 1);
+  }
+
+  auto& marks = out->mMarks;
+  for (size_t i = 0; i < marks.size(); ++i) {
+    auto& m = marks[i];
+    if (i + 1 < marks.size()) {
+      const int next = marks[i + 1].pos;
+      m.similarity = similarity(mono, m.pos, next, next - m.pos);
+    } else if (i > 0) {
+      m.similarity = marks[i - 1].similarity;
+    }
+    m.cost = entryCost(b, channels, m.pos) + (1.0f - m.similarity) * 0.5f;
+  }
+
+  out->mBuckets.resize(((size_t)n >> kBucketShift) + 1);
+  size_t mark = 0;
+  for (size_t bucket = 0; bucket < out->mBuckets.size(); ++bucket) {
+    const int start = (int)(bucket << kBucketShift);
+    while (mark < marks.size() && marks[mark].pos < start) ++mark;
+    out->mBuckets[bucket] = (int)mark;
+  }
+  return out;
+}
+
+} // namespace sls::sampler
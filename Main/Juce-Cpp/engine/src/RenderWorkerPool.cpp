@@ -0,0 +1,186 @@
+#include "RenderWorkerPool.h"
+#include <algorithm>
+#include <thread>
+
+#if defined(_WIN32) || defined(_WIN64)
+  #include <windows.h>
+#elif defined(__APPLE__)
+  #include <dispatch/dispatch.h>
+#else
+  #include <cerrno>
+  #include <ctime>
+  #include <semaphore.h>
+#endif
+
+namespace {
+constexpr int kSpinIterations = 2000;
+constexpr int kIdleWaitMs = 50;
+
+inline uint32_t jobOf(uint64_t cursor) { return (uint32_t)(cursor >> 32); }
+inline uint32_t indexOf(uint64_t cursor) { return (uint32_t)(cursor & 0xffffffffu); }
+
+// Counting semaphore whose post() never takes a user-space lock (juce::WaitableEvent
+// locks a mutex to signal), so the audio thread can wake a worker.
+class WakeSemaphore {
+public:
+#if defined(_WIN32) || defined(_WIN64)
+  WakeSemaphore() : mHandle(CreateSemaphoreW(nullptr, 0, 0x7fffffff, nullptr)) {}
+  ~WakeSemaphore() { CloseHandle(mHandle); }
+  void post() { ReleaseSemaphore(mHandle, 1, nullptr); }
+  void wait(int timeoutMs) { WaitForSingleObject(mHandle, (DWORD)timeoutMs); }
+
+private:
+  HANDLE mHandle;
+#elif defined(__APPLE__)
+  WakeSemaphore() : mSem(dispatch_semaphore_create(0)) {}
+  ~WakeSemaphore() { dispatch_release(mSem); }
+  void post() { dispatch_semaphore_signal(mSem); }
+  void wait(int timeoutMs) {
+    dispatch_semaphore_wait(mSem, dispatch_time(DISPATCH_TIME_NOW, (int64_t)timeoutMs * 1000000));
+  }
+
+private:
+  dispatch_semaphore_t mSem;
+#else
+  WakeSemaphore() { sem_init(&mSem, 0, 0); }
+  ~WakeSemaphore() { sem_destroy(&mSem); }
+  void post() { sem_post(&mSem); }
+  void wait(int timeoutMs) {
+    timespec until {};
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += timeoutMs / 1000;
+    until.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+    if (until.tv_nsec >= 1000000000L) {
+      ++until.tv_sec;
+      until.tv_nsec -= 1000000000L;
+    }
+    while (sem_timedwait(&mSem, &until) != 0 && errno == EINTR) {}
+  }
+
+private:
+  sem_t mSem;
+#endif
+
+  WakeSemaphore(const WakeSemaphore&) = delete;
+  WakeSemaphore& operator=(const WakeSemaphore&) = delete;
+};
+}
+
+class RenderWorkerPool::Worker final : public juce::Thread {
+public:
+  Worker(RenderWorkerPool& pool, int index)
+    : juce::Thread("sls-render-" + juce::String(index)), mPool(pool) {}
+
+  // One post per sleep: a worker that timed out meanwhile just sees one spurious wake-up.
+  void wake() {
+    if (mSleeping.exchange(false)) mWake.post();
+  }
+
+  void run() override {
+    uint32_t seenJob = jobOf(mPool.mCursor.load(std::memory_order_acquire));
+    int idle = 0;
+
+    while (!threadShouldExit()) {
+      const uint32_t job = jobOf(mPool.mCursor.load(std::memory_order_acquire));
+      if (job != seenJob) {
+        seenJob = job;
+        mPool.runTasks(job);
+        idle = 0;
+        continue;
+      }
+
+      if (++idle < kSpinIterations) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      // Publish "asleep" before the final re-check so run() can never miss us.
+      mSleeping.store(true);
+      if (jobOf(mPool.mCursor.load()) == seenJob)
+        mWake.wait(kIdleWaitMs);
+      mSleeping.store(false);
+      idle = 0;
+    }
+  }
+
+private:
+  RenderWorkerPool& mPool;
+  std::atomic<bool> mSleeping { false };
+  WakeSemaphore mWake;
+};
+
+RenderWorkerPool::RenderWorkerPool() = default;
+
+RenderWorkerPool::~RenderWorkerPool() {
+  stop();
+}
+
+void RenderWorkerPool::start(int numWorkers, int samplesPerBlock, double sampleRate) {
+  stop();
+
+  const auto options = juce::Thread::RealtimeOptions{}
+                         .withApproximateAudioProcessingTime(std::max(1, samplesPerBlock), std::max(1.0, sampleRate));
+
+  for (int i = 0; i < std::max(0, numWorkers); ++i) {
+    auto w = std::make_unique<Worker>(*this, i);
+    // Fall back to a normal high-priority thread when realtime scheduling is not permitted.
+    if (!w->startRealtimeThread(options))
+      w->startThread(juce::Thread::Priority::highest);
+    mWorkers.push_back(std::move(w));
+  }
+}
+
+void RenderWorkerPool::stop() {
+  for (auto& w : mWorkers) w->signalThreadShouldExit();
+  for (auto& w : mWorkers) {
+    w->wake();
+    w->stopThread(1000);
+  }
+  mWorkers.clear();
+}
+
+void RenderWorkerPool::run(int numTasks, TaskFn fn, void* context) {
+  if (numTasks <= 0 || !fn) return;
+
+  if (mWorkers.empty() || numTasks == 1) {
+    for (int i = 0; i < numTasks; ++i) fn(context, i);
+    return;
+  }
+
+  mFn = fn;
+  mContext = context;
+  mNumTasks.store(numTasks, std::memory_order_relaxed);
+  mRemaining.store(numTasks, std::memory_order_relaxed);
+
+  ++mJob;
+  mCursor.store((uint64_t)mJob << 32);
+
+  for (auto& w : mWorkers) w->wake();
+
+  runTasks(mJob);
+
+  while (mRemaining.load(std::memory_order_acquire) > 0)
+    std::this_thread::yield();
+}
+
+bool RenderWorkerPool::claimTask(uint32_t job, int& index) {
+  uint64_t cur = mCursor.load(std::memory_order_acquire);
+  for (;;) {
+    if (jobOf(cur) != job) return false;
+    const uint32_t next = indexOf(cur);
+    // A stale count from the next job is harmless: the CAS below fails on the job id.
+    if ((int)next >= mNumTasks.load(std::memory_order_relaxed)) return false;
+    if (mCursor.compare_exchange_weak(cur, cur + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      index = (int)next;
+      return true;
+    }
+  }
+}
+
+void RenderWorkerPool::runTasks(uint32_t job) {
+  int index = 0;
+  while (claimTask(job, index)) {
+    mFn(mContext, index);
+    mRemaining.fetch_sub(1, std::memory_order_acq_rel);
+  }
+}
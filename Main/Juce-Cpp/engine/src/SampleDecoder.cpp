@@ -0,0 +1,110 @@
+#include "SampleDecoder.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace sls::sampler {
+
+namespace {
+constexpr juce::int64 kChunkFrames = 1 << 18; // ~5.5 s at 48 kHz
+constexpr int kProgressWaitMs = 50;
+constexpr int kStopTimeoutMs = 10000;
+
+bool seeksExactly(const juce::File& file) {
+  return file.hasFileExtension("wav;wave;aif;aiff;flac");
+}
+}
+
+struct SampleDecoder::ChunkedRead {
+  ChunkedRead(juce::AudioFormatManager& f, const juce::File& file_) : formats(f), file(file_) {}
+
+  juce::AudioFormatManager& formats;
+  juce::File file;
+  std::vector<float*> channels;
+  juce::int64 numFrames = 0;
+  juce::int64 chunkFrames = 0;
+  int numChunks = 0;
+
+  std::atomic<int> nextChunk { 0 };
+  std::atomic<int> chunksDone { 0 };
+  std::atomic<bool> failed { false };
+  juce::WaitableEvent finished;
+};
+
+SampleDecoder::SampleDecoder(int numThreads)
+  : mPool(juce::ThreadPoolOptions{}
+            .withThreadName("sls-decoder")
+            .withNumberOfThreads(std::max(1, numThreads))),
+    mNumThreads(std::max(1, numThreads)) {}
+
+SampleDecoder::~SampleDecoder() {
+  stop();
+}
+
+void SampleDecoder::submit(std::function<void()> job) {
+  mPool.addJob(std::move(job));
+}
+
+void SampleDecoder::waitUntilIdle() {
+  while (mPool.getNumJobs() > 0)
+    juce::Thread::sleep(2);
+}
+
+void SampleDecoder::stop() {
+  mPool.removeAllJobs(false, kStopTimeoutMs);
+}
+
+// Claims chunks until none are left. Runs on the owning thread (with progress) and on helpers.
+void SampleDecoder::readChunks(ChunkedRead& job, const Progress* progress) {
+  std::unique_ptr<juce::AudioFormatReader> reader;
+  std::vector<float*> dest(job.channels.size());
+
+  for (;;) {
+    const int chunk = job.nextChunk.fetch_add(1);
+    if (chunk >= job.numChunks) return;
+
+    const juce::int64 start = (juce::int64)chunk * job.chunkFrames;
+    const int count = (int)std::min(job.chunkFrames, job.numFrames - start);
+
+    if (!reader) reader.reset(job.formats.createReaderFor(job.file));
+    bool ok = reader != nullptr;
+    if (ok) {
+      for (size_t ch = 0; ch < dest.size(); ++ch) dest[ch] = job.channels[ch] + start;
+      ok = reader->read(dest.data(), (int)dest.size(), start, count);
+    }
+    if (!ok) job.failed.store(true);
+
+    const int done = job.chunksDone.fetch_add(1) + 1;
+    if (done == job.numChunks) job.finished.signal();
+    if (progress && *progress) (*progress)((double)done / (double)job.numChunks);
+  }
+}
+
+bool SampleDecoder::decode(juce::AudioFormatManager& formats, const juce::File& file,
+                           juce::AudioBuffer<float>& dest, juce::int64 numFrames, const Progress& progress) {
+  const int chs = dest.getNumChannels();
+  if (chs <= 0 || numFrames <= 0 || dest.getNumSamples() < numFrames) return false;
+
+  auto job = std::make_shared<ChunkedRead>(formats, file);
+  auto* const* writePointers = dest.getArrayOfWritePointers();
+  job->channels.assign(writePointers, writePointers + chs);
+  job->numFrames = numFrames;
+  job->chunkFrames = seeksExactly(file) ? kChunkFrames : numFrames;
+  job->numChunks = (int)((numFrames + job->chunkFrames - 1) / job->chunkFrames);
+
+  // Helpers only read the shared state after claiming a chunk, which this thread waits for;
+  // one that starts after the last chunk was claimed returns at once.
+  const int helpers = std::min(mNumThreads, job->numChunks - 1);
+  for (int i = 0; i < helpers; ++i)
+    mPool.addJob([job] { readChunks(*job); });
+
+  readChunks(*job, &progress);
+
+  while (!job->finished.wait(kProgressWaitMs)) {
+    if (progress) progress((double)job->chunksDone.load() / (double)job->numChunks);
+  }
+  return !job->failed.load();
+}
+
+} // namespace sls::sampler
@@ -0,0 +1,244 @@
+#include "SamplePool.h"
+#include "SampleVoice.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace sls::sampler {
+
+namespace {
+constexpr int kHashChunk = 1 << 20;
+constexpr uint64_t kHashMul = 0x9e3779b97f4a7c15ull;
+
+inline uint64_t mixWord(uint64_t h, uint64_t w) noexcept {
+  h = (h ^ w) * kHashMul;
+  return h ^ (h >> 29);
+}
+}
+
+SamplePool::SamplePool(Loader loader) : mLoader(std::move(loader)) {}
+
+// Size folded into a multiply-xorshift hash of every 8-byte word of the file, four independent
+// lanes so the multiplies overlap (one read pass, well above disk speed). 0 when unreadable.
+uint64_t SamplePool::contentKey(const juce::File& file, juce::int64 size) {
+  juce::FileInputStream in(file);
+  if (!in.openedOk()) return 0;
+
+  uint64_t lanes[4] = { 0x243f6a8885a308d3ull, 0x13198a2e03707344ull, 0xa4093822299f31d0ull, 0x082efa98ec4e6c89ull };
+  juce::HeapBlock<char> chunk(kHashChunk + 32);
+  for (;;) {
+    const int got = in.read(chunk.get(), kHashChunk);
+    if (got <= 0) break;
+    std::memset(chunk.get() + got, 0, 32);
+    for (int i = 0; i < got; i += 32) {
+      uint64_t w[4];
+      std::memcpy(w, chunk.get() + i, 32);
+      for (int k = 0; k < 4; ++k) lanes[k] = mixWord(lanes[k], w[k]);
+    }
+  }
+
+  uint64_t h = mixWord(lanes[0], (uint64_t)size);
+  for (int k = 1; k < 4; ++k) h = mixWord(h, lanes[k]);
+  return h != 0 ? h : 1;
+}
+
+std::shared_ptr<const SampleData> SamplePool::lookup(Entry& e, bool allowStreaming) {
+  auto s = e.full ? e.full : (allowStreaming ? e.streamed : nullptr);
+  if (s) e.lastUse = ++mClock;
+  return s;
+}
+
+size_t SamplePool::entryBytes(const Entry& e) {
+  return (e.full ? e.full->getMemoryBytes() : 0) + (e.streamed ? e.streamed->getMemoryBytes() : 0);
+}
+
+// Under mMutex: the pool hands out every reference, so a count of 1 cannot grow behind its back.
+bool SamplePool::isReferenced(const Entry& e) {
+  return (e.full && e.full.use_count() > 1) || (e.streamed && e.streamed.use_count() > 1);
+}
+
+std::shared_ptr<const SampleData> SamplePool::acquire(const juce::String& path, bool allowStreaming, const Progress& progress) {
+  if (path.isEmpty()) return {};
+  const juce::File file(path);
+  if (!file.existsAsFile()) return {};
+
+  const auto name = file.getFullPathName();
+  const auto size = file.getSize();
+  const auto modified = file.getLastModificationTime();
+
+  uint64_t key = 0;
+  double targetRate = 0.0;
+  {
+    std::scoped_lock lk(mMutex);
+    targetRate = mTargetRate;
+    auto it = mPaths.find(name);
+    if (it != mPaths.end() && it->second.fileSize == size && it->second.modified == modified) {
+      key = it->second.key;
+      auto e = mEntries.find(key);
+      if (e != mEntries.end() && e->second.targetHz == toHz(targetRate)) {
+        if (auto s = lookup(e->second, allowStreaming)) {
+          ++mHits;
+          return s;
+        }
+      }
+    }
+  }
+
+  if (key == 0) {
+    key = contentKey(file, size);
+    if (key == 0) return {};
+
+    std::scoped_lock lk(mMutex);
+    mPaths[name] = { key, size, modified };
+    auto e = mEntries.find(key);
+    if (e != mEntries.end() && e->second.targetHz == toHz(targetRate)) {
+      if (auto s = lookup(e->second, allowStreaming)) {
+        ++mHits;
+        ++mDeduplicated;
+        return s;
+      }
+    }
+  }
+
+  std::shared_ptr<const SampleData> loaded = mLoader ? mLoader(file, allowStreaming, targetRate, progress) : nullptr;
+  if (!loaded) return {};
+
+  std::vector<Entry> evicted; // freed after the lock is released
+  std::scoped_lock lk(mMutex);
+  ++mMisses;
+  auto& e = mEntries[key];
+  if (e.targetHz != toHz(targetRate)) evicted.push_back(std::exchange(e, Entry{}));
+  e.targetHz = toHz(targetRate);
+  e.lastUse = ++mClock;
+  (loaded->stream ? e.streamed : e.full) = loaded;
+  for (auto& x : evictToBudget()) evicted.push_back(std::move(x));
+  return loaded;
+}
+
+std::shared_ptr<const SampleData> SamplePool::find(const juce::String& path, bool allowStreaming) {
+  const auto name = juce::File(path).getFullPathName();
+  std::scoped_lock lk(mMutex);
+  auto it = mPaths.find(name);
+  if (it == mPaths.end()) return {};
+  auto e = mEntries.find(it->second.key);
+  if (e == mEntries.end()) return {};
+  auto s = lookup(e->second, allowStreaming);
+  if (s) ++mHits;
+  return s;
+}
+
+// Under mMutex. Returns the evicted entries so the caller frees them outside the lock.
+// Path records of evicted content stay: they only save a hash.
+std::vector<SamplePool::Entry> SamplePool::evictToBudget() {
+  std::vector<Entry> evicted;
+  size_t total = 0;
+  std::vector<std::pair<uint64_t, uint64_t>> evictable; // (lastUse, key)
+  for (const auto& [key, e] : mEntries) {
+    total += entryBytes(e);
+    if (!isReferenced(e)) evictable.emplace_back(e.lastUse, key);
+  }
+  if (total > mBudgetBytes) {
+    std::sort(evictable.begin(), evictable.end());
+    for (const auto& [lastUse, key] : evictable) {
+      if (total <= mBudgetBytes) break;
+      auto it = mEntries.find(key);
+      total -= entryBytes(it->second);
+      evicted.push_back(std::move(it->second));
+      mEntries.erase(it);
+      ++mEvictions;
+    }
+  }
+  publishStats();
+  return evicted;
+}
+
+// Under mMutex.
+void SamplePool::publishStats() {
+  int referenced = 0;
+  size_t bytes = 0, cachedBytes = 0;
+  for (const auto& kv : mEntries) {
+    const size_t b = entryBytes(kv.second);
+    bytes += b;
+    if (isReferenced(kv.second)) ++referenced;
+    else cachedBytes += b;
+  }
+  mStatEntries.store((int)mEntries.size(), std::memory_order_relaxed);
+  mStatReferenced.store(referenced, std::memory_order_relaxed);
+  mStatBytes.store(bytes, std::memory_order_relaxed);
+  mStatCachedBytes.store(cachedBytes, std::memory_order_relaxed);
+}
+
+void SamplePool::setBudgetBytes(size_t bytes) {
+  std::vector<Entry> evicted;
+  std::scoped_lock lk(mMutex);
+  mBudgetBytes = bytes;
+  mStatBudgetBytes.store(bytes, std::memory_order_relaxed);
+  evicted = evictToBudget();
+}
+
+void SamplePool::trim() {
+  std::vector<Entry> evicted;
+  std::scoped_lock lk(mMutex);
+  evicted = evictToBudget();
+}
+
+SamplePool::Replacements SamplePool::retarget(double targetRate, const Converter& convert) {
+  std::vector<std::pair<uint64_t, std::shared_ptr<const SampleData>>> live;
+  std::vector<Entry> dropped;
+  {
+    std::scoped_lock lk(mMutex);
+    mTargetRate = targetRate;
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+      auto& e = it->second;
+      if (e.targetHz == toHz(targetRate)) {
+        ++it;
+      } else if (!isReferenced(e)) {
+        dropped.push_back(std::move(e)); // nobody plays it: decode afresh if it is needed again
+        it = mEntries.erase(it);
+      } else {
+        if (e.full) live.emplace_back(it->first, e.full);
+        ++it;
+      }
+    }
+  }
+
+  // Converted outside the lock; an entry reloaded meanwhile keeps its newer sample.
+  Replacements out;
+  for (auto& [key, old] : live) {
+    auto converted = convert ? convert(*old, targetRate) : nullptr;
+
+    std::scoped_lock lk(mMutex);
+    auto it = mEntries.find(key);
+    if (it == mEntries.end() || it->second.full != old) continue;
+    it->second.targetHz = toHz(targetRate);
+    if (!converted) continue; // already usable at targetRate
+    it->second.full = converted;
+    it->second.streamed.reset();
+    out.emplace_back(std::move(old), std::move(converted));
+  }
+
+  std::scoped_lock lk(mMutex);
+  publishStats();
+  return out;
+}
+
+double SamplePool::getTargetRate() const {
+  std::scoped_lock lk(mMutex);
+  return mTargetRate;
+}
+
+SamplePool::Stats SamplePool::getStats() const {
+  Stats s;
+  s.entries = mStatEntries.load(std::memory_order_relaxed);
+  s.referenced = mStatReferenced.load(std::memory_order_relaxed);
+  s.bytes = mStatBytes.load(std::memory_order_relaxed);
+  s.cachedBytes = mStatCachedBytes.load(std::memory_order_relaxed);
+  s.budgetBytes = mStatBudgetBytes.load(std::memory_order_relaxed);
+  s.hits = mHits.load(std::memory_order_relaxed);
+  s.misses = mMisses.load(std::memory_order_relaxed);
+  s.deduplicated = mDeduplicated.load(std::memory_order_relaxed);
+  s.evictions = mEvictions.load(std::memory_order_relaxed);
+  return s;
+}
+
+} // namespace sls::sampler
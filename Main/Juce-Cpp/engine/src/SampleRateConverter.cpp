@@ -0,0 +1,127 @@
+#include "SampleRateConverter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace sls::sampler {
+
+namespace {
+constexpr int kZeroCrossings = 24;
+constexpr int kMaxExactPhases = 4096;
+constexpr int kTablePhases = 1024;
+constexpr double kKaiserBeta = 8.6;
+constexpr double kPassband = 0.95;   // cutoff as a fraction of the lower Nyquist
+
+double besselI0(double x) {
+  double sum = 1.0, term = 1.0;
+  const double q = x * x * 0.25;
+  for (int k = 1; k < 64; ++k) {
+    term *= q / ((double)k * k);
+    sum += term;
+    if (term < sum * 1.0e-12) break;
+  }
+  return sum;
+}
+
+// taps coefficients per phase, phases + 1 rows (the last one closes the interpolation).
+// Row p is the filter for an output falling p / phases of a frame after the centre tap.
+std::vector<float> designTable(int phases, int halfTaps, double cutoff) {
+  const int taps = 2 * halfTaps;
+  std::vector<float> table((size_t)(phases + 1) * (size_t)taps);
+  const double i0Beta = besselI0(kKaiserBeta);
+
+  for (int p = 0; p <= phases; ++p) {
+    const double frac = (double)p / (double)phases;
+    float* row = table.data() + (size_t)p * (size_t)taps;
+    double sum = 0.0;
+    for (int j = 0; j < taps; ++j) {
+      const double x = (double)(j - halfTaps + 1) - frac;   // tap j reads frame centre - halfTaps + 1 + j
+      const double arg = cutoff * x * juce::MathConstants<double>::pi;
+      const double sinc = std::abs(arg) < 1.0e-12 ? 1.0 : std::sin(arg) / arg;
+      const double w = x / (double)halfTaps;
+      const double window = std::abs(w) >= 1.0 ? 0.0 : besselI0(kKaiserBeta * std::sqrt(1.0 - w * w)) / i0Beta;
+      row[j] = (float)(sinc * window);
+      sum += row[j];
+    }
+    if (std::abs(sum) > 0.0)
+      for (int j = 0; j < taps; ++j) row[j] = (float)(row[j] / sum);
+  }
+  return table;
+}
+
+// Source frames first .. first + taps - 1 against row, zero outside the source.
+inline float applyTaps(const float* src, int n, int64_t first, const float* row, int taps) {
+  float acc = 0.0f;
+  if (first >= 0 && first + taps <= n) {
+    const float* s = src + first;
+    for (int j = 0; j < taps; ++j) acc += s[j] * row[j];
+    return acc;
+  }
+  for (int j = 0; j < taps; ++j) {
+    const int64_t i = first + j;
+    if (i >= 0 && i < n) acc += src[i] * row[j];
+  }
+  return acc;
+}
+}
+
+juce::AudioBuffer<float> convertSampleRate(const juce::AudioBuffer<float>& source, double sourceRate, double targetRate) {
+  const int channels = source.getNumChannels();
+  const int n = source.getNumSamples();
+  if (channels <= 0 || n <= 0 || sourceRate <= 0.0 || targetRate <= 0.0 || juce::approximatelyEqual(sourceRate, targetRate))
+    return juce::AudioBuffer<float>(source);
+
+  const double ratio = targetRate / sourceRate;
+  const int outFrames = std::max(1, (int)std::llround((double)n * ratio));
+  const double cutoff = std::min(1.0, ratio) * kPassband;
+  const int halfTaps = (int)std::ceil((double)kZeroCrossings / std::min(1.0, ratio));
+  const int taps = 2 * halfTaps;
+
+  // Exact polyphase when both rates are whole numbers with a small reduced ratio L / M.
+  int64_t upL = 0, downM = 0;
+  const auto inHz = (int64_t)std::llround(sourceRate), outHz = (int64_t)std::llround(targetRate);
+  if (juce::approximatelyEqual(sourceRate, (double)inHz) && juce::approximatelyEqual(targetRate, (double)outHz)) {
+    const auto g = std::gcd(inHz, outHz);
+    if (outHz / g <= kMaxExactPhases) {
+      upL = outHz / g;
+      downM = inHz / g;
+    }
+  }
+
+  const int phases = upL > 0 ? (int)upL : kTablePhases;
+  const auto table = designTable(phases, halfTaps, cutoff);
+  juce::AudioBuffer<float> out(channels, outFrames);
+
+  for (int ch = 0; ch < channels; ++ch) {
+    const float* src = source.getReadPointer(ch);
+    float* dst = out.getWritePointer(ch);
+
+    if (upL > 0) {
+      // Output k sits at source frame k * M / L: integer part and phase come out exactly.
+      for (int k = 0; k < outFrames; ++k) {
+        const int64_t num = (int64_t)k * downM;
+        const int64_t centre = num / upL;
+        const int phase = (int)(num % upL);
+        dst[k] = applyTaps(src, n, centre - halfTaps + 1, table.data() + (size_t)phase * (size_t)taps, taps);
+      }
+    } else {
+      const double step = sourceRate / targetRate;
+      for (int k = 0; k < outFrames; ++k) {
+        const double pos = (double)k * step;
+        const auto centre = (int64_t)std::floor(pos);
+        const double phasePos = (pos - (double)centre) * (double)phases;
+        const int p0 = std::min(phases - 1, (int)phasePos);
+        const float a = (float)(phasePos - (double)p0);
+        const int64_t first = centre - halfTaps + 1;
+        const float y0 = applyTaps(src, n, first, table.data() + (size_t)p0 * (size_t)taps, taps);
+        const float y1 = applyTaps(src, n, first, table.data() + (size_t)(p0 + 1) * (size_t)taps, taps);
+        dst[k] = y0 + (y1 - y0) * a;
+      }
+    }
+  }
+  return out;
+}
+
+} // namespace sls::sampler
@@ -0,0 +1,215 @@
+#include "SampleStream.h"
+#include "SampleVoice.h"
+#include <algorithm>
+
+namespace sls::sampler {
+
+namespace {
+constexpr int kChunkFrames = 8192;
+constexpr int kPrimeFrames = 16384;
+constexpr int kPrimeFramesRealtime = 4096; // claims from the audio thread copy less; the streamer catches up
+constexpr int kIdleWaitMs = 5;
+}
+
+// ------------------------------ StreamSource ------------------------------
+
+std::shared_ptr<StreamSource> StreamSource::open(juce::AudioFormatManager& formats, const juce::File& file) {
+  auto source = std::make_shared<StreamSource>();
+
+  // Uncompressed formats: map the file and read samples straight out of the mapping.
+  if (auto* format = formats.findFormatForFileExtension(file.getFileExtension())) {
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+    if (mapped && mapped->mapEntireFile()) {
+      source->mReader = std::move(mapped);
+      source->mMapped = true;
+    }
+  }
+
+  if (!source->mReader)
+    source->mReader.reset(formats.createReaderFor(file));
+  if (!source->mReader || source->mReader->lengthInSamples <= 0) return {};
+
+  source->mLength = source->mReader->lengthInSamples;
+  source->mSampleRate = source->mReader->sampleRate;
+  source->mNumChannels = (int)std::min<unsigned int>(2, source->mReader->numChannels);
+  return source;
+}
+
+void StreamSource::read(float* const* dest, int numChannels, juce::int64 startFrame, int numFrames) {
+  std::scoped_lock lk(mMutex);
+
+  const juce::int64 first = juce::jlimit<juce::int64>(0, mLength, startFrame);
+  const juce::int64 last = juce::jlimit<juce::int64>(0, mLength, startFrame + numFrames);
+  const int before = (int)(first - startFrame);
+  const int count = (int)(last - first);
+
+  juce::AudioBuffer<float> view(dest, numChannels, numFrames);
+  if (count > 0) {
+    mReader->read(&view, before, count, first, true, numChannels > 1);
+  } else {
+    // Entirely outside the file: one edge frame stands in for all of them.
+    mReader->read(&view, 0, 1, startFrame < 0 ? 0 : mLength - 1, true, numChannels > 1);
+  }
+
+  // Out-of-range frames repeat the nearest edge (like SampleData guard frames).
+  const int validStart = count > 0 ? before : 0;
+  const int validEnd = count > 0 ? before + count : 1;
+  for (int ch = 0; ch < numChannels; ++ch) {
+    float* d = dest[ch];
+    std::fill(d, d + validStart, d[validStart]);
+    std::fill(d + validEnd, d + numFrames, d[validEnd - 1]);
+  }
+}
+
+// ------------------------------ StreamRing ------------------------------
+
+void StreamRing::allocate(int capacity) {
+  mCapacity = capacity;
+  mStride = (size_t)capacity + 2 * kGuard;
+  mData.calloc(mStride * 2);
+}
+
+void StreamRing::write(juce::int64 frame, const float* const* src, int numChannels, int numFrames) {
+  const juce::int64 mask = mCapacity - 1;
+  for (int ch = 0; ch < numChannels; ++ch) {
+    float* base = mData.get() + (size_t)ch * mStride + kGuard;
+    for (int i = 0; i < numFrames;) {
+      const int idx = (int)((frame + i) & mask);
+      const int span = std::min(numFrames - i, mCapacity - idx);
+      std::copy_n(src[ch] + i, span, base + idx);
+      i += span;
+    }
+    // Mirrors: after the end repeats the first frames, before the start repeats the last ones.
+    std::copy_n(base, kGuard, base + mCapacity);
+    std::copy_n(base + mCapacity - kGuard, kGuard, base - kGuard);
+  }
+}
+
+// ------------------------------ SampleStreamer ------------------------------
+
+SampleStreamer::SampleStreamer() : juce::Thread("sls-sample-stream") {}
+
+SampleStreamer::~SampleStreamer() {
+  stopThread(2000);
+}
+
+void SampleStreamer::configure(size_t budgetBytes) {
+  stopThread(2000);
+
+  const size_t ringBytes = (size_t)kRingFrames * 2 * sizeof(float);
+  const size_t numRings = budgetBytes / ringBytes;
+
+  mRings.clear();
+  for (size_t i = 0; i < numRings; ++i) {
+    auto ring = std::make_unique<StreamRing>();
+    ring->allocate(kRingFrames);
+    mRings.push_back(std::move(ring));
+  }
+  mBudgetBytes = budgetBytes;
+  mScratch.setSize(2, kChunkFrames);
+
+  if (!mRings.empty()) startThread(juce::Thread::Priority::high);
+}
+
+StreamRing* SampleStreamer::claim(const std::shared_ptr<const SampleData>& data, juce::int64 startFrame, bool mayReadDisk) {
+  if (!data || !data->stream || !data->hasGuardFrames()) return nullptr;
+
+  for (auto& r : mRings) {
+    int expected = StreamRing::Free;
+    if (!r->mState.compare_exchange_strong(expected, StreamRing::Priming)) continue;
+
+    StreamRing& ring = *r;
+    const auto& source = data->stream;
+    const int chs = std::max(1, source->getNumChannels());
+
+    // Prime from one frame before the start (the interpolator's first tap).
+    const juce::int64 first = startFrame - 1;
+    const juce::int64 inHead = (juce::int64)data->buffer.getNumSamples() - first;
+    int prime = std::min(mayReadDisk ? kPrimeFrames : kPrimeFramesRealtime, ring.mCapacity - 2 * StreamRing::kGuard);
+
+    if (first >= -1 && inHead >= std::min<juce::int64>(prime, kChunkFrames)) {
+      prime = (int)std::min<juce::int64>(prime, inHead);
+      const int lastCh = data->buffer.getNumChannels() - 1;
+      const float* src[2] = { data->getGuardedChannel(0) + first, data->getGuardedChannel(std::min(1, lastCh)) + first };
+      ring.write(first, src, chs, prime);
+    } else if (mayReadDisk) {
+      juce::AudioBuffer<float> primeBuffer(chs, prime);
+      source->read(primeBuffer.getArrayOfWritePointers(), chs, first, prime);
+      ring.write(first, primeBuffer.getArrayOfReadPointers(), chs, prime);
+    } else {
+      ring.mState.store(StreamRing::Free, std::memory_order_release);
+      break;
+    }
+
+    ring.mSource = source;
+    ring.mNumChannels = chs;
+    ring.mUnderruns.store(0, std::memory_order_relaxed);
+    ring.mReadFrame.store(first, std::memory_order_relaxed);
+    ring.mFilledEnd.store(first + prime, std::memory_order_relaxed);
+    ring.mState.store(StreamRing::Active, std::memory_order_release);
+    return &ring;
+  }
+
+  mClaimFailures.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+void SampleStreamer::fill(StreamRing& ring) {
+  const juce::int64 readFrame = ring.mReadFrame.load(std::memory_order_acquire);
+  juce::int64 filled = ring.mFilledEnd.load(std::memory_order_relaxed);
+  if (filled < readFrame) filled = readFrame; // the voice skipped ahead after an underrun
+
+  // Never overwrite frames the voice may still read; stop a few frames past the end of the file.
+  const juce::int64 limit = std::min(readFrame + ring.mCapacity - 2 * StreamRing::kGuard,
+                                     ring.mSource->getLengthInFrames() + StreamRing::kGuard);
+  float* dst[2] = { mScratch.getWritePointer(0), mScratch.getWritePointer(1) };
+
+  while (filled < limit && !threadShouldExit()) {
+    const int count = (int)std::min<juce::int64>(kChunkFrames, limit - filled);
+    ring.mSource->read(dst, ring.mNumChannels, filled, count);
+    ring.write(filled, dst, ring.mNumChannels, count);
+    filled += count;
+    ring.mFilledEnd.store(filled, std::memory_order_release);
+  }
+}
+
+void SampleStreamer::fillNow() {
+  std::scoped_lock lk(mFillMutex);
+  for (auto& r : mRings) {
+    const int state = r->mState.load(std::memory_order_acquire);
+    if (state == StreamRing::Active) fill(*r);
+  }
+}
+
+void SampleStreamer::run() {
+  while (!threadShouldExit()) {
+    {
+      std::scoped_lock lk(mFillMutex);
+      for (auto& r : mRings) {
+        const int state = r->mState.load(std::memory_order_acquire);
+        if (state == StreamRing::Active) {
+          fill(*r);
+        } else if (state == StreamRing::Released) {
+          r->mSource.reset(); // file handles close here, never on the audio thread
+          r->mState.store(StreamRing::Free, std::memory_order_release);
+        }
+      }
+    }
+    wait(kIdleWaitMs);
+  }
+}
+
+SampleStreamer::Stats SampleStreamer::getStats() const {
+  Stats s;
+  s.rings = (int)mRings.size();
+  s.claimFailures = mClaimFailures.load(std::memory_order_relaxed);
+  s.ringBytes = mRings.size() * (size_t)kRingFrames * 2 * sizeof(float);
+  for (const auto& r : mRings) {
+    const int state = r->mState.load(std::memory_order_relaxed);
+    if (state != StreamRing::Free) ++s.ringsInUse;
+    s.underruns += r->mUnderruns.load(std::memory_order_relaxed);
+  }
+  return s;
+}
+
+} // namespace sls::sampler
@@ -0,0 +1,135 @@
+#include "ShmIpc.h"
+#include <algorithm>
+#include <new>
+
+namespace sls::ipc {
+
+namespace {
+constexpr uint32_t kHeaderBytes = 4096; // ring data starts page aligned
+constexpr uint32_t kTelemetryOffset = 512;
+constexpr uint32_t kMinRingBytes = 64u * 1024u;
+constexpr uint32_t kMaxRingBytes = 16u * 1024u * 1024u;
+
+uint32_t roundUpPow2(uint32_t v) {
+  uint32_t p = kMinRingBytes;
+  while (p < v && p < kMaxRingBytes) p <<= 1;
+  return p;
+}
+
+static_assert(sizeof(ShmFileHeader) <= kTelemetryOffset, "ShmFileHeader must end before the telemetry block");
+static_assert(kTelemetryOffset % 64 == 0 && kTelemetryOffset + sizeof(ShmTelemetry) <= kHeaderBytes,
+              "ShmTelemetry must fit in the header page");
+}
+
+// ------------------------------ ShmRing ------------------------------
+
+bool ShmRing::write(ShmMsgType type, const void* payload, uint32_t size) noexcept {
+  if (!mHeader) return false;
+
+  const uint64_t capacity = mHeader->capacity;
+  const uint64_t mask = capacity - 1;
+  const uint64_t recordBytes = recordSize(size);
+  if (recordBytes > capacity / 2) return false;
+
+  uint64_t writePos = mHeader->writePos.load(std::memory_order_relaxed);
+  const uint64_t readPos = mHeader->readPos.load(std::memory_order_acquire);
+  const uint64_t toEnd = capacity - (writePos & mask);
+  const uint64_t needed = recordBytes + (recordBytes > toEnd ? toEnd : 0);
+  if (capacity - (writePos - readPos) < needed) return false; // full
+
+  if (recordBytes > toEnd) {
+    ShmMsgHeader pad;
+    pad.type = (uint16_t)ShmMsgType::Pad;
+    pad.size = (uint32_t)(toEnd - sizeof(ShmMsgHeader));
+    std::memcpy(mData + (writePos & mask), &pad, sizeof(pad));
+    writePos += toEnd;
+  }
+
+  ShmMsgHeader h;
+  h.type = (uint16_t)type;
+  h.size = size;
+  uint8_t* dst = mData + (writePos & mask);
+  std::memcpy(dst, &h, sizeof(h));
+  if (size > 0) std::memcpy(dst + sizeof(h), payload, size);
+
+  mHeader->writePos.store(writePos + recordBytes, std::memory_order_release);
+  return true;
+}
+
+// ------------------------------ ShmIpcTransport ------------------------------
+
+ShmIpcTransport::ShmIpcTransport() = default;
+
+ShmIpcTransport::~ShmIpcTransport() { close(); }
+
+bool ShmIpcTransport::open(const juce::File& file, uint32_t ringBytes, juce::String& error) {
+  close();
+
+  const uint32_t ring = roundUpPow2(ringBytes);
+  const size_t totalBytes = (size_t)kHeaderBytes + 2u * (size_t)ring;
+
+  // Fresh zeroed file of the final size, then map it read/write and shared.
+  juce::MemoryBlock zeros(totalBytes, true);
+  if (!file.getParentDirectory().createDirectory() || !file.replaceWithData(zeros.getData(), zeros.getSize())) {
+    error = "Cannot create shared-memory file";
+    return false;
+  }
+
+  auto map = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite, false);
+  if (map->getData() == nullptr || map->getSize() < totalBytes) {
+    error = "Cannot map shared-memory file";
+    return false;
+  }
+
+  auto* base = static_cast<uint8_t*>(map->getData());
+  auto* header = new (base) ShmFileHeader();
+  std::memcpy(header->magic, kShmMagic, sizeof(header->magic));
+  header->version = kShmVersion;
+  header->headerBytes = kHeaderBytes;
+  header->telemetryOffset = kTelemetryOffset;
+  auto* telemetry = new (base + kTelemetryOffset) ShmTelemetry();
+
+  const auto initRing = [&](ShmRingHeader& r, uint32_t offset) {
+    r.capacity = ring;
+    r.dataOffset = offset;
+    r.writePos.store(0, std::memory_order_relaxed);
+    r.readPos.store(0, std::memory_order_relaxed);
+  };
+  initRing(header->toEngine, kHeaderBytes);
+  initRing(header->toClient, kHeaderBytes + ring);
+
+  mToEngine.attach(&header->toEngine, base + header->toEngine.dataOffset);
+  mToClient.attach(&header->toClient, base + header->toClient.dataOffset);
+  header->engineAttached.store(1, std::memory_order_release);
+
+  mMap = std::move(map);
+  mHeader = header;
+  mTelemetry = telemetry;
+  mFile = file;
+  mRingBytes = ring;
+  return true;
+}
+
+void ShmIpcTransport::close() {
+  if (mHeader) mHeader->engineAttached.store(0, std::memory_order_release);
+  mToEngine.attach(nullptr, nullptr);
+  mToClient.attach(nullptr, nullptr);
+  mHeader = nullptr;
+  mTelemetry = nullptr;
+  mMap.reset();
+  mRingBytes = 0;
+}
+
+uint32_t ShmIpcTransport::getToEngineOffset() const noexcept {
+  return mHeader ? mHeader->toEngine.dataOffset : 0;
+}
+
+uint32_t ShmIpcTransport::getToClientOffset() const noexcept {
+  return mHeader ? mHeader->toClient.dataOffset : 0;
+}
+
+uint32_t ShmIpcTransport::getTelemetryOffset() const noexcept {
+  return mHeader ? mHeader->telemetryOffset : 0;
+}
+
+} // namespace sls::ipc
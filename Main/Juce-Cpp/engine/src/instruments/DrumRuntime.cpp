@@ -9,9 +9,7 @@ void DrumRuntime::prepare(double sampleRate, int maxVoicesPerPiece) {
     sampleRate_ = std::max(1.0, sampleRate);
     maxVoicesPerPiece_ = std::max(1, maxVoicesPerPiece);
     for (auto& [note, pieceRt] : noteMap_) {
-        pieceRt.engine.prepare(sampleRate_, maxVoicesPerPiece_);
-        pieceRt.engine.setPatch(pieceRt.patch);
-        pieceRt.prepared = true;
+        pieceRt.engine.prepare(maxVoicesPerPiece_, patches_.compile(pieceRt.patch, sampleRate_));
         (void) note;
     }
 }
@@ -40,12 +38,7 @@ void DrumRuntime::syncFromInstrumentState(const sls::inst::InstrumentState& stat
         rt.routing.solo = piece.solo;
         rt.fallbackMixChannel = rt.routing.mixChannel;
         rt.patch = factory_.makePatchForPiece(piece);
-
-        if (sampleRate_ > 1.0) {
-            rt.engine.prepare(sampleRate_, maxVoicesPerPiece_);
-            rt.engine.setPatch(rt.patch);
-            rt.prepared = true;
-        }
+        rt.engine.prepare(maxVoicesPerPiece_, patches_.compile(rt.patch, sampleRate_));
 
         noteMap_[rt.routing.midiNote] = std::move(rt);
     }
@@ -68,12 +61,6 @@ void DrumRuntime::noteOn(const juce::String& instId, int midiNote, float velocit
     piece->routing.mixChannel = std::max(1, piece->spec.mixChannel > 0 ? piece->spec.mixChannel : fallbackMixChannel);
     piece->fallbackMixChannel = std::max(1, fallbackMixChannel);
 
-    if (!piece->prepared) {
-        piece->engine.prepare(sampleRate_, maxVoicesPerPiece_);
-        piece->engine.setPatch(piece->patch);
-        piece->prepared = true;
-    }
-
     piece->engine.noteOn(piece->routing.midiNote, juce::jlimit(0.0f, 1.0f, velocity * piece->spec.level));
 }
 
@@ -106,6 +93,17 @@ std::vector<DrumRuntime::RenderTap> DrumRuntime::renderFrame() {
     return taps;
 }
 
+void DrumRuntime::renderBus(int bus, int numBuses, float* left, float* right, int numSamples) {
+    if (!left || !right || numBuses <= 0 || numSamples <= 0) return;
+
+    for (auto& [note, piece] : noteMap_) {
+        const int mixChannel = std::max(1, piece.routing.mixChannel > 0 ? piece.routing.mixChannel : piece.fallbackMixChannel);
+        if (juce::jlimit(0, numBuses - 1, mixChannel - 1) != bus) continue;
+        piece.engine.renderBlock(left, right, numSamples);
+        (void) note;
+    }
+}
+
 DrumRuntime::PieceRuntime* DrumRuntime::findPieceRuntimeForNote(int midiNote) {
     auto it = noteMap_.find(midiNote);
     return it != noteMap_.end() ? &it->second : nullptr;
@@ -0,0 +1,215 @@
+#include "instruments/EnvelopeBank.h"
+
+#include <algorithm>
+#include <cmath>
+#include "instruments/fm/FmSine.h"
+
+namespace sls::engine {
+
+namespace {
+using fm::FmVec4;
+
+constexpr double kMaxSegmentSamples = 1.0e9; // keeps done_ and float(done_) well in range
+
+// Samples in a segment: at least one, the last of them lands on the target.
+int segmentLength(double samples) noexcept {
+    if (!(samples < kMaxSegmentSamples)) return static_cast<int>(kMaxSegmentSamples);
+    return std::max(1, static_cast<int>(std::ceil(samples)));
+}
+
+// start + step * k for k = first, first + 1, ...: the expression getNextSample uses.
+void renderLinear(float* out, int count, float start, float step, int first) noexcept {
+    alignas(16) static constexpr float kOffsets[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    const FmVec4 startV = FmVec4::fill(start);
+    const FmVec4 stepV = FmVec4::fill(step);
+    const FmVec4 four = FmVec4::fill(4.0f);
+    FmVec4 k = FmVec4::fill(static_cast<float>(first)) + FmVec4::load(kOffsets);
+    int j = 0;
+    for (; j + 4 <= count; j += 4) {
+        (startV + stepV * k).store(out + j);
+        k = k + four;
+    }
+    for (; j < count; ++j) out[j] = start + step * static_cast<float>(first + j);
+}
+
+// value * factor^k for k = 1, 2, ...; returns the last value.
+float renderExponential(float* out, int count, float value, float factor) noexcept {
+    const float f2 = factor * factor;
+    const float f3 = f2 * factor;
+    const float f4 = f3 * factor;
+    const float powers[4] = { factor, f2, f3, f4 };
+    const FmVec4 p = FmVec4::load(powers);
+    int j = 0;
+    for (; j + 4 <= count; j += 4) {
+        (FmVec4::fill(value) * p).store(out + j);
+        value = out[j + 3];
+    }
+    for (; j < count; ++j) out[j] = value *= factor;
+    return value;
+}
+} // namespace
+
+EnvelopeRates EnvelopeRates::compute(double attackSeconds, double decaySeconds, float sustainLevel,
+                                     double releaseSeconds, double sampleRate) {
+    const double rate = std::max(1.0, sampleRate);
+    EnvelopeRates r;
+    r.sustainLevel = std::clamp(sustainLevel, 0.0f, 1.0f);
+    r.attackStep = 1.0f / static_cast<float>(std::max(1.0, std::max(0.0001, attackSeconds) * rate));
+    r.decayStep = (1.0f - r.sustainLevel) / static_cast<float>(std::max(1.0, std::max(0.0001, decaySeconds) * rate));
+    r.releaseSamples = static_cast<float>(std::max(1.0, std::max(0.0001, releaseSeconds) * rate));
+    return r;
+}
+
+void EnvelopeRates::setExponentialRelease(double releaseSeconds, double sampleRate, float floorLevel) {
+    const double samples = std::max(1.0, releaseSeconds * std::max(1.0, sampleRate));
+    releaseFloor = std::clamp(floorLevel, 1.0e-9f, 0.5f);
+    releaseFactor = static_cast<float>(std::exp(std::log(static_cast<double>(releaseFloor)) / samples));
+}
+
+void Envelope::reset() noexcept {
+    stage_ = EnvelopeStage::Idle;
+    value_ = 0.0f;
+    factor_ = 0.0f;
+    done_ = length_ = 0;
+}
+
+void Envelope::noteOn() noexcept {
+    value_ = std::max(0.0f, value_);
+    const double samples = rates_.attackStep > 0.0f ? (1.0 - value_) / rates_.attackStep : 1.0;
+    beginLinear(EnvelopeStage::Attack, 1.0f, rates_.attackStep, samples);
+}
+
+void Envelope::noteOff() noexcept {
+    if (stage_ == EnvelopeStage::Idle) return;
+    if (rates_.releaseFactor > 0.0f && rates_.releaseFactor < 1.0f) {
+        const double samples = value_ > rates_.releaseFloor
+            ? std::log(static_cast<double>(rates_.releaseFloor) / value_) / std::log(static_cast<double>(rates_.releaseFactor))
+            : 1.0;
+        beginExponential(0.0f, samples);
+    } else {
+        beginLinear(EnvelopeStage::Release, 0.0f, -value_ / rates_.releaseSamples,
+                    value_ > 0.0f ? rates_.releaseSamples : 1.0);
+    }
+}
+
+void Envelope::beginLinear(EnvelopeStage stage, float target, float step, double samples) noexcept {
+    stage_ = stage;
+    start_ = value_;
+    step_ = step;
+    factor_ = 0.0f;
+    target_ = target;
+    done_ = 0;
+    length_ = segmentLength(samples);
+}
+
+void Envelope::beginExponential(float target, double samples) noexcept {
+    stage_ = EnvelopeStage::Release;
+    start_ = value_;
+    step_ = 0.0f;
+    factor_ = rates_.releaseFactor;
+    target_ = target;
+    done_ = 0;
+    length_ = segmentLength(samples);
+}
+
+// The segment's last sample was its target: start the next stage from there.
+void Envelope::finishSegment() noexcept {
+    value_ = target_;
+    switch (stage_) {
+        case EnvelopeStage::Attack: {
+            const float decayStep = rates_.decayStep;
+            beginLinear(EnvelopeStage::Decay, rates_.sustainLevel, -decayStep,
+                        decayStep > 0.0f ? (1.0 - rates_.sustainLevel) / decayStep : 1.0);
+            break;
+        }
+        case EnvelopeStage::Decay:
+            stage_ = EnvelopeStage::Sustain;
+            value_ = rates_.sustainLevel;
+            break;
+        case EnvelopeStage::Release:
+            stage_ = EnvelopeStage::Idle;
+            value_ = 0.0f;
+            break;
+        case EnvelopeStage::Idle:
+        case EnvelopeStage::Sustain:
+            break;
+    }
+}
+
+float Envelope::getNextSample() noexcept {
+    if (stage_ == EnvelopeStage::Idle) return 0.0f;
+    if (stage_ == EnvelopeStage::Sustain) return value_ = rates_.sustainLevel;
+
+    if (++done_ >= length_) {
+        value_ = target_;
+        const float out = value_;
+        finishSegment();
+        return out;
+    }
+    value_ = factor_ > 0.0f ? value_ * factor_ : start_ + step_ * static_cast<float>(done_);
+    return value_;
+}
+
+int Envelope::render(float* out, int numSamples) noexcept {
+    if (stage_ == EnvelopeStage::Idle) {
+        std::fill(out, out + std::max(0, numSamples), 0.0f);
+        return 0;
+    }
+
+    for (int i = 0; i < numSamples;) {
+        if (stage_ == EnvelopeStage::Sustain) {
+            value_ = rates_.sustainLevel;
+            std::fill(out + i, out + numSamples, value_);
+            return numSamples;
+        }
+
+        const int count = std::min(numSamples - i, length_ - done_);
+        const bool ends = done_ + count == length_;
+        const int ramp = ends ? count - 1 : count;
+        float* segment = out + i;
+        if (ramp > 0) {
+            if (factor_ > 0.0f) {
+                value_ = renderExponential(segment, ramp, value_, factor_);
+            } else {
+                renderLinear(segment, ramp, start_, step_, done_ + 1);
+                value_ = segment[ramp - 1];
+            }
+            done_ += ramp;
+        }
+        i += count;
+
+        if (ends) {
+            done_ = length_;
+            segment[ramp] = target_;
+            finishSegment();
+            if (stage_ == EnvelopeStage::Idle) {
+                std::fill(out + i, out + numSamples, 0.0f);
+                return i - 1;
+            }
+        }
+    }
+    return numSamples;
+}
+
+void EnvelopeBank::prepare(int maxEnvelopes, int maxFrames) {
+    maxFrames_ = std::max(1, maxFrames);
+    values_.assign(static_cast<std::size_t>(std::max(0, maxEnvelopes)) * static_cast<std::size_t>(maxFrames_), 0.0f);
+    running_.assign(static_cast<std::size_t>(std::max(0, maxEnvelopes)), -1);
+}
+
+void EnvelopeBank::render(Envelope* const* envelopes, int first, int count, int numFrames) noexcept {
+    numFrames = std::min(numFrames, maxFrames_);
+    const int last = std::min(first + count, static_cast<int>(running_.size()));
+    for (int e = std::max(0, first); e < last; ++e) {
+        float* out = values_.data() + static_cast<std::size_t>(e) * static_cast<std::size_t>(maxFrames_);
+        Envelope* envelope = envelopes[e - first];
+        if (envelope && envelope->isActive()) {
+            running_[static_cast<std::size_t>(e)] = envelope->render(out, numFrames);
+        } else {
+            std::fill(out, out + numFrames, 0.0f);
+            running_[static_cast<std::size_t>(e)] = -1;
+        }
+    }
+}
+
+} // namespace sls::engine
@@ -1,12 +1,21 @@
 #include "instruments/SampleTouskiInstrument.h"
 
+#include <algorithm>
+
 namespace sls::inst {
 
 SampleTouskiInstrument::SampleTouskiInstrument(LoadSampleFn loadSampleFn)
     : loadSampleFn_(std::move(loadSampleFn)) {}
 
 void SampleTouskiInstrument::setLoadSampleFn(LoadSampleFn fn) { loadSampleFn_ = std::move(fn); }
-void SampleTouskiInstrument::setSampleRate(double sr) { sampleRate_ = std::max(1.0, sr); }
+void SampleTouskiInstrument::setSampleRate(double sr) {
+  sampleRate_ = std::max(1.0, sr);
+  for (auto& kv : programs_) {
+    auto state = std::make_shared<ProgramState>(*kv.second);
+    compileProgram(*state);
+    kv.second = std::move(state);
+  }
+}
 double SampleTouskiInstrument::getSampleRate() const noexcept { return sampleRate_; }
 
 float SampleTouskiInstrument::clamp01(double v) {
@@ -106,7 +115,8 @@ bool SampleTouskiInstrument::wantsGranularPitchEngine(const juce::String& engine
 
 SampleTouskiInstrument::Zone SampleTouskiInstrument::makeZoneFromObject(const juce::DynamicObject* o,
                                                                         const juce::File& baseDir,
-                                                                        const RuntimeParams& parent) const {
+                                                                        const RuntimeParams& parent,
+                                                                        const LoadSampleFn& loadSample) const {
   Zone z;
   z.rootMidi = parent.rootMidi;
   z.posAction = parent.posAction;
@@ -151,7 +161,7 @@ SampleTouskiInstrument::Zone SampleTouskiInstrument::makeZoneFromObject(const ju
     juce::File f(rawPath);
     if (!juce::File::isAbsolutePath(rawPath)) f = baseDir.getChildFile(rawPath);
     z.samplePath = f.getFullPathName();
-    if (loadSampleFn_) z.sample = loadSampleFn_(z.samplePath);
+    if (loadSample) z.sample = loadSample(z.samplePath);
   }
 
   z.posLoopStart = std::max(z.posAction + 0.001f, z.posLoopStart);
@@ -161,24 +171,107 @@ SampleTouskiInstrument::Zone SampleTouskiInstrument::makeZoneFromObject(const ju
   return z;
 }
 
-const SampleTouskiInstrument::Zone* SampleTouskiInstrument::findBestZone(const ProgramState& state, int midiNote) const {
-  const Zone* best = nullptr;
-  int bestDist = std::numeric_limits<int>::max();
+// The loop a voice of this zone would request, in frames: the same clamping as buildVoiceOn
+// and SampleTouskiRuntime, plus the search radius and crossfade at the current sample rate.
+sls::sampler::LoopSpec SampleTouskiInstrument::makeLoopSpec(const Zone& zone) const {
+  sls::sampler::LoopSpec spec;
+  const int total = zone.sample ? zone.sample->getNumLoadedFrames() : 0;
+  if (total <= 1) return spec;
+
+  spec.start = juce::jlimit(0, total - 1, (int) std::floor((double) zone.posAction * total));
+  spec.loopStart = juce::jlimit(spec.start, total - 1, (int) std::floor((double) zone.posLoopStart * total));
+  spec.loopEnd = juce::jlimit(spec.loopStart + 1, total, (int) std::ceil((double) zone.posLoopEnd * total));
+  spec.releaseEnd = juce::jlimit(spec.loopEnd, total, (int) std::ceil((double) zone.posRelease * total));
+  spec.searchRadius = std::max(0, (int) std::llround(sampleRate_ * (zone.zeroCrossSearchMs * 0.001f)));
+  spec.crossfade = std::max(8, (int) std::llround(sampleRate_ * (zone.loopCrossfadeMs * 0.001f)));
+  return spec;
+}
+
+// The voice every note of this zone starts from; buildVoiceOn only adds the note, channel,
+// rate and gain.
+SampleTouskiInstrument::VoiceSpec SampleTouskiInstrument::makeZoneVoice(const ProgramState& state, const Zone& zone) const {
+  VoiceSpec v;
+  v.valid = zone.samplePath.isNotEmpty();
+  v.rootMidi = zone.rootMidi;
+  v.sample = zone.sample;
+
+  v.posAction = zone.posAction;
+  v.posLoopStart = zone.posLoopStart;
+  v.posLoopEnd = zone.posLoopEnd;
+  v.posRelease = zone.posRelease;
+
+  v.loopEnabled = state.holdLoopOnNoteOff && zone.loopEnabled;
+  v.useGranularHold = v.loopEnabled && wantsGranularPitchEngine(state.params.pitchEngine);
+  v.releasing = false;
+
+  v.fadeInSamples = std::max(0, (int) std::llround(sampleRate_ * (zone.fadeInMs * 0.001f)));
+  v.fadeInTotal = std::max(16, v.fadeInSamples);
+  v.fadeInRemaining = v.fadeInTotal;
+  v.loopCrossfadeSamples = std::max(8, (int) std::llround(sampleRate_ * (zone.loopCrossfadeMs * 0.001f)));
+  v.releaseTailSamples = std::max(0, (int) std::llround(sampleRate_ * (zone.releaseTailMs * 0.001f)));
+  v.zeroCrossSearchSamples = std::max(0, (int) std::llround(sampleRate_ * (zone.zeroCrossSearchMs * 0.001f)));
+  v.grainSizeSamples = std::max(64, (int) std::llround(sampleRate_ * (zone.grainSizeMs * 0.001f)));
+  v.grainHopSamples = std::max(16, (int) std::llround((double) v.grainSizeSamples * (1.0 - (double) zone.grainOverlap)));
+  v.grainJitterSamples = std::max(0, (int) std::llround(sampleRate_ * (zone.grainJitterMs * 0.001f)));
+  v.seamDiffuse = clamp01(zone.seamDiffuse);
+
+  const int total = zone.sample ? zone.sample->getNumLoadedFrames() : 0;
+  if (total > 1) {
+    v.start = juce::jlimit(0, std::max(0, total - 1), (int) std::floor((double) zone.posAction * total));
+    v.loopStart = juce::jlimit(0, std::max(0, total - 1), (int) std::floor((double) zone.posLoopStart * total));
+    v.loopEnd = juce::jlimit(v.loopStart + 1, std::max(v.loopStart + 1, total), (int) std::ceil((double) zone.posLoopEnd * total));
+    v.releaseEnd = juce::jlimit(v.loopEnd, std::max(v.loopEnd, total), (int) std::ceil((double) zone.posRelease * total));
+    v.end = std::max(v.loopEnd, v.releaseEnd);
+
+    if (v.loopEnabled && zone.loop.valid && zone.loop.spec == makeLoopSpec(zone)) {
+      v.loopStart = zone.loop.loopStart;
+      v.loopEnd = zone.loop.loopEnd;
+      v.releaseEnd = std::max(v.releaseEnd, v.loopEnd);
+      v.end = std::max(v.loopEnd, v.releaseEnd);
+      v.loopAnalysed = true;
+    }
+  }
+  return v;
+}
+
+// Rebuilds the prepared voices and the key map. Each note takes the zone with the nearest
+// root (the lower one on a tie) among the zones that have a sample.
+void SampleTouskiInstrument::compileProgram(ProgramState& state) const {
+  state.holdLoopOnNoteOff = state.params.smartPlaybackMode.equalsIgnoreCase("hold_loop_then_release");
 
+  std::vector<const Zone*> ordered;
+  ordered.reserve(state.zones.size());
   for (const auto& kv : state.zones) {
-    if (!kv.second.sample && kv.second.samplePath.isEmpty()) continue;
-    const int dist = std::abs(kv.first - midiNote);
-    if (dist < bestDist) {
-      bestDist = dist;
-      best = &kv.second;
+    if (kv.second.sample || kv.second.samplePath.isNotEmpty())
+      ordered.push_back(&kv.second);
+  }
+  std::sort(ordered.begin(), ordered.end(), [](const Zone* a, const Zone* b) { return a->rootMidi < b->rootMidi; });
+
+  state.zoneVoices.clear();
+  state.zoneVoices.reserve(ordered.size());
+  for (const auto* z : ordered)
+    state.zoneVoices.push_back(makeZoneVoice(state, *z));
+
+  for (int note = 0; note < (int) state.keyMap.size(); ++note) {
+    auto& entry = state.keyMap[(size_t) note];
+    entry = {};
+    int bestDist = std::numeric_limits<int>::max();
+    for (int i = 0; i < (int) ordered.size(); ++i) {
+      const int dist = std::abs(ordered[(size_t) i]->rootMidi - note);
+      if (dist < bestDist) {
+        bestDist = dist;
+        entry.zoneVoice = i;
+      }
     }
+    if (entry.zoneVoice >= 0)
+      entry.rateRatio = std::max(0.0001, std::pow(2.0, (double) (note - ordered[(size_t) entry.zoneVoice]->rootMidi) / 12.0));
   }
-  return best;
 }
 
 bool SampleTouskiInstrument::loadProgramFromRootObject(ProgramState& state,
                                                        const juce::DynamicObject* root,
                                                        const juce::File& baseDir,
+                                                       const LoadSampleFn& loadSample,
                                                        juce::String* errorMessage) const {
   if (!root) {
     if (errorMessage) *errorMessage = "Invalid Touski program root";
@@ -195,7 +288,7 @@ bool SampleTouskiInstrument::loadProgramFromRootObject(ProgramState& state,
     for (const auto& item : *vv.getArray()) {
       auto* o = item.getDynamicObject();
       if (!o) continue;
-      auto zone = makeZoneFromObject(o, baseDir, state.params);
+      auto zone = makeZoneFromObject(o, baseDir, state.params, loadSample);
       if (zone.sample || zone.samplePath.isNotEmpty()) state.zones[zone.rootMidi] = std::move(zone);
     }
   };
@@ -206,7 +299,7 @@ bool SampleTouskiInstrument::loadProgramFromRootObject(ProgramState& state,
 
   if (state.zones.empty() && root->hasProperty("sample")) {
     if (auto* so = root->getProperty("sample").getDynamicObject()) {
-      auto zone = makeZoneFromObject(so, baseDir, state.params);
+      auto zone = makeZoneFromObject(so, baseDir, state.params, loadSample);
       zone.rootMidi = state.params.rootMidi;
       if (zone.sample || zone.samplePath.isNotEmpty()) state.zones[zone.rootMidi] = std::move(zone);
     }
@@ -224,6 +317,16 @@ bool SampleTouskiInstrument::loadProgram(const juce::String& instId,
                                          const juce::var& inlineProgramPayload,
                                          juce::String* errorMessage) {
   ProgramState state;
+  if (!prepareProgram(inlineProgramPayload, state, loadSampleFn_, errorMessage)) return false;
+  installProgram(instId, std::move(state));
+  return true;
+}
+
+bool SampleTouskiInstrument::prepareProgram(const juce::var& inlineProgramPayload,
+                                            ProgramState& state,
+                                            const LoadSampleFn& loadSample,
+                                            juce::String* errorMessage) const {
+  state = {};
   state.params.programPath = {};
 
   const auto* payload = inlineProgramPayload.getDynamicObject();
@@ -232,7 +335,7 @@ bool SampleTouskiInstrument::loadProgram(const juce::String& instId,
   normalizeParams(state.params);
 
   if (payload && payload->hasProperty("samples")) {
-    if (!loadProgramFromRootObject(state, payload, juce::File(), errorMessage)) {
+    if (!loadProgramFromRootObject(state, payload, juce::File(), loadSample, errorMessage)) {
       if (state.params.programPath.isEmpty()) return false;
       state.zones.clear();
     }
@@ -252,7 +355,7 @@ bool SampleTouskiInstrument::loadProgram(const juce::String& instId,
       return false;
     }
 
-    if (!loadProgramFromRootObject(state, root, f.getParentDirectory(), errorMessage))
+    if (!loadProgramFromRootObject(state, root, f.getParentDirectory(), loadSample, errorMessage))
       return false;
   }
 
@@ -261,10 +364,67 @@ bool SampleTouskiInstrument::loadProgram(const juce::String& instId,
     return false;
   }
 
-  programs_[instId] = std::move(state);
+  compileProgram(state);
   return true;
 }
 
+std::shared_ptr<const SampleTouskiInstrument::ProgramState> SampleTouskiInstrument::installProgram(const juce::String& instId,
+                                                                                                   ProgramState state) {
+  auto& installed = programs_[instId];
+  auto replaced = std::move(installed);
+  installed = std::make_shared<const ProgramState>(std::move(state));
+  return replaced;
+}
+
+void SampleTouskiInstrument::analyseLoops(ProgramState& state, const LoopAnalyseFn& analyse) const {
+  if (!analyse) return;
+  for (auto& kv : state.zones) {
+    auto& z = kv.second;
+    if (!z.loopEnabled || !z.sample) continue;
+    const auto spec = makeLoopSpec(z);
+    if (!z.loop.valid || z.loop.spec != spec)
+      z.loop = analyse(z.sample, spec);
+  }
+  compileProgram(state);
+}
+
+void SampleTouskiInstrument::adoptLoopPoints(const juce::String& instId, const ProgramState& analysed) {
+  auto it = programs_.find(instId);
+  if (it == programs_.end()) return;
+
+  auto state = std::make_shared<ProgramState>(*it->second);
+  for (auto& kv : state->zones) {
+    auto src = analysed.zones.find(kv.first);
+    if (src == analysed.zones.end() || !src->second.loop.valid) continue;
+    auto& z = kv.second;
+    if (z.sample == src->second.sample && makeLoopSpec(z) == src->second.loop.spec)
+      z.loop = src->second.loop;
+  }
+  compileProgram(*state);
+  it->second = std::move(state);
+}
+
+std::vector<juce::String> SampleTouskiInstrument::replaceSamples(const RemapSampleFn& remap) {
+  std::vector<juce::String> changed;
+  if (!remap) return changed;
+
+  for (auto& kv : programs_) {
+    std::shared_ptr<ProgramState> state;
+    for (const auto& z : kv.second->zones) {
+      if (!z.second.sample) continue;
+      if (auto replacement = remap(z.second.sample)) {
+        if (!state) state = std::make_shared<ProgramState>(*kv.second);
+        state->zones[z.first].sample = std::move(replacement);
+      }
+    }
+    if (!state) continue;
+    compileProgram(*state);
+    kv.second = std::move(state);
+    changed.push_back(kv.first);
+  }
+  return changed;
+}
+
 bool SampleTouskiInstrument::setParams(const juce::String& instId,
                                        const juce::var& paramsPayload,
                                        juce::String* errorMessage) {
@@ -274,10 +434,12 @@ bool SampleTouskiInstrument::setParams(const juce::String& instId,
     return false;
   }
 
-  auto& state = it->second;
   auto* requestObj = paramsPayload.getDynamicObject();
   if (!requestObj) return true;
 
+  auto updated = std::make_shared<ProgramState>(*it->second);
+  auto& state = *updated;
+
   auto* pp = requestObj;
   if (requestObj->hasProperty("params")) {
     if (auto* nested = requestObj->getProperty("params").getDynamicObject())
@@ -310,6 +472,8 @@ bool SampleTouskiInstrument::setParams(const juce::String& instId,
     z.loopEnabled = z.posLoopEnd > z.posLoopStart;
   }
 
+  compileProgram(state);
+  it->second = std::move(updated);
   return true;
 }
 
@@ -319,7 +483,7 @@ bool SampleTouskiInstrument::hasProgram(const juce::String& instId) const {
 
 const SampleTouskiInstrument::ProgramState* SampleTouskiInstrument::getProgram(const juce::String& instId) const {
   auto it = programs_.find(instId);
-  return it != programs_.end() ? &it->second : nullptr;
+  return it != programs_.end() ? it->second.get() : nullptr;
 }
 
 bool SampleTouskiInstrument::buildVoiceOn(const juce::String& instId,
@@ -333,54 +497,29 @@ bool SampleTouskiInstrument::buildVoiceOn(const juce::String& instId,
     if (errorMessage) *errorMessage = "Touski program not loaded";
     return false;
   }
+  return buildVoiceOn(*state, instId, mixCh, note, velocity, outVoice, errorMessage);
+}
 
-  const auto* zone = findBestZone(*state, note);
-  if (!zone || zone->samplePath.isEmpty()) {
+bool SampleTouskiInstrument::buildVoiceOn(const ProgramState& state,
+                                          const juce::String& instId,
+                                          int mixCh,
+                                          int note,
+                                          float velocity,
+                                          VoiceSpec& outVoice,
+                                          juce::String* errorMessage) {
+  const int key = juce::jlimit(0, (int) state.keyMap.size() - 1, note);
+  const auto& entry = state.keyMap[(size_t) key];
+  if (entry.zoneVoice < 0 || !state.zoneVoices[(size_t) entry.zoneVoice].valid) {
     if (errorMessage) *errorMessage = "No sample for note";
     return false;
   }
 
-  outVoice = {};
-  outVoice.valid = true;
-  outVoice.instId = instId;
-  outVoice.smartPlaybackMode = state->params.smartPlaybackMode;
-  outVoice.pitchEngine = state->params.pitchEngine;
+  outVoice = state.zoneVoices[(size_t) entry.zoneVoice];
+  outVoice.instKey = instKeyFor(instId);
   outVoice.note = note;
   outVoice.mixCh = juce::jmax(1, mixCh);
-  outVoice.samplePath = zone->samplePath;
-  outVoice.rootMidi = zone->rootMidi;
-  outVoice.sample = zone->sample;
-
-  outVoice.posAction = zone->posAction;
-  outVoice.posLoopStart = zone->posLoopStart;
-  outVoice.posLoopEnd = zone->posLoopEnd;
-  outVoice.posRelease = zone->posRelease;
-
-  outVoice.loopEnabled = state->params.smartPlaybackMode.equalsIgnoreCase("hold_loop_then_release") && zone->loopEnabled;
-  outVoice.useGranularHold = outVoice.loopEnabled && wantsGranularPitchEngine(state->params.pitchEngine);
-  outVoice.releasing = false;
-
-  outVoice.fadeInSamples = std::max(0, (int) std::llround(sampleRate_ * (zone->fadeInMs * 0.001f)));
-  outVoice.fadeInTotal = std::max(16, outVoice.fadeInSamples);
-  outVoice.fadeInRemaining = outVoice.fadeInTotal;
-  outVoice.loopCrossfadeSamples = std::max(8, (int) std::llround(sampleRate_ * (zone->loopCrossfadeMs * 0.001f)));
-  outVoice.releaseTailSamples = std::max(0, (int) std::llround(sampleRate_ * (zone->releaseTailMs * 0.001f)));
-  outVoice.zeroCrossSearchSamples = std::max(0, (int) std::llround(sampleRate_ * (zone->zeroCrossSearchMs * 0.001f)));
-  outVoice.grainSizeSamples = std::max(64, (int) std::llround(sampleRate_ * (zone->grainSizeMs * 0.001f)));
-  outVoice.grainHopSamples = std::max(16, (int) std::llround((double) outVoice.grainSizeSamples * (1.0 - (double) zone->grainOverlap)));
-  outVoice.grainJitterSamples = std::max(0, (int) std::llround(sampleRate_ * (zone->grainJitterMs * 0.001f)));
-  outVoice.seamDiffuse = clamp01(zone->seamDiffuse);
-
-  outVoice.rateRatio = std::max(0.0001, std::pow(2.0, (double) (note - zone->rootMidi) / 12.0));
-
-  const int total = zone->sample ? zone->sample->buffer.getNumSamples() : 0;
-  if (total > 1) {
-    outVoice.start = juce::jlimit(0, std::max(0, total - 1), (int) std::floor((double) zone->posAction * total));
-    outVoice.loopStart = juce::jlimit(0, std::max(0, total - 1), (int) std::floor((double) zone->posLoopStart * total));
-    outVoice.loopEnd = juce::jlimit(outVoice.loopStart + 1, std::max(outVoice.loopStart + 1, total), (int) std::ceil((double) zone->posLoopEnd * total));
-    outVoice.releaseEnd = juce::jlimit(outVoice.loopEnd, std::max(outVoice.loopEnd, total), (int) std::ceil((double) zone->posRelease * total));
-    outVoice.end = std::max(outVoice.loopEnd, outVoice.releaseEnd);
-  }
+  outVoice.rateRatio = (key == note) ? entry.rateRatio
+                                     : std::max(0.0001, std::pow(2.0, (double) (note - outVoice.rootMidi) / 12.0));
 
   const float vel = (float) juce::jlimit(0.0, 1.0, (double) velocity);
   outVoice.gainL = vel;
@@ -393,11 +532,12 @@ bool SampleTouskiInstrument::applyNoteOff(const juce::String& instId,
                                           int note,
                                           std::vector<VoiceSpec*>& activeVoices) const {
   const bool holdLoopThenRelease = shouldHoldLoopOnNoteOff(instId);
+  const auto instKey = instKeyFor(instId);
 
   bool changed = false;
   for (auto* v : activeVoices) {
     if (!v || !v->valid) continue;
-    if (v->instId != instId || v->mixCh != mixCh || v->note != note) continue;
+    if (v->instKey != instKey || v->mixCh != mixCh || v->note != note) continue;
     v->releasing = true;
     if (holdLoopThenRelease)
       v->loopEnabled = false;
@@ -410,7 +550,7 @@ bool SampleTouskiInstrument::applyNoteOff(const juce::String& instId,
 
 bool SampleTouskiInstrument::shouldHoldLoopOnNoteOff(const juce::String& instId) const {
   const auto* state = getProgram(instId);
-  return state && state->params.smartPlaybackMode.equalsIgnoreCase("hold_loop_then_release");
+  return state && state->holdLoopOnNoteOff;
 }
 
 void SampleTouskiInstrument::clearProgram(const juce::String& instId) {
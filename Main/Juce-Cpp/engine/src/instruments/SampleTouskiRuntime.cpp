@@ -14,7 +14,7 @@ inline double wrapLoopPositionShared(double pos, int loopStart, int loopEnd) noe
   return pos;
 }
 
-inline float hermiteSampleShared(const juce::AudioBuffer<float>& b, int ch, double pos) noexcept {
+inline float hermiteSampleShared(const sls::sampler::SampleFrames& b, int ch, double pos) noexcept {
   const int n = b.getNumSamples();
   if (n <= 0) return 0.0f;
 
@@ -38,6 +38,33 @@ inline float hermiteSampleShared(const juce::AudioBuffer<float>& b, int ch, doub
   return ((c3 * t + c2) * t + c1) * t + c0;
 }
 
+// hermiteSampleShared for a position with x[-1] .. x[2] inside the buffer (float or int16 frames).
+template <typename T>
+inline float hermiteInterior(const T* x, float t) noexcept {
+  const float y0 = sls::sampler::sampleValue(x[-1]);
+  const float y1 = sls::sampler::sampleValue(x[0]);
+  const float y2 = sls::sampler::sampleValue(x[1]);
+  const float y3 = sls::sampler::sampleValue(x[2]);
+  const float c1 = 0.5f * (y2 - y0);
+  const float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+  const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+  return ((c3 * t + c2) * t + c1) * t + y1;
+}
+
+// Adds count frames of one grain run lying wholly inside the buffer: no clamping.
+template <typename T>
+inline void mixGrainInterior(const T* srcL, const T* srcR, const GranularHoldEngine::Grain& grain,
+                             const float* window, float* sumL, float* sumR, float* norm, int count) noexcept {
+  for (int i = 0; i < count; ++i) {
+    const double readPos = grain.sourceStart + (double) (grain.age + i) * grain.step;
+    const int i1 = (int) readPos;
+    const float t = (float) (readPos - (double) i1);
+    sumL[i] += hermiteInterior(srcL + i1, t) * window[i];
+    sumR[i] += hermiteInterior(srcR + i1, t) * window[i];
+    norm[i] += window[i];
+  }
+}
+
 inline float equalPowerFadeInShared(double t) noexcept {
   t = juce::jlimit(0.0, 1.0, t);
   return std::sin((float) t * (kPiF * 0.5f));
@@ -48,89 +75,7 @@ inline float equalPowerFadeOutShared(double t) noexcept {
   return std::cos((float) t * (kPiF * 0.5f));
 }
 
-inline double seamErrorShared(const juce::AudioBuffer<float>& buffer,
-                              int loopStart,
-                              int loopEnd,
-                              int window) noexcept {
-  const int channels = std::max(1, std::min(2, buffer.getNumChannels()));
-  window = std::max(4, window);
-  if (loopEnd - loopStart <= window + 2)
-    return std::numeric_limits<double>::max();
-
-  const int stride = (window > 1024) ? 4 : (window > 384 ? 2 : 1);
-  double err = 0.0;
-  int count = 0;
-
-  for (int ch = 0; ch < channels; ++ch) {
-    const auto* rd = buffer.getReadPointer(ch);
-    for (int i = 0; i < window; i += stride) {
-      const float tail = rd[loopEnd - window + i];
-      const float head = rd[loopStart + i];
-      const double d = (double) tail - (double) head;
-      err += d * d;
-      ++count;
-    }
-
-    const float endA = rd[loopEnd - 2];
-    const float endB = rd[loopEnd - 1];
-    const float startA = rd[loopStart];
-    const float startB = rd[loopStart + 1];
-    const double amp = (double) endB - (double) startA;
-    const double slope = ((double) endB - (double) endA) - ((double) startB - (double) startA);
-    err += amp * amp * 4.0;
-    err += slope * slope * 2.0;
-  }
-
-  return err / (double) std::max(1, count);
-}
-
-inline int refineLoopStartForEnd(const juce::AudioBuffer<float>& buffer,
-                                 int targetStart,
-                                 int loopEnd,
-                                 int searchRadius,
-                                 int window,
-                                 int minBound,
-                                 int maxBound) noexcept {
-  int best = juce::jlimit(minBound, maxBound, targetStart);
-  double bestScore = seamErrorShared(buffer, best, loopEnd, window);
-
-  const int lo = juce::jlimit(minBound, maxBound, targetStart - searchRadius);
-  const int hi = juce::jlimit(minBound, maxBound, targetStart + searchRadius);
-  for (int start = lo; start <= hi; ++start) {
-    if (loopEnd - start <= window + 2) continue;
-    const double score = seamErrorShared(buffer, start, loopEnd, window);
-    if (score < bestScore) {
-      bestScore = score;
-      best = start;
-    }
-  }
-  return best;
-}
-
-inline int refineLoopEndForStart(const juce::AudioBuffer<float>& buffer,
-                                 int loopStart,
-                                 int targetEnd,
-                                 int searchRadius,
-                                 int window,
-                                 int minBound,
-                                 int maxBound) noexcept {
-  int best = juce::jlimit(minBound, maxBound, targetEnd);
-  double bestScore = seamErrorShared(buffer, loopStart, best, window);
-
-  const int lo = juce::jlimit(minBound, maxBound, targetEnd - searchRadius);
-  const int hi = juce::jlimit(minBound, maxBound, targetEnd + searchRadius);
-  for (int end = lo; end <= hi; ++end) {
-    if (end - loopStart <= window + 2) continue;
-    const double score = seamErrorShared(buffer, loopStart, end, window);
-    if (score < bestScore) {
-      bestScore = score;
-      best = end;
-    }
-  }
-  return best;
-}
-
-inline float sampleLoopedSeamless(const juce::AudioBuffer<float>& buffer,
+inline float sampleLoopedSeamless(const sls::sampler::SampleFrames& buffer,
                                   int channel,
                                   double pos,
                                   int loopStart,
@@ -164,7 +109,7 @@ inline int clampLoopInteriorShared(int pos, int loopStart, int loopEnd, int guar
   return juce::jlimit(minPos, maxPos, pos);
 }
 
-inline double grainEntryCostShared(const juce::AudioBuffer<float>& buffer,
+inline double grainEntryCostShared(const sls::sampler::SampleFrames& buffer,
                                    int pos,
                                    int loopStart,
                                    int loopEnd) noexcept {
@@ -237,7 +182,7 @@ int ResampleHoldEngine::currentSourceIndex(const State& state) noexcept {
   return (int) std::floor(state.pos);
 }
 
-float ResampleHoldEngine::sampleAtHermite(const juce::AudioBuffer<float>& b, int ch, double pos) noexcept {
+float ResampleHoldEngine::sampleAtHermite(const sls::sampler::SampleFrames& b, int ch, double pos) noexcept {
   return hermiteSampleShared(b, ch, pos);
 }
 
@@ -254,7 +199,7 @@ float ResampleHoldEngine::hannFadeOut(double t) noexcept {
 }
 
 ResampleHoldEngine::RenderResult ResampleHoldEngine::renderFrame(const State& state,
-                                                                 const juce::AudioBuffer<float>& buffer) noexcept {
+                                                                 const sls::sampler::SampleFrames& buffer) noexcept {
   RenderResult rr;
 
   if (buffer.getNumSamples() <= 1 || state.pos >= (double) state.end || state.pos >= (double) (buffer.getNumSamples() - 1)) {
@@ -292,6 +237,7 @@ void GranularHoldEngine::initialise(State& state,
                                     int crossfadeSamples,
                                     int jitterSamples,
                                     float seamDiffuse,
+                                    const sls::sampler::PitchMarks* pitchMarks,
                                     std::uint32_t seed) noexcept {
   state.prepared = true;
   state.pitchRatio = std::max(0.125, pitchRatio);
@@ -317,6 +263,7 @@ void GranularHoldEngine::initialise(State& state,
   state.crossfadeSamples = std::max(0, crossfadeSamples);
   state.jitterSamples = std::max(0, jitterSamples);
   state.seamDiffuse = juce::jlimit(0.0f, 1.0f, seamDiffuse);
+  state.pitchMarks = pitchMarks;
   state.rngState = (seed != 0u) ? seed : 0x9e3779b9u;
 
   for (auto& grain : state.grains)
@@ -331,7 +278,7 @@ int GranularHoldEngine::currentSourceIndex(const State& state) noexcept {
   return (int) std::floor(state.nextSourceStart);
 }
 
-float GranularHoldEngine::sampleAtHermite(const juce::AudioBuffer<float>& b, int ch, double pos) noexcept {
+float GranularHoldEngine::sampleAtHermite(const sls::sampler::SampleFrames& b, int ch, double pos) noexcept {
   return hermiteSampleShared(b, ch, pos);
 }
 
@@ -339,10 +286,24 @@ double GranularHoldEngine::wrapLoopPosition(double pos, int loopStart, int loopE
   return wrapLoopPositionShared(pos, loopStart, loopEnd);
 }
 
-float GranularHoldEngine::hannWindow(int age, int duration) noexcept {
-  if (duration <= 1) return 1.0f;
-  const float t = (float) age / (float) std::max(1, duration - 1);
-  return 0.5f - 0.5f * std::cos(t * kPiF);
+// dest[i] = Hann window at age firstAge + i. The cosine is stepped by rotation (in double,
+// restarted every call) instead of being evaluated per frame.
+void GranularHoldEngine::hannWindow(float* dest, int firstAge, int duration, int numFrames) noexcept {
+  if (duration <= 1) {
+    std::fill(dest, dest + numFrames, 1.0f);
+    return;
+  }
+  const double delta = (double) kPiF / (double) (duration - 1);
+  const double rotCos = std::cos(delta);
+  const double rotSin = std::sin(delta);
+  double c = std::cos(delta * (double) firstAge);
+  double sn = std::sin(delta * (double) firstAge);
+  for (int i = 0; i < numFrames; ++i) {
+    dest[i] = (float) (0.5 - 0.5 * c);
+    const double nc = c * rotCos - sn * rotSin;
+    sn = sn * rotCos + c * rotSin;
+    c = nc;
+  }
 }
 
 float GranularHoldEngine::nextRandomSigned(State& state) noexcept {
@@ -356,7 +317,7 @@ float GranularHoldEngine::nextRandomSigned(State& state) noexcept {
 }
 
 int GranularHoldEngine::chooseGrainStart(const State& state,
-                                         const juce::AudioBuffer<float>& buffer,
+                                         const sls::sampler::SampleFrames& buffer,
                                          int predictedStart) noexcept {
   const int loopLen = std::max(8, state.loopEnd - state.loopStart);
   const int guard = std::min(std::max(2, state.crossfadeSamples / 2), std::max(2, loopLen / 8));
@@ -372,6 +333,27 @@ int GranularHoldEngine::chooseGrainStart(const State& state,
 
   const int lo = juce::jlimit(minStart, maxStart, center - maxRadius);
   const int hi = juce::jlimit(minStart, maxStart, center + maxRadius);
+  const double proximityWeight = 1.0 - 0.65 * (double) state.seamDiffuse;
+
+  // Analysed samples: only the pitch marks in range are candidates, scored from the table.
+  if (state.pitchMarks != nullptr) {
+    const auto& marks = state.pitchMarks->getMarks();
+    int best = center;
+    double bestCost = std::numeric_limits<double>::max();
+    const int first = state.pitchMarks->firstAtOrAfter(lo);
+    const int last = std::min((int) marks.size(), first + kMaxMarkCandidates);
+    for (int i = first; i < last && marks[(size_t) i].pos <= hi; ++i) {
+      const auto& mark = marks[(size_t) i];
+      const double proximity = (double) std::abs(mark.pos - center) / (double) std::max(1, maxRadius);
+      const double score = (double) mark.cost + proximity * proximityWeight;
+      if (score < bestCost) {
+        bestCost = score;
+        best = mark.pos;
+      }
+    }
+    return best;
+  }
+
   const int stride = (maxRadius > 96) ? 4 : (maxRadius > 32 ? 2 : 1);
 
   int best = center;
@@ -379,7 +361,7 @@ int GranularHoldEngine::chooseGrainStart(const State& state,
   for (int pos = lo; pos <= hi; pos += stride) {
     const double localCost = grainEntryCostShared(buffer, pos, state.loopStart, state.loopEnd);
     const double proximity = (double) std::abs(pos - center) / (double) std::max(1, maxRadius);
-    const double score = localCost + proximity * (1.0 - 0.65 * (double) state.seamDiffuse);
+    const double score = localCost + proximity * proximityWeight;
     if (score < bestCost) {
       bestCost = score;
       best = pos;
@@ -388,7 +370,7 @@ int GranularHoldEngine::chooseGrainStart(const State& state,
   return best;
 }
 
-void GranularHoldEngine::spawnGrain(State& state, const juce::AudioBuffer<float>& buffer) noexcept {
+void GranularHoldEngine::spawnGrain(State& state, const sls::sampler::SampleFrames& buffer) noexcept {
   const int loopLen = std::max(8, state.loopEnd - state.loopStart);
   const int guard = std::min(std::max(2, state.crossfadeSamples / 2), std::max(2, loopLen / 8));
   const int jitterRadius = std::max(0, std::min({ state.jitterSamples, std::max(0, loopLen / 6), std::max(0, state.grainLength / 4) }));
@@ -439,53 +421,87 @@ void GranularHoldEngine::spawnGrain(State& state, const juce::AudioBuffer<float>
   }
 }
 
-GranularHoldEngine::StereoFrame GranularHoldEngine::renderFrame(State& state,
-                                                                const juce::AudioBuffer<float>& buffer) noexcept {
-  StereoFrame out;
-  if (!state.prepared || buffer.getNumSamples() <= 1 || state.loopEnd <= state.loopStart)
-    return out;
-
-  if (state.samplesUntilSpawn <= 0) {
-    spawnGrain(state, buffer);
-    state.samplesUntilSpawn = state.hopSamples;
-  }
-  --state.samplesUntilSpawn;
-
+// Grains are mixed one at a time over the whole run: window, read positions and sums are
+// straight loops over the frames instead of a pass over the grain array per frame.
+void GranularHoldEngine::mixGrains(State& state,
+                                   const sls::sampler::SampleFrames& buffer,
+                                   float* left,
+                                   float* right,
+                                   int numFrames) noexcept {
+  float sumL[kMixFrames] = {};
+  float sumR[kMixFrames] = {};
+  float norm[kMixFrames] = {};
+  float window[kMixFrames];
   const int rch = (buffer.getNumChannels() > 1) ? 1 : 0;
-  float sumL = 0.0f;
-  float sumR = 0.0f;
-  float norm = 0.0f;
 
   for (auto& grain : state.grains) {
     if (!grain.active) continue;
 
-    const double readPos = grain.sourceStart + (double) grain.age * grain.step;
-    if (readPos >= grain.sourceEnd) {
-      grain.active = false;
-      continue;
-    }
+    // A grain sounds while age < duration and its read position is short of sourceEnd.
+    int count = 0;
+    while (count < numFrames && grain.age + count < grain.duration
+           && grain.sourceStart + (double) (grain.age + count) * grain.step < grain.sourceEnd)
+      ++count;
 
-    const float w = hannWindow(grain.age, grain.duration);
-    sumL += sampleAtHermite(buffer, 0, readPos) * w;
-    sumR += sampleAtHermite(buffer, rch, readPos) * w;
-    norm += w;
+    hannWindow(window, grain.age, grain.duration, count);
+    const double firstPos = grain.sourceStart + (double) grain.age * grain.step;
+    const double lastPos = grain.sourceStart + (double) (grain.age + count - 1) * grain.step;
+    if (count > 0 && firstPos >= 1.0 && lastPos < (double) (buffer.getNumSamples() - 3)) {
+      // Whole run inside the buffer: 4-point reads need no clamping.
+      if (const auto* pcmL = buffer.getCompactChannel(0))
+        mixGrainInterior(pcmL, buffer.getCompactChannel(rch), grain, window, sumL, sumR, norm, count);
+      else
+        mixGrainInterior(buffer.getFloatChannel(0), buffer.getFloatChannel(rch), grain, window, sumL, sumR, norm, count);
+    } else {
+      for (int i = 0; i < count; ++i) {
+        const double readPos = grain.sourceStart + (double) (grain.age + i) * grain.step;
+        sumL[i] += sampleAtHermite(buffer, 0, readPos) * window[i];
+        sumR[i] += sampleAtHermite(buffer, rch, readPos) * window[i];
+        norm[i] += window[i];
+      }
+    }
 
-    ++grain.age;
-    if (grain.age >= grain.duration)
+    grain.age += count;
+    if (count < numFrames || grain.age >= grain.duration)
       grain.active = false;
   }
 
-  if (norm > 0.0001f) {
-    out.left = sumL / norm;
-    out.right = sumR / norm;
+  for (int i = 0; i < numFrames; ++i) {
+    const bool audible = norm[i] > 0.0001f;
+    left[i] = audible ? sumL[i] / norm[i] : 0.0f;
+    right[i] = audible ? sumR[i] / norm[i] : 0.0f;
+  }
+}
+
+void GranularHoldEngine::renderBlock(State& state,
+                                     const sls::sampler::SampleFrames& buffer,
+                                     float* left,
+                                     float* right,
+                                     int numFrames) noexcept {
+  if (!state.prepared || buffer.getNumSamples() <= 1 || state.loopEnd <= state.loopStart) {
+    std::fill(left, left + numFrames, 0.0f);
+    std::fill(right, right + numFrames, 0.0f);
+    return;
+  }
+
+  int done = 0;
+  while (done < numFrames) {
+    if (state.samplesUntilSpawn <= 0) {
+      spawnGrain(state, buffer);
+      state.samplesUntilSpawn = state.hopSamples;
+    }
+    const int n = std::min({ numFrames - done, state.samplesUntilSpawn, kMixFrames });
+    mixGrains(state, buffer, left + done, right + done, n);
+    state.samplesUntilSpawn -= n;
+    done += n;
   }
-  return out;
 }
 
 // ------------------------------ SampleTouskiRuntime ------------------------------
 
 SampleTouskiRuntime::SampleTouskiRuntime(int maxVoices)
-    : maxVoices_(juce::jmax(1, maxVoices)) {}
+    : voices_((size_t) juce::jmax(1, maxVoices)),
+      maxVoices_(juce::jmax(1, maxVoices)) {}
 
 void SampleTouskiRuntime::setSampleRate(double sr) noexcept {
   sampleRate_ = std::max(1.0, sr);
@@ -497,8 +513,7 @@ double SampleTouskiRuntime::getSampleRate() const noexcept {
 
 void SampleTouskiRuntime::setMaxVoices(int maxVoices) {
   maxVoices_ = juce::jmax(1, maxVoices);
-  if ((int) voices_.size() > maxVoices_)
-    voices_.resize((size_t) maxVoices_);
+  voices_.resize((size_t) maxVoices_);
 }
 
 int SampleTouskiRuntime::getMaxVoices() const noexcept {
@@ -517,7 +532,8 @@ int SampleTouskiRuntime::getNumActiveVoices() const noexcept {
 }
 
 void SampleTouskiRuntime::clear() {
-  voices_.clear();
+  for (auto& voice : voices_)
+    voice = {};
 }
 
 void SampleTouskiRuntime::stopAll() noexcept {
@@ -525,45 +541,9 @@ void SampleTouskiRuntime::stopAll() noexcept {
     voice.active = false;
 }
 
-int SampleTouskiRuntime::snapToNearestZeroCrossing(const juce::AudioBuffer<float>& buffer,
-                                                   int target,
-                                                   int searchRadius,
-                                                   int minBound,
-                                                   int maxBound) noexcept {
-  const int n = buffer.getNumSamples();
-  if (n <= 2) return target;
-
-  minBound = juce::jlimit(0, n - 2, minBound);
-  maxBound = juce::jlimit(minBound + 1, n - 1, maxBound);
-  target = juce::jlimit(minBound, maxBound, target);
-  if (searchRadius <= 0) return target;
-
-  const int lo = juce::jlimit(minBound, maxBound, target - searchRadius);
-  const int hi = juce::jlimit(minBound, maxBound, target + searchRadius);
-  const auto* rd = buffer.getReadPointer(0);
-
-  int best = target;
-  float bestScore = std::numeric_limits<float>::max();
-
-  for (int i = lo; i < hi; ++i) {
-    const float a = rd[i];
-    const float b = rd[i + 1];
-    const bool crosses = ((a <= 0.0f && b >= 0.0f) || (a >= 0.0f && b <= 0.0f));
-    if (!crosses) continue;
-
-    const float score = std::abs(a) + std::abs(b) + 0.0001f * (float) std::abs(i - target);
-    if (score < bestScore) {
-      bestScore = score;
-      best = i;
-    }
-  }
-
-  return best;
-}
-
 bool SampleTouskiRuntime::validateVoiceBoundaries(Voice& voice) noexcept {
   if (!voice.sample) return false;
-  const int total = voice.sample->buffer.getNumSamples();
+  const int total = voice.sample->getNumLoadedFrames();
   if (total <= 1) return false;
 
   voice.start = juce::jlimit(0, total - 1, voice.start);
@@ -586,7 +566,7 @@ bool SampleTouskiRuntime::initialiseVoiceFromSpec(Voice& outVoice,
     return false;
   }
 
-  const int total = spec.sample->buffer.getNumSamples();
+  const int total = spec.sample->getNumLoadedFrames();
   if (total <= 1) {
     if (errorMessage) *errorMessage = "Touski sample buffer empty";
     return false;
@@ -595,7 +575,7 @@ bool SampleTouskiRuntime::initialiseVoiceFromSpec(Voice& outVoice,
   outVoice = {};
   outVoice.active = true;
   outVoice.releasing = spec.releasing;
-  outVoice.instId = spec.instId;
+  outVoice.instKey = spec.instKey;
   outVoice.note = spec.note;
   outVoice.mixCh = juce::jmax(1, spec.mixCh);
   outVoice.sample = spec.sample;
@@ -616,6 +596,8 @@ bool SampleTouskiRuntime::initialiseVoiceFromSpec(Voice& outVoice,
   outVoice.zeroCrossSearchSamples = std::max(0, spec.zeroCrossSearchSamples);
   outVoice.grainSizeSamples = std::max(64, spec.grainSizeSamples);
   outVoice.grainHopSamples = std::max(16, spec.grainHopSamples);
+  outVoice.grainJitterSamples = std::max(0, spec.grainJitterSamples);
+  outVoice.seamDiffuse = juce::jlimit(0.0f, 1.0f, spec.seamDiffuse);
   outVoice.holdMode = spec.useGranularHold ? Voice::HoldMode::Granular : Voice::HoldMode::Resample;
   outVoice.phase = Voice::Phase::Attack;
 
@@ -624,45 +606,6 @@ bool SampleTouskiRuntime::initialiseVoiceFromSpec(Voice& outVoice,
     return false;
   }
 
-  if (spec.loopEnabled && outVoice.zeroCrossSearchSamples > 0) {
-    outVoice.loopStart = snapToNearestZeroCrossing(outVoice.sample->buffer,
-                                                   outVoice.loopStart,
-                                                   outVoice.zeroCrossSearchSamples,
-                                                   outVoice.start,
-                                                   std::max(outVoice.start + 1, outVoice.releaseEnd - 2));
-    outVoice.loopEnd = snapToNearestZeroCrossing(outVoice.sample->buffer,
-                                                 outVoice.loopEnd,
-                                                 outVoice.zeroCrossSearchSamples,
-                                                 std::min(outVoice.loopStart + 2, outVoice.releaseEnd - 1),
-                                                 std::max(outVoice.loopStart + 2, outVoice.releaseEnd - 1));
-    validateVoiceBoundaries(outVoice);
-
-    const int loopLen = std::max(4, outVoice.loopEnd - outVoice.loopStart);
-    const int seamWindow = std::min(std::max(16, outVoice.loopCrossfadeSamples), std::max(16, loopLen - 4));
-    const int seamSearchRadius = std::min(std::max(outVoice.zeroCrossSearchSamples, outVoice.loopCrossfadeSamples / 2), 2048);
-
-    if (seamSearchRadius > 0 && seamWindow >= 16 && loopLen > seamWindow + 2) {
-      const int startMax = std::max(outVoice.start + 1, outVoice.releaseEnd - seamWindow - 3);
-      outVoice.loopStart = refineLoopStartForEnd(outVoice.sample->buffer,
-                                                 outVoice.loopStart,
-                                                 outVoice.loopEnd,
-                                                 seamSearchRadius,
-                                                 seamWindow,
-                                                 outVoice.start,
-                                                 startMax);
-
-      const int endMin = std::min(outVoice.releaseEnd - 1, outVoice.loopStart + seamWindow + 2);
-      outVoice.loopEnd = refineLoopEndForStart(outVoice.sample->buffer,
-                                               outVoice.loopStart,
-                                               outVoice.loopEnd,
-                                               seamSearchRadius,
-                                               seamWindow,
-                                               endMin,
-                                               outVoice.releaseEnd - 1);
-      validateVoiceBoundaries(outVoice);
-    }
-  }
-
   const double playbackRate = std::max(0.0001, spec.rateRatio * (spec.sample->sampleRate / std::max(1.0, sampleRate_)));
   const int attackEnd = spec.loopEnabled ? outVoice.loopStart : outVoice.releaseEnd;
 
@@ -709,6 +652,7 @@ bool SampleTouskiRuntime::initialiseVoiceFromSpec(Voice& outVoice,
                                    outVoice.loopCrossfadeSamples,
                                    outVoice.grainJitterSamples,
                                    outVoice.seamDiffuse,
+                                   spec.sample->pitchMarks.get(),
                                    seed);
   }
 
@@ -727,11 +671,6 @@ bool SampleTouskiRuntime::spawnVoice(const VoiceSpec& spec, juce::String* errorM
     }
   }
 
-  if ((int) voices_.size() < maxVoices_) {
-    voices_.push_back(std::move(voice));
-    return true;
-  }
-
   if (errorMessage) *errorMessage = "No free Touski sample voices";
   return false;
 }
@@ -759,14 +698,14 @@ void SampleTouskiRuntime::beginRelease(Voice& voice) noexcept {
   voice.releaseState.loopEnabled = false;
 }
 
-bool SampleTouskiRuntime::noteOff(const juce::String& instId,
+bool SampleTouskiRuntime::noteOff(juce::int64 instKey,
                                   int mixCh,
                                   int note,
                                   bool /*holdLoopThenRelease*/) {
   bool changed = false;
   for (auto& voice : voices_) {
     if (!voice.active) continue;
-    if (voice.instId != instId || voice.mixCh != mixCh || voice.note != note) continue;
+    if (voice.instKey != instKey || voice.mixCh != mixCh || voice.note != note) continue;
 
     if (!voice.releasing) {
       beginRelease(voice);
@@ -776,94 +715,148 @@ bool SampleTouskiRuntime::noteOff(const juce::String& instId,
   return changed;
 }
 
-void SampleTouskiRuntime::renderNextSample(std::vector<float>& busL, std::vector<float>& busR) noexcept {
-  for (auto& voice : voices_) {
-    if (!voice.active || !voice.sample) continue;
+void SampleTouskiRuntime::renderVoice(int voiceIndex, float* left, float* right, int numFrames) noexcept {
+  if (voiceIndex < 0 || voiceIndex >= (int) voices_.size()) return;
+  auto& voice = voices_[(size_t) voiceIndex];
+  if (voice.active) renderVoice(voice, left, right, numFrames);
+}
 
-    const auto& buffer = voice.sample->buffer;
-    if (buffer.getNumSamples() <= 1) {
-      voice.active = false;
-      continue;
-    }
+// Renders in chunks: the fade gains of a chunk are worked out first, then the voice's
+// phases fill it run by run, then the chunk is mixed into the bus.
+void SampleTouskiRuntime::renderVoice(Voice& voice, float* left, float* right, int numFrames) noexcept {
+  if (!voice.sample || voice.sample->getNumLoadedFrames() <= 1) {
+    voice.active = false;
+    return;
+  }
+  const sls::sampler::SampleFrames buffer(*voice.sample);
 
-    float amp = 1.0f;
-    if (voice.fadeInRemaining > 0 && voice.fadeInTotal > 0) {
-      const int done = voice.fadeInTotal - voice.fadeInRemaining;
-      amp *= (float) done / (float) std::max(1, voice.fadeInTotal);
-      --voice.fadeInRemaining;
-    }
+  float dryL[kRenderChunk];
+  float dryR[kRenderChunk];
+  float amp[kRenderChunk];
 
-    if (voice.releasing && voice.fadeOutRemaining > 0 && voice.fadeOutTotal > 0) {
-      amp *= (float) voice.fadeOutRemaining / (float) std::max(1, voice.fadeOutTotal);
-      --voice.fadeOutRemaining;
-      if (voice.fadeOutRemaining <= 0) {
-        voice.active = false;
-        continue;
-      }
-    }
+  for (int offset = 0; offset < numFrames && voice.active;) {
+    int n = std::min(kRenderChunk, numFrames - offset);
 
-    ResampleHoldEngine::StereoFrame frame;
-
-    if (voice.phase == Voice::Phase::Attack) {
-      const auto rr = ResampleHoldEngine::renderFrame(voice.attackState, buffer);
-      frame.left = rr.frame.left;
-      frame.right = rr.frame.right;
-      ResampleHoldEngine::advance(voice.attackState);
-
-      if (rr.finished || voice.attackState.pos >= (double) voice.attackState.end) {
-        if (voice.releasing || voice.loopEnd <= voice.loopStart) {
-          voice.phase = Voice::Phase::Release;
-          voice.releaseState.pos = std::max((double) voice.start, (double) ResampleHoldEngine::currentSourceIndex(voice.attackState));
-          voice.releaseState.end = std::max(voice.releaseEnd, (int) std::ceil(voice.releaseState.pos) + 1);
-          voice.releaseState.loopEnabled = false;
-        } else {
-          voice.phase = Voice::Phase::Sustain;
-        }
+    bool fadedOut = false;
+    for (int i = 0; i < n; ++i) {
+      float a = 1.0f;
+      if (voice.fadeInRemaining > 0 && voice.fadeInTotal > 0) {
+        a *= (float) (voice.fadeInTotal - voice.fadeInRemaining) / (float) std::max(1, voice.fadeInTotal);
+        --voice.fadeInRemaining;
       }
-    } else if (voice.phase == Voice::Phase::Sustain) {
-      if (voice.holdMode == Voice::HoldMode::Granular) {
-        const auto gf = GranularHoldEngine::renderFrame(voice.granularState, buffer);
-        frame.left = gf.left;
-        frame.right = gf.right;
-      } else {
-        const auto rr = ResampleHoldEngine::renderFrame(voice.sustainState, buffer);
-        frame.left = rr.frame.left;
-        frame.right = rr.frame.right;
-        ResampleHoldEngine::advance(voice.sustainState);
+      if (voice.releasing && voice.fadeOutRemaining > 0 && voice.fadeOutTotal > 0) {
+        a *= (float) voice.fadeOutRemaining / (float) std::max(1, voice.fadeOutTotal);
+        if (--voice.fadeOutRemaining <= 0) {
+          n = i; // this frame is already silent
+          fadedOut = true;
+          break;
+        }
       }
+      amp[i] = a;
+    }
 
-      if (voice.releasing) {
-        beginRelease(voice);
+    int produced = 0;
+    while (produced < n && voice.active) {
+      switch (voice.phase) {
+        case Voice::Phase::Attack:
+          produced += renderAttack(voice, buffer, dryL + produced, dryR + produced, n - produced);
+          break;
+        case Voice::Phase::Sustain:
+          produced += renderSustain(voice, buffer, dryL + produced, dryR + produced, n - produced);
+          break;
+        case Voice::Phase::Release:
+          produced += renderRelease(voice, buffer, dryL + produced, dryR + produced, amp + produced, n - produced);
+          break;
       }
     }
 
-    if (voice.phase == Voice::Phase::Release) {
-      const auto rr = ResampleHoldEngine::renderFrame(voice.releaseState, buffer);
-      frame.left = rr.frame.left;
-      frame.right = rr.frame.right;
+    for (int i = 0; i < produced; ++i) {
+      left[offset + i] += dryL[i] * voice.gainL * amp[i];
+      right[offset + i] += dryR[i] * voice.gainR * amp[i];
+    }
 
-      if (voice.releaseTailSamples > 0) {
-        const double samplesToEnd = (double) voice.releaseState.end - voice.releaseState.pos;
-        if (samplesToEnd <= 0.0) {
-          voice.active = false;
-          continue;
-        }
-        if (samplesToEnd <= (double) voice.releaseTailSamples)
-          amp *= (float) (samplesToEnd / (double) std::max(1, voice.releaseTailSamples));
+    offset += produced;
+    if (fadedOut) voice.active = false;
+  }
+}
+
+// Plays the attack up to the loop (or straight into the release). Returns the frames written;
+// a frame that ends the attack in a release is left for renderRelease.
+int SampleTouskiRuntime::renderAttack(Voice& voice, const sls::sampler::SampleFrames& buffer,
+                                      float* left, float* right, int numFrames) noexcept {
+  for (int i = 0; i < numFrames; ++i) {
+    const auto rr = ResampleHoldEngine::renderFrame(voice.attackState, buffer);
+    ResampleHoldEngine::advance(voice.attackState);
+
+    if (rr.finished || voice.attackState.pos >= (double) voice.attackState.end) {
+      if (voice.releasing || voice.loopEnd <= voice.loopStart) {
+        voice.phase = Voice::Phase::Release;
+        voice.releaseState.pos = std::max((double) voice.start, (double) ResampleHoldEngine::currentSourceIndex(voice.attackState));
+        voice.releaseState.end = std::max(voice.releaseEnd, (int) std::ceil(voice.releaseState.pos) + 1);
+        voice.releaseState.loopEnabled = false;
+        return i;
       }
+      voice.phase = Voice::Phase::Sustain;
+      left[i] = rr.frame.left;
+      right[i] = rr.frame.right;
+      return i + 1;
+    }
 
-      ResampleHoldEngine::advance(voice.releaseState);
-      if (rr.finished || voice.releaseState.pos >= (double) voice.releaseState.end) {
+    left[i] = rr.frame.left;
+    right[i] = rr.frame.right;
+  }
+  return numFrames;
+}
+
+// Holds the loop until the note is released (granular or looped resampling).
+int SampleTouskiRuntime::renderSustain(Voice& voice, const sls::sampler::SampleFrames& buffer,
+                                       float* left, float* right, int numFrames) noexcept {
+  if (voice.releasing) {
+    beginRelease(voice);
+    return 0;
+  }
+
+  if (voice.holdMode == Voice::HoldMode::Granular) {
+    GranularHoldEngine::renderBlock(voice.granularState, buffer, left, right, numFrames);
+    return numFrames;
+  }
+
+  for (int i = 0; i < numFrames; ++i) {
+    const auto rr = ResampleHoldEngine::renderFrame(voice.sustainState, buffer);
+    left[i] = rr.frame.left;
+    right[i] = rr.frame.right;
+    ResampleHoldEngine::advance(voice.sustainState);
+  }
+  return numFrames;
+}
+
+// Plays from the release point to releaseEnd, fading over the last releaseTailSamples.
+// Deactivates the voice at the end; the frame that reaches it stays silent.
+int SampleTouskiRuntime::renderRelease(Voice& voice, const sls::sampler::SampleFrames& buffer,
+                                       float* left, float* right, float* amp, int numFrames) noexcept {
+  for (int i = 0; i < numFrames; ++i) {
+    const auto rr = ResampleHoldEngine::renderFrame(voice.releaseState, buffer);
+
+    if (voice.releaseTailSamples > 0) {
+      const double samplesToEnd = (double) voice.releaseState.end - voice.releaseState.pos;
+      if (samplesToEnd <= 0.0) {
         voice.active = false;
+        return i;
       }
+      if (samplesToEnd <= (double) voice.releaseTailSamples)
+        amp[i] *= (float) (samplesToEnd / (double) std::max(1, voice.releaseTailSamples));
     }
 
-    if (!voice.active) continue;
+    ResampleHoldEngine::advance(voice.releaseState);
+    if (rr.finished || voice.releaseState.pos >= (double) voice.releaseState.end) {
+      voice.active = false;
+      return i;
+    }
 
-    const int idx = juce::jlimit(0, (int) std::max(busL.size(), busR.size()) - 1, voice.mixCh - 1);
-    if (idx < (int) busL.size()) busL[(size_t) idx] += frame.left * voice.gainL * amp;
-    if (idx < (int) busR.size()) busR[(size_t) idx] += frame.right * voice.gainR * amp;
+    left[i] = rr.frame.left;
+    right[i] = rr.frame.right;
   }
+  return numFrames;
 }
 
 } // namespace sls::inst
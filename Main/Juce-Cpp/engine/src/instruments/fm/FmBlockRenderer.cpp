@@ -0,0 +1,193 @@
+#include "instruments/fm/FmBlockRenderer.h"
+#include <algorithm>
+#include "instruments/fm/FmPatchSnapshot.h"
+#include "instruments/fm/FmSine.h"
+#include "instruments/fm/FmVoice.h"
+
+namespace sls::engine::fm {
+
+namespace {
+constexpr int kOperators = static_cast<int>(kMaxFmOperators);
+
+inline float horizontalSum(FmVec4 v) noexcept {
+    float lanes[4];
+    v.store(lanes);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+}
+
+void FmBlockRenderer::prepare(int maxVoices) {
+    capacity_ = (std::max(1, maxVoices) + 3) & ~3;
+    lanes_ = 0;
+    const auto perOperator = static_cast<std::size_t>(capacity_) * kMaxFmOperators;
+    for (auto* array : { &phase_, &increment_, &gain_, &previous_, &runningFrames_ })
+        array->assign(perOperator, 0.0f);
+    lfoPhase_.assign(static_cast<std::size_t>(capacity_), 0.0f);
+    voiceFrames_.assign(static_cast<std::size_t>(capacity_), -1.0f);
+    envelopes_.prepare(kOperators * capacity_, kEnvelopeChunk);
+    envelopeSources_.assign(static_cast<std::size_t>(capacity_), nullptr);
+}
+
+// Lanes past count stay silent: zero gain and increment, no envelope.
+void FmBlockRenderer::gather(FmVoice* const* voices, int count) {
+    lanes_ = (count + 3) & ~3;
+    for (int k = 0; k < kOperators; ++k) {
+        const int base = k * capacity_;
+        for (int lane = 0; lane < lanes_; ++lane) {
+            const std::size_t at = static_cast<std::size_t>(base + lane);
+            if (lane < count) {
+                const auto& op = voices[lane]->operators_[static_cast<std::size_t>(k)];
+                phase_[at] = op.phase_;
+                increment_[at] = op.increment_;
+                gain_[at] = op.gain_;
+                previous_[at] = op.previousSample_;
+            } else {
+                phase_[at] = increment_[at] = gain_[at] = previous_[at] = 0.0f;
+            }
+        }
+    }
+    for (int lane = 0; lane < lanes_; ++lane)
+        lfoPhase_[static_cast<std::size_t>(lane)] = lane < count ? voices[lane]->lfoPhase_ : 0.0f;
+}
+
+void FmBlockRenderer::scatter(FmVoice* const* voices, int count) const {
+    for (int lane = 0; lane < count; ++lane) {
+        auto& voice = *voices[lane];
+        for (int k = 0; k < kOperators; ++k) {
+            const std::size_t at = static_cast<std::size_t>(k * capacity_ + lane);
+            auto& op = voice.operators_[static_cast<std::size_t>(k)];
+            op.phase_ = phase_[at];
+            op.previousSample_ = previous_[at];
+        }
+        voice.lfoPhase_ = lfoPhase_[static_cast<std::size_t>(lane)];
+    }
+}
+
+// The next numFrames envelope values of every live operator, as FmOperator::render steps them.
+// An operator is running at frame i of the chunk while i < its runningFrames_, and a voice is
+// active before frame i (renderFrame would play it) while i - 1 < its voiceFrames_.
+void FmBlockRenderer::renderEnvelopes(FmVoice* const* voices, int count, unsigned liveOperators, int numFrames) {
+    std::fill(voiceFrames_.begin(), voiceFrames_.begin() + lanes_, -1.0f);
+    for (int k = 0; k < kOperators; ++k) {
+        operatorFrames_[k] = -1.0f;
+        if (!((liveOperators >> k) & 1u)) continue;
+
+        for (int lane = 0; lane < lanes_; ++lane) {
+            envelopeSources_[static_cast<std::size_t>(lane)] =
+                lane < count ? &voices[lane]->operators_[static_cast<std::size_t>(k)].envelope_ : nullptr;
+        }
+        const int first = k * capacity_;
+        envelopes_.render(envelopeSources_.data(), first, lanes_, numFrames);
+        for (int lane = 0; lane < lanes_; ++lane) {
+            const float frames = static_cast<float>(envelopes_.runningFrames(first + lane));
+            runningFrames_[static_cast<std::size_t>(first + lane)] = frames;
+            operatorFrames_[k] = std::max(operatorFrames_[k], frames);
+            voiceFrames_[static_cast<std::size_t>(lane)] = std::max(voiceFrames_[static_cast<std::size_t>(lane)], frames);
+        }
+    }
+}
+
+void FmBlockRenderer::render(FmVoice* const* voices, int count, const FmPatchSnapshot& patch,
+                             float* left, float* right, int numSamples) {
+    using Kernel = void (FmBlockRenderer::*)(FmVoice* const*, int, const FmPatchSnapshot&, float*, float*, int);
+    static constexpr Kernel kKernels[kFmAlgorithmCount] = {
+        &FmBlockRenderer::renderWith<0>, &FmBlockRenderer::renderWith<1>, &FmBlockRenderer::renderWith<2>,
+        &FmBlockRenderer::renderWith<3>, &FmBlockRenderer::renderWith<4>, &FmBlockRenderer::renderWith<5>,
+        &FmBlockRenderer::renderWith<6>, &FmBlockRenderer::renderWith<7>,
+    };
+
+    count = std::min(count, capacity_);
+    if (count <= 0 || !left || !right || numSamples <= 0) return;
+
+    gather(voices, count);
+    (this->*kKernels[patch.algorithmSlot])(voices, count, patch, left, right, numSamples);
+    scatter(voices, count);
+}
+
+template <int A>
+void FmBlockRenderer::renderWith(FmVoice* const* voices, int count, const FmPatchSnapshot& patch,
+                                 float* left, float* right, int numSamples) {
+    constexpr unsigned wired = fmAudibleOperators(kFmAlgorithmTable[A], 0u, kFmSideTaps);
+
+    const unsigned liveOperators = patch.liveOperators;
+    const unsigned feedbackOperators = patch.feedbackOperators;
+    const FmVec4 lfoIncrement = FmVec4::fill(patch.lfoIncrement);
+    const FmVec4 lfoDepth = FmVec4::fill(patch.lfoDepth);
+    const FmVec4 masterGain = FmVec4::fill(patch.masterGain);
+    const FmVec4 width = FmVec4::fill(patch.width);
+    const FmVec4 sideScale = FmVec4::fill(0.35f);
+    const FmVec4 invTwoPi = FmVec4::fill(kFmInvTwoPi);
+    const FmVec4 zero = FmVec4::fill(0.0f);
+    FmVec4 feedback[kMaxFmOperators];
+    for (int k = 0; k < kOperators; ++k)
+        feedback[k] = FmVec4::fill(patch.operators[static_cast<std::size_t>(k)].params.feedback);
+
+    const FmVec4 one = FmVec4::fill(1.0f);
+    float* phase = phase_.data();
+    const float* increment = increment_.data();
+    const float* gain = gain_.data();
+    float* previous = previous_.data();
+    const float* running = runningFrames_.data();
+    const int rowStride = envelopes_.maxFrames();
+
+    for (int chunk = 0; chunk < numSamples; chunk += kEnvelopeChunk) {
+        const int frames = std::min(kEnvelopeChunk, numSamples - chunk);
+        renderEnvelopes(voices, count, liveOperators, frames);
+
+        for (int i = 0; i < frames; ++i) {
+            // Not propagated to modulators: a modulator keeps its phase moving after its carrier
+            // ends, as in renderFrame, so the voice's next note starts from the same state.
+            const float frame = static_cast<float>(i);
+            unsigned live = 0u;
+            for (int k = 0; k < kOperators; ++k) live |= frame < operatorFrames_[k] ? 1u << k : 0u;
+            live &= liveOperators;
+            const FmVec4 frameV = FmVec4::fill(frame);
+            const FmVec4 previousFrameV = FmVec4::fill(frame - 1.0f);
+
+            FmVec4 sumLeft = zero;
+            FmVec4 sumRight = zero;
+            for (int g = 0; g < lanes_; g += 4) {
+                const FmVec4 alive = selectBelow(previousFrameV, FmVec4::load(voiceFrames_.data() + g), one);
+                const FmVec4 lfoPhase = fmWrapTurns(FmVec4::load(lfoPhase_.data() + g) + lfoIncrement * alive);
+                lfoPhase.store(lfoPhase_.data() + g);
+                const FmVec4 lfo = fmSinTurns(lfoPhase) * lfoDepth;
+
+                FmVec4 outputs[kMaxFmOperators];
+                forEachFmOperatorInRenderOrder([&](auto index) {
+                    constexpr int k = decltype(index)::value;
+                    if constexpr (((wired >> k) & 1u) != 0u) {
+                        const int at = k * capacity_ + g;
+                        if (!((live >> k) & 1u)) {
+                            outputs[k] = zero;
+                            zero.store(previous + at);
+                            return;
+                        }
+                        const FmVec4 runs = selectBelow(frameV, FmVec4::load(running + at), one);
+                        const FmVec4 p = fmWrapTurns(FmVec4::load(phase + at) + FmVec4::load(increment + at) * runs);
+                        p.store(phase + at);
+                        FmVec4 modulation = fmModulation<A, k>(outputs, zero) + lfo;
+                        if ((feedbackOperators >> k) & 1u) modulation = modulation + feedback[k] * FmVec4::load(previous + at);
+                        const FmVec4 env = FmVec4::gather(envelopes_.row(at) + i, rowStride);
+                        const FmVec4 sample = fmSinTurns(p + modulation * invTwoPi) * env * FmVec4::load(gain + at);
+                        sample.store(previous + at);
+                        outputs[k] = sample;
+                    }
+                });
+
+                FmVec4 mono = zero;
+                forEachFmOperatorInOrder([&](auto index) {
+                    constexpr int k = decltype(index)::value;
+                    if constexpr (kFmAlgorithmTable[A].nodes[k].isCarrier) mono = mono + outputs[k];
+                });
+                mono = mono * masterGain;
+                const FmVec4 side = outputs[2] * width * sideScale;
+                sumLeft = sumLeft + (mono - side);
+                sumRight = sumRight + (mono + side);
+            }
+            left[chunk + i] += horizontalSum(sumLeft);
+            right[chunk + i] += horizontalSum(sumRight);
+        }
+    }
+}
+
+} // namespace sls::engine::fm
@@ -1,69 +1,109 @@
 #include "instruments/fm/FmEngine.h"
+#include <algorithm>
+#include <functional>
 
 namespace sls::engine::fm {
 
-void FmEngine::prepare(double sampleRate, int maxVoices) {
-    sampleRate_ = std::max(1.0, sampleRate);
-    voices_.clear();
-    voices_.reserve(static_cast<std::size_t>(std::max(1, maxVoices)));
-    for (int i = 0; i < std::max(1, maxVoices); ++i) {
-        auto voice = std::make_unique<FmVoice>();
-        voice->prepare(sampleRate_);
-        voice->setPatch(patch_);
-        voices_.push_back(std::move(voice));
-    }
+void FmEngine::prepare(int maxVoices, std::shared_ptr<const FmPatchSnapshot> patch) {
+    voices_ = std::vector<FmVoice>(static_cast<std::size_t>(std::max(1, maxVoices)));
+    active_.assign(voices_.size(), 0);
+    idle_.reserve(voices_.size());
+    blockVoices_.clear();
+    blockVoices_.reserve(voices_.size());
+    blockRenderer_.prepare(static_cast<int>(voices_.size()));
+    patch_ = std::move(patch);
+    reset();
 }
 
 void FmEngine::reset() {
-    for (auto& voice : voices_) voice->reset();
+    for (auto& voice : voices_) voice.reset();
+    activeHead_ = 0;
+    activeCount_ = 0;
+    idle_.clear();
+    for (int i = static_cast<int>(voices_.size()) - 1; i >= 0; --i) idle_.push_back(i);
 }
 
-void FmEngine::setPatch(const FmPatch& patch) {
-    patch_ = patch;
-    for (auto& voice : voices_) voice->setPatch(patch_);
+void FmEngine::setPatch(std::shared_ptr<const FmPatchSnapshot> patch) {
+    if (patch) patch_ = std::move(patch);
 }
 
 void FmEngine::noteOn(int midiNote, float velocity) {
-    if (auto* voice = findFreeVoice()) {
-        voice->setPatch(patch_);
-        voice->noteOn(midiNote, velocity);
-        return;
+    if (voices_.empty() || !patch_) return;
+    if (idle_.empty()) retireEndedVoices();
+
+    int index = 0;
+    if (!idle_.empty()) {
+        index = idle_.back();
+        idle_.pop_back();
+        active_[static_cast<std::size_t>((activeHead_ + activeCount_) % static_cast<int>(active_.size()))] = index;
+        ++activeCount_;
+    } else {
+        // Every voice is sounding: the oldest becomes the newest, its ring slot stays put.
+        index = active_[static_cast<std::size_t>(activeHead_)];
+        activeHead_ = (activeHead_ + 1) % static_cast<int>(active_.size());
     }
-    if (voices_.empty()) return;
-    auto* voice = voices_[static_cast<std::size_t>(nextStealIndex_ % voices_.size())].get();
-    ++nextStealIndex_;
-    voice->setPatch(patch_);
-    voice->noteOn(midiNote, velocity);
+    voices_[static_cast<std::size_t>(index)].noteOn(patch_, midiNote, velocity);
 }
 
 void FmEngine::noteOff(int midiNote) {
-    if (auto* voice = findVoice(midiNote)) voice->noteOff();
+    for (int i = 0; i < activeCount_; ++i) {
+        auto& voice = activeVoice(i);
+        if (voice.currentMidiNote() == midiNote && voice.isActive()) {
+            voice.noteOff();
+            return;
+        }
+    }
 }
 
 std::pair<float, float> FmEngine::renderFrame() {
+    retireEndedVoices();
     float left = 0.0f;
     float right = 0.0f;
-    for (auto& voice : voices_) {
-        if (!voice->isActive()) continue;
-        auto [l, r] = voice->renderFrame();
+    for (int i = 0; i < activeCount_; ++i) {
+        auto [l, r] = activeVoice(i).renderFrame();
         left += l;
         right += r;
     }
     return { left, right };
 }
 
-FmVoice* FmEngine::findVoice(int midiNote) {
-    for (auto& voice : voices_) {
-        if (voice->currentMidiNote() == midiNote && voice->isActive()) return voice.get();
+void FmEngine::renderBlock(float* left, float* right, int numSamples) {
+    if (!left || !right || numSamples <= 0) return;
+    retireEndedVoices();
+    if (activeCount_ == 0) return;
+
+    blockVoices_.clear();
+    for (int i = 0; i < activeCount_; ++i) blockVoices_.push_back(&activeVoice(i));
+    // One block per snapshot: notes started before a patch change keep playing the old one.
+    std::sort(blockVoices_.begin(), blockVoices_.end(),
+              [](const FmVoice* a, const FmVoice* b) { return std::less<const FmPatchSnapshot*> {}(a->patch(), b->patch()); });
+    const int count = static_cast<int>(blockVoices_.size());
+    for (int first = 0; first < count;) {
+        const FmPatchSnapshot* patch = blockVoices_[static_cast<std::size_t>(first)]->patch();
+        int last = first + 1;
+        while (last < count && blockVoices_[static_cast<std::size_t>(last)]->patch() == patch) ++last;
+        blockRenderer_.render(blockVoices_.data() + first, last - first, *patch, left, right, numSamples);
+        first = last;
     }
-    return nullptr;
 }
 
-FmVoice* FmEngine::findFreeVoice() {
-    for (auto& voice : voices_) {
-        if (!voice->isActive()) return voice.get();
+FmVoice& FmEngine::activeVoice(int position) noexcept {
+    const int slot = (activeHead_ + position) % static_cast<int>(active_.size());
+    return voices_[static_cast<std::size_t>(active_[static_cast<std::size_t>(slot)])];
+}
+
+// Moves the voices whose envelopes have ended back to idle_, keeping the others in start order.
+void FmEngine::retireEndedVoices() {
+    const int size = static_cast<int>(active_.size());
+    int kept = 0;
+    for (int i = 0; i < activeCount_; ++i) {
+        const int index = active_[static_cast<std::size_t>((activeHead_ + i) % size)];
+        if (voices_[static_cast<std::size_t>(index)].isActive())
+            active_[static_cast<std::size_t>((activeHead_ + kept++) % size)] = index;
+        else
+            idle_.push_back(index);
     }
-    return nullptr;
+    activeCount_ = kept;
 }
 
 } // namespace sls::engine::fm
@@ -1,27 +1,23 @@
 #include "instruments/fm/FmOperator.h"
+#include "instruments/fm/FmPatchSnapshot.h"
+#include "instruments/fm/FmSine.h"
 
 namespace sls::engine::fm {
 
-namespace {
-constexpr double kTwoPi = 6.28318530717958647692;
-}
-
-void FmOperator::prepare(double sampleRate) {
-    sampleRate_ = std::max(1.0, sampleRate);
-    envelope_.prepare(sampleRate_);
-}
-
 void FmOperator::reset() {
-    phase_ = 0.0;
-    velocity_ = 1.0f;
+    phase_ = 0.0f;
+    increment_ = 0.0f;
+    gain_ = 0.0f;
+    feedback_ = 0.0f;
     previousSample_ = 0.0f;
-    noteFrequency_ = 440.0;
     envelope_.reset();
 }
 
-void FmOperator::start(double noteFrequency, float velocity) {
-    noteFrequency_ = noteFrequency;
-    velocity_ = velocity;
+void FmOperator::start(const FmOperatorProgram& program, double noteFrequency, float velocity) {
+    increment_ = program.phaseIncrement(noteFrequency);
+    gain_ = program.gain(velocity);
+    feedback_ = program.params.feedback;
+    envelope_.setRates(program.envelope);
     envelope_.noteOn();
 }
 
@@ -36,22 +32,12 @@ float FmOperator::render(float modulationRadians) {
         return 0.0f;
     }
 
-    const double freq = currentFrequency(noteFrequency_);
-    const double phaseInc = (kTwoPi * freq) / sampleRate_;
-    phase_ += phaseInc;
-    if (phase_ >= kTwoPi) phase_ -= kTwoPi;
-
-    const float velScale = 1.0f - params_.velocitySensitivity + (params_.velocitySensitivity * velocity_);
-    const float fb = params_.feedback * previousSample_;
-    const float sample = std::sin(static_cast<float>(phase_) + modulationRadians + fb)
-                       * env * params_.outputLevel * velScale;
+    // FmBlockRenderer::render runs the same steps four voices at a time.
+    phase_ = fmWrapTurns(phase_ + increment_);
+    const float fb = feedback_ * previousSample_;
+    const float sample = fmSinTurns(phase_ + (modulationRadians + fb) * kFmInvTwoPi) * env * gain_;
     previousSample_ = sample;
     return sample;
 }
 
-double FmOperator::currentFrequency(double noteFrequency) const noexcept {
-    if (params_.fixedFrequency) return std::max(0.0, params_.fixedFrequencyHz + params_.detuneHz);
-    return std::max(0.0, noteFrequency * params_.ratio + params_.detuneHz);
-}
-
 } // namespace sls::engine::fm
@@ -0,0 +1,66 @@
+#include "instruments/fm/FmPatchSnapshot.h"
+#include <algorithm>
+#include <cmath>
+
+namespace sls::engine::fm {
+
+float FmOperatorProgram::phaseIncrement(double noteFrequency) const noexcept {
+    const double hz = params.fixedFrequency ? params.fixedFrequencyHz + params.detuneHz
+                                            : noteFrequency * params.ratio + params.detuneHz;
+    return static_cast<float>(std::max(0.0, hz) / sampleRate);
+}
+
+float FmOperatorProgram::gain(float velocity) const noexcept {
+    const float velScale = 1.0f - params.velocitySensitivity + (params.velocitySensitivity * velocity);
+    return params.outputLevel * velScale;
+}
+
+std::shared_ptr<const FmPatchSnapshot> FmPatchSnapshot::compile(const FmPatch& patch, double sampleRate) {
+    auto snapshot = std::make_shared<FmPatchSnapshot>();
+    snapshot->patch = patch;
+    snapshot->sampleRate = std::max(1.0, sampleRate);
+
+    snapshot->algorithmSlot = fmAlgorithmSlot(patch.voice.algorithm);
+    snapshot->taps = patch.voice.stereoWidth > 0.0f ? kFmSideTaps : 0u;
+    unsigned silent = 0u;
+    for (std::size_t i = 0; i < kMaxFmOperators; ++i) {
+        const auto& params = patch.operators[i];
+        if (!(params.outputLevel > 0.0f)) silent |= 1u << i;
+        if (std::abs(params.feedback) > 0.0f) snapshot->feedbackOperators |= 1u << i;
+
+        auto& program = snapshot->operators[i];
+        program.params = params;
+        program.sampleRate = snapshot->sampleRate;
+        program.envelope = FmEnvelopeRates::compute(patch.attack[i], patch.decay[i], patch.sustain[i],
+                                                    patch.release[i], snapshot->sampleRate);
+    }
+    snapshot->liveOperators = fmAudibleOperators(kFmAlgorithmTable[static_cast<std::size_t>(snapshot->algorithmSlot)],
+                                                 silent, snapshot->taps);
+
+    const bool lfoOn = patch.voice.lfoRateHz > 0.0f && patch.voice.lfoDepth > 0.0f;
+    snapshot->lfoIncrement = lfoOn ? patch.voice.lfoRateHz / static_cast<float>(snapshot->sampleRate) : 0.0f;
+    snapshot->lfoDepth = patch.voice.lfoDepth;
+    snapshot->masterGain = patch.voice.masterGain;
+    snapshot->width = std::clamp(patch.voice.stereoWidth, 0.0f, 1.0f);
+    return snapshot;
+}
+
+std::shared_ptr<const FmPatchSnapshot> FmPatchLibrary::compile(const FmPatch& patch, double sampleRate) {
+    auto snapshot = FmPatchSnapshot::compile(patch, sampleRate);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    snapshots_.push_back(snapshot);
+    return snapshot;
+}
+
+void FmPatchLibrary::collect() {
+    std::vector<std::shared_ptr<const FmPatchSnapshot>> unused;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::partition(snapshots_.begin(), snapshots_.end(),
+                                 [](const auto& snapshot) { return snapshot.use_count() > 1; });
+        unused.assign(std::make_move_iterator(it), std::make_move_iterator(snapshots_.end()));
+        snapshots_.erase(it, snapshots_.end());
+    }
+}
+
+} // namespace sls::engine::fm
@@ -1,17 +1,9 @@
 #include "instruments/fm/FmVoice.h"
 #include <cmath>
+#include "instruments/fm/FmSine.h"
 
 namespace sls::engine::fm {
 
-namespace {
-constexpr float kTwoPiF = 6.28318530717958647692f;
-}
-
-void FmVoice::prepare(double sampleRate) {
-    sampleRate_ = std::max(1.0, sampleRate);
-    for (auto& op : operators_) op.prepare(sampleRate_);
-}
-
 void FmVoice::reset() {
     midiNote_ = -1;
     velocity_ = 0.0f;
@@ -19,22 +11,13 @@ void FmVoice::reset() {
     for (auto& op : operators_) op.reset();
 }
 
-void FmVoice::setPatch(const FmPatch& patch) {
+void FmVoice::noteOn(const std::shared_ptr<const FmPatchSnapshot>& patch, int midiNote, float velocity) {
+    if (!patch) return;
     patch_ = patch;
-    for (std::size_t i = 0; i < operators_.size(); ++i) {
-        operators_[i].params() = patch_.operators[i];
-        operators_[i].envelope().setAttack(patch_.attack[i]);
-        operators_[i].envelope().setDecay(patch_.decay[i]);
-        operators_[i].envelope().setSustain(patch_.sustain[i]);
-        operators_[i].envelope().setRelease(patch_.release[i]);
-    }
-}
-
-void FmVoice::noteOn(int midiNote, float velocity) {
     midiNote_ = midiNote;
     velocity_ = velocity;
     const double freq = midiNoteToFrequency(midiNote);
-    for (auto& op : operators_) op.start(freq, velocity_);
+    for (std::size_t i = 0; i < operators_.size(); ++i) operators_[i].start(patch_->operators[i], freq, velocity_);
 }
 
 void FmVoice::noteOff() {
@@ -42,39 +25,52 @@ void FmVoice::noteOff() {
 }
 
 std::pair<float, float> FmVoice::renderFrame() {
+    using Kernel = std::pair<float, float> (FmVoice::*)();
+    static constexpr Kernel kKernels[kFmAlgorithmCount] = {
+        &FmVoice::renderFrameWith<0>, &FmVoice::renderFrameWith<1>, &FmVoice::renderFrameWith<2>, &FmVoice::renderFrameWith<3>,
+        &FmVoice::renderFrameWith<4>, &FmVoice::renderFrameWith<5>, &FmVoice::renderFrameWith<6>, &FmVoice::renderFrameWith<7>,
+    };
+    if (!patch_) return { 0.0f, 0.0f };
+    return (this->*kKernels[patch_->algorithmSlot])();
+}
+
+// One frame of algorithm A, unrolled: operators the topology never hears are not
+// compiled in, the ones silenced by the patch are skipped, envelope included.
+template <int A>
+std::pair<float, float> FmVoice::renderFrameWith() {
     if (!isActive()) return { 0.0f, 0.0f };
 
-    const auto& algorithm = FmAlgorithms::byIndex(patch_.voice.algorithm);
-    std::array<float, kMaxFmOperators> outputs {};
+    constexpr unsigned wired = fmAudibleOperators(kFmAlgorithmTable[A], 0u, kFmSideTaps);
+    const FmPatchSnapshot& patch = *patch_;
+    float outputs[kMaxFmOperators] {};
 
-    if (patch_.voice.lfoRateHz > 0.0f && patch_.voice.lfoDepth > 0.0f) {
-        lfoPhase_ += (kTwoPiF * patch_.voice.lfoRateHz) / static_cast<float>(sampleRate_);
-        if (lfoPhase_ >= kTwoPiF) lfoPhase_ -= kTwoPiF;
-    }
-    const float lfo = std::sin(lfoPhase_) * patch_.voice.lfoDepth;
+    if (patch.lfoIncrement > 0.0f) lfoPhase_ = fmWrapTurns(lfoPhase_ + patch.lfoIncrement);
+    const float lfo = fmSinTurns(lfoPhase_) * patch.lfoDepth;
 
-    for (int i = static_cast<int>(kMaxFmOperators) - 1; i >= 0; --i) {
-        float modulation = 0.0f;
-        for (int mod : algorithm.nodes[static_cast<std::size_t>(i)].modulators) {
-            if (mod >= 0) modulation += outputs[static_cast<std::size_t>(mod)];
+    forEachFmOperatorInRenderOrder([&](auto index) {
+        constexpr int k = decltype(index)::value;
+        if constexpr (((wired >> k) & 1u) != 0u) {
+            if ((patch.liveOperators >> k) & 1u)
+                outputs[k] = operators_[static_cast<std::size_t>(k)].render(fmModulation<A, k>(outputs, 0.0f) + lfo);
         }
-        outputs[static_cast<std::size_t>(i)] = operators_[static_cast<std::size_t>(i)].render(modulation + lfo);
-    }
+    });
 
     float mono = 0.0f;
-    for (std::size_t i = 0; i < algorithm.nodes.size(); ++i) {
-        if (algorithm.nodes[i].isCarrier) mono += outputs[i];
-    }
-    mono *= patch_.voice.masterGain;
+    forEachFmOperatorInOrder([&](auto index) {
+        constexpr int k = decltype(index)::value;
+        if constexpr (kFmAlgorithmTable[A].nodes[k].isCarrier) mono += outputs[k];
+    });
+    mono *= patch.masterGain;
 
-    const float width = std::clamp(patch_.voice.stereoWidth, 0.0f, 1.0f);
-    const float side = outputs[2] * width * 0.35f;
+    const float side = outputs[2] * patch.width * 0.35f;
     return { mono - side, mono + side };
 }
 
+// Only operators that can be heard keep the voice playing.
 bool FmVoice::isActive() const noexcept {
-    for (const auto& op : operators_) {
-        if (op.isActive()) return true;
+    if (!patch_) return false;
+    for (std::size_t i = 0; i < operators_.size(); ++i) {
+        if (((patch_->liveOperators >> i) & 1u) && operators_[i].isActive()) return true;
     }
     return false;
 }
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <mutex>
@@ -16,14 +17,29 @@
 #include <juce_core/juce_core.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include "AudioCallbackStats.h"
+#include "ChannelDSP.h"
 #include "FxBase.h"
 #include "FxDelay.h"
 #include "FxGrossBeat.h"
+#include "LoopAnalysis.h"
+#include "RenderWorkerPool.h"
+#include "SampleDecoder.h"
+#include "SamplePool.h"
+#include "PcmDiskCache.h"
+#include "SampleRateConverter.h"
+#include "SampleVoice.h"
+#include "ShmIpc.h"
+#include "RtEventQueue.h"
+#include "RtReleasePool.h"
 #include "instruments/InstrumentRegistry.h"
 #include "instruments/FmInstrumentFactory.h"
 #include "instruments/fm/FmEngine.h"
+#include "instruments/fm/FmPatchSnapshot.h"
 #include "instruments/DrumRuntime.h"
+#include "instruments/EnvelopeBank.h"
 #include "instruments/SampleTouskiInstrument.h"
+#include "instruments/SampleTouskiRuntime.h"
 
 #if defined(_WIN32) || defined(_WIN64)
   #include <windows.h>
@@ -38,6 +54,8 @@ namespace {
 constexpr double kTwoPi = 6.283185307179586;
 constexpr int    kMaxSynthVoices  = 64;
 constexpr int    kMaxSampleVoices = 128;
+constexpr int    kMaxTouskiVoices = 128;
+constexpr int    kMaxMixerChannels = 64;
 constexpr int    kStepsPerBeat    = 16;
 
 juce::int64 nowMs() { return juce::Time::currentTimeMillis(); }
@@ -58,171 +76,40 @@ struct Voice {
   float attack = 0.003f, decay = 0.12f, sustain = 0.7f, release = 0.2f;
   int waveform = 0;
 
-  int ageSamples = 0;
-  float env = 0.0f;
+  sls::engine::Envelope envelope; // rates set at note-on, exponential release to -80 dB
 
   double phase = 0.0;
   double phaseInc = 0.0;
 };
 
-struct SampleData {
-  double sampleRate = 48000.0;
-  juce::AudioBuffer<float> buffer;
-};
-
-struct SampleVoice {
-  bool active = false;
-  bool releasing = false;
-
-  juce::String instId = "sampler";
-  int note = 60;
-
-  std::shared_ptr<const SampleData> sample;
-  int start = 0;
-  int end = 0;
-
-  double pos = 0.0;
-  double rate = 1.0;
-
-  float gainL = 1.0f;
-  float gainR = 1.0f;
-  int mixCh = 1;
-
-  int fadeOutTotal = 256;
-  int fadeOutRemaining = 0;
-  int fadeInTotal = 64;
-  int fadeInRemaining = 0;
-  int loopCrossfadeSamples = 192;
-  int zeroCrossSearchSamples = 0;
-  int releaseTailSamples = 192;
-
-  bool loopEnabled = false;
-  int loopStart = 0;
-  int loopEnd = 0;
-  int releaseEnd = 0;
-};
-
-static float sampleAtHermite(const juce::AudioBuffer<float>& b, int ch, double pos) {
-  const int n = b.getNumSamples();
-  if (n <= 0) return 0.0f;
+// Renders up to n frames of one legacy synth voice, adding into outL/outR.
+static void renderSynthVoiceBlock(Voice& v, float* outL, float* outR, int n) {
+  if (!v.active) return;
 
-  const double safePos = juce::jlimit(0.0, (double)std::max(0, n - 1), pos);
-  const int i1 = juce::jlimit(0, n - 1, (int)std::floor(safePos));
-  const float t = (float)(safePos - (double)i1);
+  constexpr int kEnvelopeChunk = 64;
+  float env[kEnvelopeChunk];
+  int envRunning = 0;
 
-  const int i0 = juce::jlimit(0, n - 1, i1 - 1);
-  const int i2 = juce::jlimit(0, n - 1, i1 + 1);
-  const int i3 = juce::jlimit(0, n - 1, i1 + 2);
+  for (int i = 0; i < n; ++i) {
+    const int e = i % kEnvelopeChunk;
+    if (e == 0) envRunning = v.envelope.render(env, std::min(kEnvelopeChunk, n - i));
+    if (e >= envRunning) { v.active = false; return; } // release fell below -80 dB
 
-  const float y0 = b.getSample(ch, i0);
-  const float y1 = b.getSample(ch, i1);
-  const float y2 = b.getSample(ch, i2);
-  const float y3 = b.getSample(ch, i3);
-
-  const float c0 = y1;
-  const float c1 = 0.5f * (y2 - y0);
-  const float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
-  const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
-  return ((c3 * t + c2) * t + c1) * t + c0;
-}
-
-static double wrapLoopPosition(double pos, int loopStart, int loopEnd) {
-  if (loopEnd <= loopStart) return pos;
-  const double loopLen = (double)(loopEnd - loopStart);
-  while (pos >= (double)loopEnd) pos -= loopLen;
-  while (pos <  (double)loopStart) pos += loopLen;
-  return pos;
-}
-
-static float signedSampleAverage(const juce::AudioBuffer<float>& b, int idx) {
-  const int n = b.getNumSamples();
-  if (n <= 0) return 0.0f;
-  const int i = juce::jlimit(0, n - 1, idx);
-  const int chs = std::max(1, b.getNumChannels());
-  float sum = 0.0f;
-  for (int ch = 0; ch < chs; ++ch) sum += b.getSample(ch, i);
-  return sum / (float)chs;
-}
-
-static float zeroMetricAt(const juce::AudioBuffer<float>& b, int idx) {
-  const int n = b.getNumSamples();
-  if (n <= 0) return 0.0f;
-  const int i = juce::jlimit(0, n - 1, idx);
-  const int ip = juce::jlimit(0, n - 1, i - 1);
-  const int in = juce::jlimit(0, n - 1, i + 1);
-  const float s0 = signedSampleAverage(b, i);
-  const float sp = signedSampleAverage(b, ip);
-  const float sn = signedSampleAverage(b, in);
-  return std::abs(s0) + 0.35f * (std::abs(s0 - sp) + std::abs(sn - s0));
-}
+    float sig = 0.0f;
+    switch (v.waveform) {
+      default:
+      case 0: sig = (float)std::sin(v.phase); break;              // sine
+      case 1: sig = (float)((2.0 * (v.phase / kTwoPi)) - 1.0); break; // saw-ish
+      case 2: sig = (v.phase < kTwoPi * 0.5) ? 1.0f : -1.0f; break;   // square
+    }
 
-static float seamMetricAt(const juce::AudioBuffer<float>& b, int loopStart, int loopEnd) {
-  const int n = b.getNumSamples();
-  if (n <= 2) return 0.0f;
-  const int s = juce::jlimit(1, n - 2, loopStart);
-  const int e = juce::jlimit(1, n - 2, loopEnd);
-  const int chs = std::max(1, b.getNumChannels());
-  float score = 0.0f;
-  for (int ch = 0; ch < chs; ++ch) {
-    const float tail = b.getSample(ch, e - 1);
-    const float head = b.getSample(ch, s);
-    const float tailSlope = tail - b.getSample(ch, e - 2);
-    const float headSlope = b.getSample(ch, s + 1) - head;
-    score += std::abs(tail - head) + 0.6f * std::abs(tailSlope - headSlope);
-  }
-  score += 0.2f * (zeroMetricAt(b, s) + zeroMetricAt(b, e - 1));
-  return score;
-}
+    v.phase += v.phaseInc;
+    if (v.phase > kTwoPi) v.phase -= kTwoPi;
 
-static int snapZeroCrossIndex(const juce::AudioBuffer<float>& b, int target, int radius, int minIndex, int maxIndex) {
-  const int lo = juce::jlimit(0, b.getNumSamples() - 1, minIndex);
-  const int hi = juce::jlimit(lo, b.getNumSamples() - 1, maxIndex);
-  const int t = juce::jlimit(lo, hi, target);
-  const int r = std::max(0, radius);
-  int best = t;
-  float bestScore = std::numeric_limits<float>::max();
-  for (int i = std::max(lo, t - r); i <= std::min(hi, t + r); ++i) {
-    const float distancePenalty = 0.0005f * (float)std::abs(i - t);
-    const float score = zeroMetricAt(b, i) + distancePenalty;
-    if (score < bestScore) {
-      bestScore = score;
-      best = i;
-    }
-  }
-  return best;
-}
-
-static void refineLoopPoints(const juce::AudioBuffer<float>& b, int radius, int minGap, int& loopStart, int& loopEnd) {
-  const int n = b.getNumSamples();
-  if (n <= 4 || loopEnd <= loopStart) return;
-  const int safeGap = std::max(8, minGap);
-  const int startMin = 1;
-  const int startMax = std::max(startMin, loopEnd - safeGap);
-  int snappedStart = snapZeroCrossIndex(b, loopStart, radius, startMin, startMax);
-
-  const int endMin = std::min(n - 2, snappedStart + safeGap);
-  const int endMax = std::max(endMin, n - 1);
-  const int targetEnd = juce::jlimit(endMin, endMax, loopEnd);
-  const int searchLo = std::max(endMin, targetEnd - std::max(0, radius));
-  const int searchHi = std::min(endMax, targetEnd + std::max(0, radius));
-
-  int bestEnd = targetEnd;
-  float bestScore = seamMetricAt(b, snappedStart, targetEnd);
-  for (int e = searchLo; e <= searchHi; ++e) {
-    if (e <= snappedStart + safeGap) continue;
-    const float distancePenalty = 0.0005f * (float)std::abs(e - targetEnd);
-    const float score = seamMetricAt(b, snappedStart, e) + distancePenalty;
-    if (score < bestScore) {
-      bestScore = score;
-      bestEnd = e;
-    }
-  }
-
-  const int startSearchMax = std::max(startMin, bestEnd - safeGap);
-  snappedStart = snapZeroCrossIndex(b, snappedStart, std::max(0, radius / 2), startMin, startSearchMax);
-
-  loopStart = snappedStart;
-  loopEnd = std::max(loopStart + safeGap, bestEnd);
+    const float amp = sig * v.velocity * v.gain * env[e] * 0.2f;
+    outL[i] += amp;
+    outR[i] += amp;
+  }
 }
 
 static int positiveModuloInt(int value, int mod) {
@@ -246,14 +133,61 @@ struct VstRuntimeState {
 struct FmRuntime {
   juce::String instId;
   juce::String type;
-  int mixCh = 1;
+  int mixCh = 1;              // audio thread: the channel of the last note-on
   int polyphony = 8;
   bool drums = false;
+  double sampleRate = 48000.0; // the engine was prepared (and its patches are compiled) for
   sls::engine::fm::FmEngine engine;
-  sls::engine::fm::FmPatch patch;
   std::unique_ptr<sls::engine::DrumRuntime> drumRuntime;
+  FmRuntime* nextOnBus = nullptr; // audio thread: next runtime in the same render bucket
 };
 
+// Indices of the sources routed to each mixer channel, rebuilt by the audio thread once
+// per render segment so a channel task only visits its own sources. Sized up front.
+struct ChannelBuckets {
+  std::vector<int> first; // items[first[ch] .. first[ch + 1]) belong to channel ch
+  std::vector<int> fill;
+  std::vector<int> items;
+
+  void prepare(int numChannels, int capacity) {
+    first.assign((size_t)numChannels + 1, 0);
+    fill.assign((size_t)numChannels, 0);
+    items.assign((size_t)capacity, 0);
+  }
+
+  // channelOf(i) gives the channel of source i, or -1 to leave it out. Sources keep
+  // their index order within a channel.
+  template <typename ChannelOf>
+  void build(int count, ChannelOf&& channelOf) {
+    count = juce::jmin(count, (int)items.size());
+    std::fill(first.begin(), first.end(), 0);
+    for (int i = 0; i < count; ++i) {
+      const int ch = channelOf(i);
+      if (ch >= 0) ++first[(size_t)ch + 1];
+    }
+    for (size_t ch = 0; ch < fill.size(); ++ch) first[ch + 1] += first[ch];
+    std::copy(first.begin(), first.end() - 1, fill.begin());
+    for (int i = 0; i < count; ++i) {
+      const int ch = channelOf(i);
+      if (ch >= 0) items[(size_t)fill[(size_t)ch]++] = i;
+    }
+  }
+
+  const int* begin(int ch) const { return items.data() + first[(size_t)ch]; }
+  const int* end(int ch) const { return items.data() + first[(size_t)ch + 1]; }
+};
+
+// What the audio thread knows of one instrument. Built whole on the request side
+// (publishInstrument) and published in a new InstrumentTable; the audio thread only
+// swaps the table pointer. An update that keeps the FM runtime shares it with the old entry.
+struct InstrumentEntry {
+  std::shared_ptr<const InstrumentState> state;
+  std::shared_ptr<FmRuntime> fm; // FM-managed types
+};
+
+using InstrumentTable = std::unordered_map<juce::String, InstrumentEntry>;
+using TouskiProgramTable = sls::inst::SampleTouskiInstrument::ProgramTable;
+
 static juce::NamedValueSet dynamicObjectToParams(const juce::DynamicObject* obj) {
   juce::NamedValueSet out;
   if (!obj) return out;
@@ -283,10 +217,42 @@ static bool isFmManagedType(const juce::String& type) {
          t == "violin" || t == "drums" || t == "drum";
 }
 
-static sls::engine::fm::FmPatch makeFmPatchForState(const InstrumentState& st) {
-  auto inst = sls::engine::FmInstrumentFactory::create(normalizeFmTypeId(st.type));
+static bool isFmDrumType(const juce::String& type) {
+  return type.trim().toLowerCase().contains("drum");
+}
+
+static int fmPolyphonyFor(const InstrumentState& st) {
+  return juce::jlimit(1, 64, std::max(1, st.polyphony));
+}
+
+// Requests that would change the audio of a bounce in progress; they answer E_BUSY until it ends.
+static bool isRefusedWhileBouncing(const juce::String& op) {
+  if (op == "transport.state.get") return false;
+  return op.startsWith("transport.") || op.startsWith("note.") || op.startsWith("midi.") ||
+         op.startsWith("mixer.") || op.startsWith("fx.") || op.startsWith("schedule.") ||
+         op.startsWith("touski.note.") || op == "touski.param.set" || op == "touski.program.load" ||
+         op == "inst.create" || op == "inst.param.set" || op == "sampler.trigger" ||
+         op == "sampler.load" || op == "sampler.unload" || op == "engine.config.set";
+}
+
+static bool isNoteOnType(const juce::String& type) {
+  return type.equalsIgnoreCase("note.on") || type.equalsIgnoreCase("midi.noteon");
+}
+
+// Factory patch per type, built once: parameter changes only rescale a copy of it.
+static sls::engine::fm::FmPatch baseFmPatchForType(const std::string& typeId) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, sls::engine::fm::FmPatch> patches;
+  std::scoped_lock lk(mutex);
+  if (auto it = patches.find(typeId); it != patches.end()) return it->second;
+
+  auto inst = sls::engine::FmInstrumentFactory::create(typeId);
   if (!inst) inst = sls::engine::FmInstrumentFactory::create("grand_piano");
-  auto patch = inst ? inst->makePatch() : sls::engine::fm::FmPatch{};
+  return patches.emplace(typeId, inst ? inst->makePatch() : sls::engine::fm::FmPatch{}).first->second;
+}
+
+static sls::engine::fm::FmPatch makeFmPatchForState(const InstrumentState& st) {
+  auto patch = baseFmPatchForType(normalizeFmTypeId(st.type));
 
   patch.voice.masterGain = std::max(0.02f, patch.voice.masterGain * std::max(0.05f, st.gain));
   patch.voice.lfoRateHz = std::max(0.0f, st.vibratoRateHz > 0.0f ? st.vibratoRateHz : patch.voice.lfoRateHz);
@@ -362,37 +328,11 @@ struct MixerChannelState {
   int xAssign = 2; // 0=A, 1=B, 2=OFF
 };
 
-struct FxUnit {
-  juce::String id;
-  juce::String type;
-  bool enabled = true;
-  bool bypass = false;
-  juce::NamedValueSet params;
-  juce::Reverb reverb;
-  std::unique_ptr<FxBase> dsp; // per-instance DSP (e.g., FxDelay)
-
-  float getParam(const juce::String& name, float def) const {
-    const auto v = params.getWithDefault(name, def);
-    if (v.isInt() || v.isDouble()) return (float)(double)v;
-    return def;
-  }
-};
-
 struct ChannelSmoothers {
   juce::SmoothedValue<float> gain;
   juce::SmoothedValue<float> pan;
 };
 
-struct ChannelDSP {
-  juce::dsp::IIR::Filter<float> lowL, lowR, midL, midR, highL, highR;
-  std::vector<std::unique_ptr<FxUnit>> fx;
-
-  void processEq(float& l, float& r) {
-    l = highL.processSample(midL.processSample(lowL.processSample(l)));
-    r = highR.processSample(midR.processSample(lowR.processSample(r)));
-  }
-};
-
 struct ScheduledEvent {
   double atPpq = 0.0;
   juce::String type;
@@ -402,6 +342,7 @@ struct ScheduledEvent {
   float vel = 0.85f;
   double durPpq = 0.25;
   juce::var payload;
+  std::shared_ptr<const SampleData> sample; // sampler.trigger: resolved at schedule.push, never on the audio thread
 };
 
 // Block-dispatch sample-accurate
@@ -410,6 +351,24 @@ struct BlockEvent {
   ScheduledEvent ev;
 };
 
+// What the audio thread plays: the scheduled events (sorted by atPpq), the schedule window and the
+// transport range. Never modified once published; the request side copies the last one, edits the
+// copy under stateMutex and swaps it in through a TimelineSet command.
+struct Timeline {
+  std::shared_ptr<const std::vector<ScheduledEvent>> events = std::make_shared<const std::vector<ScheduledEvent>>();
+  double windowFromPpq = 0.0;
+  double windowToPpq = 0.0;
+
+  juce::String playMode = "song";
+  double rangeStartPpq = 0.0;
+  double rangeEndPpq = 0.0;
+  bool loop = false;
+  bool stopAtEnd = true;
+  bool returnToStartOnStop = true;
+
+  bool hasRange() const { return rangeEndPpq > rangeStartPpq; }
+};
+
 enum class RtCommandType {
   MixerInit,
   MixerParamSet,
@@ -417,12 +376,33 @@ enum class RtCommandType {
   MixerCompatChannel,
   FxChainSet,
   FxParamSet,
-  FxBypassSet
+  FxBypassSet,
+  InstrumentsSet,
+  TouskiProgramsSet,
+  TimelineSet,
+  TransportPlay,
+  TransportStop,
+  TransportSeek,
+  LiveEvent,
+  SampleVoiceStart,
+  TouskiVoiceStart,
+  AllNotesOff
 };
 
 struct RtCommand {
   RtCommandType type {};
   juce::var data;
+  ScheduledEvent event;   // LiveEvent
+  int sampleOffset = 0;   // LiveEvent: frames into the next callback (0 = block start)
+  SampleVoice voice;      // SampleVoiceStart: prepared off the audio thread
+  sls::inst::SampleTouskiInstrument::VoiceSpec touskiVoice; // TouskiVoiceStart: built off the audio thread
+  std::shared_ptr<const InstrumentTable> instruments;                // InstrumentsSet: the table to swap in
+  std::shared_ptr<FmRuntime> fmRuntime;                              // InstrumentsSet: a kept runtime taking fmPatch
+  std::shared_ptr<const sls::engine::fm::FmPatchSnapshot> fmPatch;  // InstrumentsSet: compiled off the audio thread
+  std::shared_ptr<const TouskiProgramTable> touskiPrograms; // TouskiProgramsSet: the programs to swap in
+  std::shared_ptr<const Timeline> timeline; // TimelineSet: the timeline to swap in
+  bool relocate = false;                    // TimelineSet: move the play position into the new range
+  juce::int64 samplePos = 0;                // TransportSeek
 };
 
 // ------------------------------ Helpers ------------------------------
@@ -489,13 +469,33 @@ static juce::var cloneVar(const juce::var& src) {
 
 class Engine : public juce::AudioIODeviceCallback {
 public:
-  Engine() {
+  // openAudioDevice = false runs headless (offline bounce / CLI): nothing is rendered until a bounce drives it.
+  explicit Engine(bool openAudioDevice = true) : useAudioDevice(openAudioDevice) {
     formatManager.registerBasicFormats();
 
+    publishedInstruments = instrumentTables.add(std::make_shared<const InstrumentTable>());
+    instruments = publishedInstruments;
+    publishedTimeline = timelines.add(std::make_shared<const Timeline>());
+    timeline = publishedTimeline;
+    touskiPrograms = touskiProgramTables.add(std::make_shared<const TouskiProgramTable>());
+
     mixerStates.resize((size_t)channelCount);
     channelDsp.resize((size_t)channelCount);
     resizeMeters(channelCount);
-
+    prepareRenderBuffers();
+
+    // The audio thread only reuses these, never grows them.
+    voices.resize((size_t)kMaxSynthVoices);
+    sampleVoices.reserve((size_t)kMaxSampleVoices);
+    synthVoicesByBus.prepare(kMaxMixerChannels, kMaxSynthVoices);
+    sampleVoicesByBus.prepare(kMaxMixerChannels, kMaxSampleVoices);
+    touskiVoicesByBus.prepare(kMaxMixerChannels, touskiRuntime.getMaxVoices());
+    fmByBus.assign((size_t)kMaxMixerChannels, nullptr);
+    blockEvents.reserve((size_t)kRtQueueCapacity);
+    liveEvents.reserve((size_t)kRtQueueCapacity);
+
+    sampleStreamer.configure((size_t)sampleStreamBudgetMB << 20);
+    renderPool.start(renderThreads, bufferSize, sampleRate);
     setupAudio();
     refreshDspSpecs();
 
@@ -507,12 +507,30 @@ public:
   }
 
   ~Engine() override {
+    sampleDecoder.stop();
     running.store(false);
+    bounceCancel.store(true);
+    if (bounceThread.joinable()) bounceThread.join();
     if (stateThread.joinable()) stateThread.join();
+    closeBinaryTransport();
     shutdownAudio();
+    renderPool.stop();
   }
 
   bool isRunning() const { return running.load(); }
+  bool isBouncing() const { return bouncing.load(); }
+  bool lastBounceSucceeded() const { return bounceSucceeded.load(); }
+
+  // Headless only: load jobs answer before they finish; this waits for them.
+  void waitForLoadJobs() { sampleDecoder.waitUntilIdle(); }
+
+  // Headless only: applies commands queued by handle(), since no audio thread is there to drain them.
+  void drainRtCommandsOffline() {
+    if (useAudioDevice || bouncing.load()) return;
+    RtCommand cmd;
+    while (rtQueue.tryPop(cmd))
+      applyRtCommand(cmd, bufferSize);
+  }
 
   // ------------------------------ IPC handler ------------------------------
 
@@ -525,14 +543,25 @@ public:
     const auto data = obj->getProperty("data");
     const auto* d = data.getDynamicObject();
 
+    if (bouncing.load() && isRefusedWhileBouncing(op))
+      return resErr(op, id, "E_BUSY", "Offline render in progress");
+
     // Engine
     if (op == "engine.hello")       return resOk(op, id, helloData());
     if (op == "engine.ping")        return resOk(op, id, data);
     if (op == "engine.state.get")   return resOk(op, id, engineState());
+    if (op == "engine.stats")       {
+      if (getBoolProp(d, "reset", false)) callbackStats.requestReset();
+      return resOk(op, id, engineStats());
+    }
     if (op == "engine.config.get")  return resOk(op, id, engineConfig());
     if (op == "engine.config.set")  return handleEngineConfigSet(op, id, d);
     if (op == "engine.shutdown")    { running.store(false); return resOk(op, id, juce::var()); }
 
+    // Binary transport negotiation
+    if (op == "ipc.binary.open")    return handleBinaryOpen(op, id, d);
+    if (op == "ipc.binary.close")   { closeBinaryTransport(); return resOk(op, id, juce::var()); }
+
     // Project + Scheduler
     if (op == "project.sync")        return handleProjectSync(op, id, d, data);
     if (op == "schedule.clear")      return handleScheduleClear(op, id);
@@ -542,22 +571,23 @@ public:
     // Mixer init
     if (op == "mixer.init")          return handleMixerInit(op, id, d);
 
+    // Offline render
+    if (op == "render.bounce")       return handleRenderBounce(op, id, d);
+    if (op == "render.cancel")       { bounceCancel.store(true); return resOk(op, id, juce::var()); }
+
     // Transport
     if (op == "transport.range.set") {
-      std::scoped_lock lk(stateMutex);
-      transportPlayMode = getStringProp(d, "mode", transportPlayMode);
-      transportRangeStartPpq = std::max(0.0, getDoubleProp(d, "fromPpq", transportRangeStartPpq));
-      transportRangeEndPpq = std::max(transportRangeStartPpq, getDoubleProp(d, "toPpq", transportRangeEndPpq));
-      transportLoopEnabled = getBoolProp(d, "loop", transportLoopEnabled);
-      transportStopAtEnd = getBoolProp(d, "stopAtEnd", transportStopAtEnd);
-      transportReturnToStartOnStop = getBoolProp(d, "returnToStartOnStop", transportReturnToStartOnStop);
-      if (transportHasActiveRange()) {
-        const auto startSample = ppqToSamples(transportRangeStartPpq);
-        const auto endSample = ppqToSamples(transportRangeEndPpq);
-        if (samplePos < startSample || samplePos > endSample) {
-          samplePos = startSample;
-          resetSchedulerCursorForPpq(transportRangeStartPpq);
-        }
+      {
+        std::scoped_lock lk(stateMutex);
+        auto t = std::make_shared<Timeline>(*publishedTimeline);
+        t->playMode = getStringProp(d, "mode", t->playMode);
+        t->rangeStartPpq = std::max(0.0, getDoubleProp(d, "fromPpq", t->rangeStartPpq));
+        t->rangeEndPpq = std::max(t->rangeStartPpq, getDoubleProp(d, "toPpq", t->rangeEndPpq));
+        t->loop = getBoolProp(d, "loop", t->loop);
+        t->stopAtEnd = getBoolProp(d, "stopAtEnd", t->stopAtEnd);
+        t->returnToStartOnStop = getBoolProp(d, "returnToStartOnStop", t->returnToStartOnStop);
+        if (!publishTimeline(std::move(t), true))
+          return resErr(op, id, "E_BUSY", "Audio command queue full");
       }
       resOk(op, id, transportState());
       emitEvt("transport.state", transportState());
@@ -565,56 +595,25 @@ public:
     }
 
     if (op == "transport.play") {
-      {
-        std::scoped_lock lk(stateMutex);
-        if (transportHasActiveRange()) {
-          const auto startSample = ppqToSamples(transportRangeStartPpq);
-          const auto endSample = ppqToSamples(transportRangeEndPpq);
-          if (samplePos < startSample || samplePos >= endSample) {
-            samplePos = startSample;
-            resetSchedulerCursorForPpq(transportRangeStartPpq);
-          }
-        }
-        const double prerollSec = std::max(0.0, playPrerollMs.load() / 1000.0);
-        playArmCountdownSamples = (juce::int64)std::llround(prerollSec * std::max(1.0, sampleRate));
-        playStartSamplePos = samplePos + (juce::int64)std::llround(prerollSec * std::max(1.0, sampleRate));
-        playArmed.store(true);
-      }
-      playing.store(false);
+      if (!transportPlay()) return resErr(op, id, "E_BUSY", "Audio command queue full");
       resOk(op, id, juce::var());
       emitEvt("transport.state", transportState());
       return;
     }
 
     if (op == "transport.stop") {
-      {
-        std::scoped_lock lk(stateMutex);
-        playing.store(false);
-        playArmed.store(false);
-        playArmCountdownSamples = 0;
-        if (transportHasActiveRange() && transportReturnToStartOnStop) {
-          samplePos = ppqToSamples(transportRangeStartPpq);
-          resetSchedulerCursorForPpq(transportRangeStartPpq);
-        }
-      }
-      panic();
+      if (!transportStop()) return resErr(op, id, "E_BUSY", "Audio command queue full");
       resOk(op, id, juce::var());
       emitEvt("transport.state", transportState());
       return;
     }
 
     if (op == "transport.seek") {
-      std::scoped_lock lk(stateMutex);
       const bool hasSamplePos = d && d->hasProperty("samplePos");
-      samplePos = hasSamplePos
-        ? (juce::int64)getDoubleProp(d, "samplePos", 0.0)
-        : ppqToSamples(getDoubleProp(d, "ppq", 0.0));
-      playArmed.store(false);
-      playArmCountdownSamples = 0;
-      playing.store(false);
-
-      resetSchedulerCursorForPpq(samplesToPpq(samplePos));
-
+      if (!transportSeek(hasSamplePos
+            ? (juce::int64)getDoubleProp(d, "samplePos", 0.0)
+            : ppqToSamples(getDoubleProp(d, "ppq", 0.0))))
+        return resErr(op, id, "E_BUSY", "Audio command queue full");
       resOk(op, id, juce::var());
       emitEvt("transport.state", transportState());
       return;
@@ -630,8 +629,8 @@ public:
     if (op == "transport.state.get") return resOk(op, id, transportState());
 
     // Instruments (synth)
-    if (op == "inst.create")     { std::scoped_lock lk(audioMutex); return handleInstCreate(op, id, d); }
-    if (op == "inst.param.set")  { std::scoped_lock lk(audioMutex); return handleInstParamSet(op, id, d); }
+    if (op == "inst.create")     return handleInstCreate(op, id, d);
+    if (op == "inst.param.set")  return handleInstParamSet(op, id, d);
     if (op == "vst.inst.ensure") return handleVstInstEnsure(op, id, d);
     if (op == "vst.inst.param.set") return handleVstInstParamSet(op, id, d);
     if (op == "vst.note.on") return handleVstNoteOn(op, id, d);
@@ -640,25 +639,28 @@ public:
 
     // Note events (synth by default)
     if (op == "note.on" || op == "midi.noteOn") {
-      std::scoped_lock lk(audioMutex);
-      startVoice(getStringProp(d, "instId", "global"),
-                 getIntProp(d, "mixCh", 1),
-                 getIntProp(d, "note", 60),
-                 (float)getDoubleProp(d, "vel", getDoubleProp(d, "velocity", 0.85)));
-      return resOk(op, id, juce::var());
+      ScheduledEvent ev;
+      ev.type   = "note.on";
+      ev.instId = getStringProp(d, "instId", "global");
+      ev.mixCh  = getIntProp(d, "mixCh", 1);
+      ev.note   = getIntProp(d, "note", 60);
+      ev.vel    = (float)getDoubleProp(d, "vel", getDoubleProp(d, "velocity", 0.85));
+      ensureNoteInstrument(ev.instId);
+      return handleLiveEvent(op, id, ev);
     }
 
     if (op == "note.off" || op == "midi.noteOff") {
-      std::scoped_lock lk(audioMutex);
-      stopVoice(getStringProp(d, "instId", "global"),
-                getIntProp(d, "mixCh", 1),
-                getIntProp(d, "note", 60));
-      return resOk(op, id, juce::var());
+      ScheduledEvent ev;
+      ev.type   = "note.off";
+      ev.instId = getStringProp(d, "instId", "global");
+      ev.mixCh  = getIntProp(d, "mixCh", 1);
+      ev.note   = getIntProp(d, "note", 60);
+      return handleLiveEvent(op, id, ev);
     }
 
     if (op == "note.allOff" || op == "midi.panic") {
-      std::scoped_lock lk(audioMutex);
-      panic();
+      if (!enqueueRtCommand(RtCommandType::AllNotesOff, juce::var()))
+        return resErr(op, id, "E_BUSY", "Audio command queue full");
       return resOk(op, id, juce::var());
     }
 
@@ -670,7 +672,21 @@ public:
 
     // Sampler / Sample Pattern
     if (op == "sampler.load")    return handleSamplerLoad(op, id, d);
-    if (op == "sampler.unload")  { if (d) sampleCache.erase(getStringProp(d, "sampleId", "")); return resOk(op, id, juce::var()); }
+    if (op == "sampler.unload")  {
+      if (d) {
+        std::shared_ptr<const SampleData> unloaded;
+        {
+          std::scoped_lock lk(assetMutex);
+          if (auto it = sampleCache.find(getStringProp(d, "sampleId", "")); it != sampleCache.end()) {
+            unloaded = std::move(it->second);
+            sampleCache.erase(it);
+          }
+        }
+        unloaded.reset();
+        samplePool.trim();
+      }
+      return resOk(op, id, juce::var());
+    }
     if (op == "sampler.trigger") return handleSamplerTrigger(op, id, d);
 
     // Mixer + FX
@@ -688,29 +704,165 @@ public:
     return resErr(op, id, "E_UNKNOWN_OP", "Unknown opcode");
   }
 
-  bool enqueueRtCommand(RtCommandType type, const juce::var& data) {
-    const uint32_t write = rtWriteIdx.load(std::memory_order_relaxed);
-    const uint32_t next = (write + 1u) % (uint32_t)kRtQueueCapacity;
-    const uint32_t read = rtReadIdx.load(std::memory_order_acquire);
-    if (next == read) {
-      rtQueueOverflowCount.fetch_add(1, std::memory_order_relaxed);
-      return false;
-    }
+  // ------------------------------ Transport ------------------------------
+  // Shared by the JSON ops and the binary transport. The play position belongs to the audio thread:
+  // these only queue the change, applied at the start of the next block (applyTransport*Rt).
 
-    rtQueue[(size_t)write].type = type;
-    rtQueue[(size_t)write].data = data;
-    rtWriteIdx.store(next, std::memory_order_release);
+  bool transportPlay() { return enqueueRtCommand(RtCommandType::TransportPlay, juce::var()); }
+  bool transportStop() { return enqueueRtCommand(RtCommandType::TransportStop, juce::var()); }
+
+  bool transportSeek(juce::int64 newSamplePos) {
+    RtCommand cmd;
+    cmd.type = RtCommandType::TransportSeek;
+    cmd.samplePos = newSamplePos;
+    return enqueueRtCommand(cmd);
+  }
+
+  // Caller holds stateMutex. Makes t the timeline the audio thread plays; relocate moves the play
+  // position to the range start when it lies outside the new range (transport.range.set).
+  bool publishTimeline(std::shared_ptr<const Timeline> t, bool relocate = false) {
+    timelines.collect();
+    RtCommand cmd;
+    cmd.type = RtCommandType::TimelineSet;
+    cmd.timeline = timelines.add(std::move(t));
+    cmd.relocate = relocate;
+    if (!enqueueRtCommand(cmd)) return false;
+    publishedTimeline = cmd.timeline;
     return true;
   }
 
-  bool popRtCommand(RtCommand& out) {
-    const uint32_t read = rtReadIdx.load(std::memory_order_relaxed);
-    const uint32_t write = rtWriteIdx.load(std::memory_order_acquire);
-    if (read == write) return false;
+  // Caller holds stateMutex. Publishes the schedule with added merged in, keeping it sorted by atPpq.
+  bool publishScheduledEvents(std::vector<ScheduledEvent> added) {
+    const auto byPpq = [](const ScheduledEvent& a, const ScheduledEvent& b) { return a.atPpq < b.atPpq; };
+    std::stable_sort(added.begin(), added.end(), byPpq);
+    const auto& current = *publishedTimeline->events;
+    auto events = std::make_shared<std::vector<ScheduledEvent>>();
+    events->reserve(current.size() + added.size());
+    std::merge(current.begin(), current.end(),
+               std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()),
+               std::back_inserter(*events), byPpq);
+    auto t = std::make_shared<Timeline>(*publishedTimeline);
+    t->events = std::move(events);
+    return publishTimeline(std::move(t));
+  }
+
+  // Audio thread.
+  void applyTimelineRt(const RtCommand& cmd) {
+    timeline = cmd.timeline;
+    if (cmd.relocate && timeline->hasRange()) {
+      const auto rangeStartSample = ppqToSamples(timeline->rangeStartPpq);
+      const auto endSample = ppqToSamples(timeline->rangeEndPpq);
+      if (samplePos < rangeStartSample || samplePos > endSample) samplePos = rangeStartSample;
+    }
+    resetSchedulerCursorForPpq(samplesToPpq(samplePos));
+  }
+
+  void applyTransportPlayRt() {
+    if (timeline->hasRange()) {
+      const auto rangeStartSample = ppqToSamples(timeline->rangeStartPpq);
+      const auto endSample = ppqToSamples(timeline->rangeEndPpq);
+      if (samplePos < rangeStartSample || samplePos >= endSample) {
+        samplePos = rangeStartSample;
+        resetSchedulerCursorForPpq(timeline->rangeStartPpq);
+      }
+    }
+    const double prerollSec = std::max(0.0, playPrerollMs.load() / 1000.0);
+    playArmCountdownSamples = (juce::int64)std::llround(prerollSec * std::max(1.0, sampleRate));
+    playStartSamplePos = samplePos + playArmCountdownSamples;
+    playArmed.store(true);
+    playing.store(false);
+  }
 
-    out = rtQueue[(size_t)read];
-    rtReadIdx.store((read + 1u) % (uint32_t)kRtQueueCapacity, std::memory_order_release);
-    return true;
+  void applyTransportStopRt() {
+    playing.store(false);
+    playArmed.store(false);
+    playArmCountdownSamples = 0;
+    if (timeline->hasRange() && timeline->returnToStartOnStop) {
+      samplePos = ppqToSamples(timeline->rangeStartPpq);
+      resetSchedulerCursorForPpq(timeline->rangeStartPpq);
+    }
+    panic();
+  }
+
+  void applyTransportSeekRt(juce::int64 newSamplePos) {
+    samplePos = newSamplePos;
+    playArmed.store(false);
+    playArmCountdownSamples = 0;
+    playing.store(false);
+
+    resetSchedulerCursorForPpq(samplesToPpq(samplePos));
+  }
+
+  // Thread-safe: any thread may produce RT commands (IPC, MIDI input, loaders).
+  bool enqueueRtCommand(const RtCommand& cmd) {
+    if (rtQueue.tryPush(cmd)) return true;
+    rtQueueOverflowCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  bool enqueueRtCommand(RtCommandType type, const juce::var& data) {
+    RtCommand cmd;
+    cmd.type = type;
+    cmd.data = data;
+    return enqueueRtCommand(cmd);
+  }
+
+  void handleLiveEvent(const juce::String& op, const juce::String& id, const ScheduledEvent& ev, int sampleOffset = 0) {
+    RtCommand cmd;
+    cmd.type = RtCommandType::LiveEvent;
+    cmd.event = ev;
+    cmd.sampleOffset = sampleOffset;
+    if (!enqueueRtCommand(cmd))
+      return resErr(op, id, "E_BUSY", "Audio command queue full");
+    resOk(op, id, juce::var());
+  }
+
+  // Any thread except the audio thread.
+  bool enqueueSampleVoice(const SampleVoice& sv) {
+    RtCommand cmd;
+    cmd.type = RtCommandType::SampleVoiceStart;
+    cmd.voice = sv;
+    if (enqueueRtCommand(cmd)) return true;
+    cmd.voice.releaseStream();
+    return false;
+  }
+
+  void handleSampleVoiceStart(const juce::String& op, const juce::String& id, const SampleVoice& sv) {
+    if (!enqueueSampleVoice(sv))
+      return resErr(op, id, "E_BUSY", "Audio command queue full");
+    resOk(op, id, juce::var());
+  }
+
+  // Audio thread only.
+  void applyRtCommand(const RtCommand& cmd, int numFrames) {
+    auto* d = cmd.data.getDynamicObject();
+    switch (cmd.type) {
+      case RtCommandType::MixerInit: applyMixerInitRt(d); break;
+      case RtCommandType::MixerParamSet: applyMixerParamSetRt(d); break;
+      case RtCommandType::MixerCompatMaster: applyMixerCompatMasterRt(d); break;
+      case RtCommandType::MixerCompatChannel: applyMixerCompatChannelRt(d); break;
+      case RtCommandType::FxChainSet: applyFxSetOpRt("fx.chain.set", d); break;
+      case RtCommandType::FxParamSet: applyFxSetOpRt("fx.param.set", d); break;
+      case RtCommandType::FxBypassSet: applyFxSetOpRt("fx.bypass.set", d); break;
+      case RtCommandType::InstrumentsSet:
+        instruments = cmd.instruments;
+        if (cmd.fmRuntime && cmd.fmPatch) cmd.fmRuntime->engine.setPatch(cmd.fmPatch);
+        break;
+      case RtCommandType::TouskiProgramsSet: touskiPrograms = cmd.touskiPrograms; break;
+      case RtCommandType::TimelineSet: applyTimelineRt(cmd); break;
+      case RtCommandType::TransportPlay: applyTransportPlayRt(); break;
+      case RtCommandType::TransportStop: applyTransportStopRt(); break;
+      case RtCommandType::TransportSeek: applyTransportSeekRt(cmd.samplePos); break;
+      case RtCommandType::LiveEvent:
+        // Offset 0 fires now, keeping FIFO order with the other commands of this drain.
+        if (cmd.sampleOffset <= 0 || numFrames <= 1) dispatchOneEvent(cmd.event);
+        else if (liveEvents.size() < liveEvents.capacity())
+          liveEvents.push_back(BlockEvent{ juce::jmin(cmd.sampleOffset, numFrames - 1), cmd.event });
+        break;
+      case RtCommandType::SampleVoiceStart: startSampleVoice(cmd.voice); break;
+      case RtCommandType::TouskiVoiceStart: touskiRuntime.spawnVoice(cmd.touskiVoice); break;
+      case RtCommandType::AllNotesOff: panic(); break;
+    }
   }
 
   inline float sanitizeFinite(float v) {
@@ -730,9 +882,14 @@ public:
     refreshDspSpecs();
 
     // Pre-size to avoid realloc in callback
-    busL.assign((size_t)juce::jmax(1, channelCount), 0.0f);
-    busR.assign((size_t)juce::jmax(1, channelCount), 0.0f);
-    touskiInstrument.setSampleRate(sampleRate);
+    prepareRenderBuffers();
+    {
+      std::scoped_lock lk(assetMutex); // recompiles the installed Touski programs
+      touskiInstrument.setSampleRate(sampleRate);
+      publishTouskiPrograms();
+    }
+    touskiRuntime.setSampleRate(sampleRate);
+    retargetSamples(sampleRate);
 
   }
 
@@ -741,333 +898,34 @@ public:
   void audioDeviceIOCallbackWithContext(const float* const*, int,
                                        float* const* out, int outChs,
                                        int n,
-                                       const juce::AudioIODeviceCallbackContext&) override
+                                       const juce::AudioIODeviceCallbackContext& context) override
   {
-    std::scoped_lock lk(audioMutex);
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    renderAudio(out, outChs, n);
+    publishTelemetry(n, context.hostTimeNs != nullptr
+                          ? (juce::int64)*context.hostTimeNs
+                          : (juce::int64)(juce::Time::highResolutionTicksToSeconds(startTicks) * 1.0e9));
+    callbackStats.blockRendered(startTicks, juce::Time::getHighResolutionTicks(), n, sampleRate);
+  }
+
+  // One device period: drains queued commands, renders n frames, finalizes meters.
+  // Called by the device callback, or by the bounce thread while no device is attached.
+  void renderAudio(float* const* out, int outChs, int n) {
+    // Never blocks: producers hand everything over through the lock-free queue.
     RtCommand cmd;
     int rtBudget = 256;
-    while (rtBudget-- > 0 && popRtCommand(cmd)) {
-      auto* d = cmd.data.getDynamicObject();
-      switch (cmd.type) {
-        case RtCommandType::MixerInit: applyMixerInitRt(d); break;
-        case RtCommandType::MixerParamSet: applyMixerParamSetRt(d); break;
-        case RtCommandType::MixerCompatMaster: applyMixerCompatMasterRt(d); break;
-        case RtCommandType::MixerCompatChannel: applyMixerCompatChannelRt(d); break;
-        case RtCommandType::FxChainSet: applyFxSetOpRt("fx.chain.set", d); break;
-        case RtCommandType::FxParamSet: applyFxSetOpRt("fx.param.set", d); break;
-        case RtCommandType::FxBypassSet: applyFxSetOpRt("fx.bypass.set", d); break;
-      }
-    }
-
-    for (int ch = 0; ch < outChs; ++ch)
-      if (out[ch]) juce::FloatVectorOperations::clear(out[ch], n);
-
-    if (playArmed.load()) {
-      playArmCountdownSamples -= n;
-      if (playArmCountdownSamples <= 0) {
-        playArmCountdownSamples = 0;
-        playArmed.store(false);
-        playing.store(true);
-      }
-    }
-    if (playArmed.load() && samplePos >= playStartSamplePos) {
-      playArmed.store(false);
-      playing.store(true);
-    }
-
-    // Prepare block events (sample accurate offsets)
-    if (playing.load())
-      prepareBlockEvents(n);
-    else
-      blockEvents.clear();
-
-    // Determine solo state (per block)
-    bool anySolo = false;
-    for (const auto& mc : mixerStates) { if (mc.solo) { anySolo = true; break; } }
-
-    // Iterate per-sample
-    size_t nextEv = 0;
-
-    for (int i = 0; i < n; ++i) {
-      // Fire scheduled events at this sample offset
-      while (nextEv < blockEvents.size() && blockEvents[nextEv].offset == i) {
-        dispatchOneEvent(blockEvents[nextEv].ev);
-        ++nextEv;
-      }
-
-      std::fill(busL.begin(), busL.end(), 0.0f);
-      std::fill(busR.begin(), busR.end(), 0.0f);
-
-      // Sample voices
-      for (auto& sv : sampleVoices) {
-        if (!sv.active || !sv.sample) continue;
-
-        const auto& b = sv.sample->buffer;
-        if (b.getNumSamples() <= 1) {
-          sv.active = false;
-          continue;
-        }
-
-        if (!sv.releasing && sv.loopEnabled && sv.loopEnd > sv.loopStart && sv.pos >= (double)sv.loopEnd)
-          sv.pos = wrapLoopPosition(sv.pos, sv.loopStart, sv.loopEnd);
-
-        const int ip = (int)sv.pos;
-        if (ip >= sv.end || ip >= b.getNumSamples() - 1) {
-          sv.active = false;
-          continue;
-        }
-
-        float amp = 1.0f;
-        if (sv.fadeInRemaining > 0) {
-          const int done = sv.fadeInTotal - sv.fadeInRemaining;
-          amp *= (float)done / (float)std::max(1, sv.fadeInTotal);
-          --sv.fadeInRemaining;
-        }
-
-        if (sv.releasing && sv.fadeOutRemaining > 0) {
-          amp *= (float)sv.fadeOutRemaining / (float)std::max(1, sv.fadeOutTotal);
-          --sv.fadeOutRemaining;
-          if (sv.fadeOutRemaining <= 0) {
-            sv.active = false;
-            continue;
-          }
-        }
-
-        if (sv.releasing && sv.releaseTailSamples > 0) {
-          const double samplesToEnd = (double)sv.end - sv.pos;
-          if (samplesToEnd <= 0.0) {
-            sv.active = false;
-            continue;
-          }
-          if (samplesToEnd <= (double)sv.releaseTailSamples)
-            amp *= (float)(samplesToEnd / (double)std::max(1, sv.releaseTailSamples));
-        }
-
-        const bool canLoopXf = !sv.releasing && sv.loopEnabled && sv.loopEnd > sv.loopStart && sv.loopCrossfadeSamples > 0;
-        const double prevPos = sv.pos;
-        const double nextPos = sv.pos + sv.rate;
-        const double loopLen = (double)std::max(1, sv.loopEnd - sv.loopStart);
-
-        float inL = 0.0f;
-        float inR = 0.0f;
-        const int rch = (b.getNumChannels() > 1) ? 1 : 0;
-
-        if (canLoopXf) {
-          const double xfadeS = (double)std::min(sv.loopCrossfadeSamples, std::max(1, sv.loopEnd - sv.loopStart - 1));
-          const bool entersCrossfade = prevPos < (double)sv.loopEnd && nextPos > (double)(sv.loopEnd - xfadeS);
-          if (xfadeS > 0.0 && entersCrossfade) {
-            const double crossPos = juce::jlimit((double)sv.loopEnd - xfadeS, (double)sv.loopEnd, prevPos);
-            const double distToLoopEnd = (double)sv.loopEnd - crossPos;
-            const float t = (float)juce::jlimit(0.0, 1.0, 1.0 - (distToLoopEnd / xfadeS));
-            const double wrapPos = crossPos - (double)sv.loopEnd + (double)sv.loopStart;
-            const float a = std::cos(t * juce::MathConstants<float>::halfPi);
-            const float bMix = std::sin(t * juce::MathConstants<float>::halfPi);
-
-            const float mainL = sampleAtHermite(b, 0, crossPos);
-            const float wrapL = sampleAtHermite(b, 0, wrapPos);
-            inL = mainL * a + wrapL * bMix;
-
-            const float mainR = sampleAtHermite(b, rch, crossPos);
-            const float wrapR = sampleAtHermite(b, rch, wrapPos);
-            inR = mainR * a + wrapR * bMix;
-          } else {
-            inL = sampleAtHermite(b, 0, prevPos);
-            inR = sampleAtHermite(b, rch, prevPos);
-          }
-        } else {
-          inL = sampleAtHermite(b, 0, prevPos);
-          inR = sampleAtHermite(b, rch, prevPos);
-        }
-
-        int idx = juce::jlimit(0, (int)mixerStates.size() - 1, sv.mixCh - 1);
-        const auto& mc = mixerStates[(size_t)idx];
-
-        sv.pos = nextPos;
-        if (!sv.releasing && sv.loopEnabled && sv.loopEnd > sv.loopStart && sv.pos >= (double)sv.loopEnd)
-          sv.pos = wrapLoopPosition(sv.pos, sv.loopStart, sv.loopEnd);
-
-        if (mc.mute || (anySolo && !mc.solo))
-          continue;
-
-        busL[(size_t)idx] += inL * sv.gainL * amp;
-        busR[(size_t)idx] += inR * sv.gainR * amp;
-      }
-
-      // Synth voices
-      for (auto& kv : fmRuntimes) {
-        auto& rt = kv.second;
-        if (rt.drums) {
-          if (!rt.drumRuntime) continue;
-          const auto taps = rt.drumRuntime->renderFrame();
-          for (const auto& tap : taps) {
-            const int tapIdx = juce::jlimit(0, (int)mixerStates.size() - 1, juce::jmax(1, tap.mixChannel) - 1);
-            const auto& tapMc = mixerStates[(size_t)tapIdx];
-            if (tapMc.mute || (anySolo && !tapMc.solo)) continue;
-            busL[(size_t)tapIdx] += tap.left;
-            busR[(size_t)tapIdx] += tap.right;
-          }
-        } else {
-          const int idx = juce::jlimit(0, (int)mixerStates.size() - 1, rt.mixCh - 1);
-          const auto& mc = mixerStates[(size_t)idx];
-          if (mc.mute || (anySolo && !mc.solo)) continue;
-          auto frame = rt.engine.renderFrame();
-          busL[(size_t)idx] += frame.first;
-          busR[(size_t)idx] += frame.second;
-        }
-      }
-
-      for (auto& v : voices) {
-        if (!v.active) continue;
-
-        const int atkS = std::max(1, (int)std::llround(v.attack * sampleRate));
-        const int decS = std::max(1, (int)std::llround(v.decay * sampleRate));
-        const int relS = std::max(1, (int)std::llround(v.release * sampleRate));
-
-        if (!v.releasing) {
-          if (v.ageSamples < atkS) v.env = (float)v.ageSamples / (float)atkS;
-          else if (v.ageSamples < atkS + decS) {
-            const float t = (float)(v.ageSamples - atkS) / (float)decS;
-            v.env = 1.0f - (1.0f - v.sustain) * t;
-          } else v.env = v.sustain;
-        } else {
-          const float mul = std::exp(std::log(0.0001f) / (float)relS);
-          v.env *= mul;
-          if (v.env < 0.0001f) { v.active = false; continue; }
-        }
-
-        float sig = 0.0f;
-        switch (v.waveform) {
-          default:
-          case 0: sig = (float)std::sin(v.phase); break;              // sine
-          case 1: sig = (float)((2.0 * (v.phase / kTwoPi)) - 1.0); break; // saw-ish
-          case 2: sig = (v.phase < kTwoPi * 0.5) ? 1.0f : -1.0f; break;   // square
-        }
-
-        v.phase += v.phaseInc;
-        if (v.phase > kTwoPi) v.phase -= kTwoPi;
-
-        int idx = juce::jlimit(0, (int)mixerStates.size() - 1, v.mixCh - 1);
-        const auto& mc = mixerStates[(size_t)idx];
-
-        if (mc.mute || (anySolo && !mc.solo)) { ++v.ageSamples; continue; }
-
-        const float amp = sig * v.velocity * v.gain * v.env * 0.2f;
-        busL[(size_t)idx] += amp;
-        busR[(size_t)idx] += amp;
-
-        ++v.ageSamples;
-      }
-
-      // Mix channels -> master
-      
-// Mix channels -> master
-float offL = 0.0f, offR = 0.0f; // OFF bus (always audible)
-float aL = 0.0f, aR = 0.0f;     // Deck A bus
-float bL = 0.0f, bR = 0.0f;     // Deck B bus
-bool anyAB = false;
-
-for (int ch = 0; ch < channelCount; ++ch) {
-  float cl = busL[(size_t)ch];
-  float cr = busR[(size_t)ch];
-
-  // EQ + FX
-  channelDsp[(size_t)ch].processEq(cl, cr);
-  processFxChain(channelDsp[(size_t)ch].fx, cl, cr, samplePos + i);
-
-  const auto& m = mixerStates[(size_t)ch];
-  const float chGain = channelSmoothers[(size_t)ch].gain.getNextValue();
-  const float pan = channelSmoothers[(size_t)ch].pan.getNextValue();
-  cl *= chGain;
-  cr *= chGain;
-
-  const float outL = cl * (1.0f - pan);
-  const float outR = cr * (1.0f + pan);
-
-  meterChPeakL[(size_t)ch] = std::max(meterChPeakL[(size_t)ch], std::abs(outL));
-  meterChPeakR[(size_t)ch] = std::max(meterChPeakR[(size_t)ch], std::abs(outR));
-  meterChRmsAccL[(size_t)ch] += outL * outL;
-  meterChRmsAccR[(size_t)ch] += outR * outR;
-
-  if (m.xAssign == 0) { aL += outL; aR += outR; anyAB = true; }
-  else if (m.xAssign == 1) { bL += outL; bR += outR; anyAB = true; }
-  else { offL += outL; offR += outR; }
-}
-
-float L = 0.0f, R = 0.0f;
-if (!anyAB) {
-  L = offL; R = offR;
-} else {
-  const float c = juce::jlimit(0.0f, 1.0f, masterCrossSmoothed.getNextValue());
-  // DJ-style additive crossfader law expected by UI:
-  // c=0.0  => A=1.0, B=0.0
-  // c=0.5  => A=1.0, B=1.0
-  // c=1.0  => A=0.0, B=1.0
-  const float gA = (c <= 0.5f) ? 1.0f : juce::jlimit(0.0f, 1.0f, (1.0f - c) * 2.0f);
-  const float gB = (c >= 0.5f) ? 1.0f : juce::jlimit(0.0f, 1.0f, c * 2.0f);
-  L = offL + (aL * gA) + (bL * gB);
-  R = offR + (aR * gA) + (bR * gB);
-}
-
-masterDsp.processEq(L, R);
-
-
-// Master FX
-processFxChain(masterFx, L, R, samplePos + i);
-
-// Master gain
-const float mg = masterGainSmoothed.getNextValue();
-L *= mg;
-R *= mg;
+    while (rtBudget-- > 0 && rtQueue.tryPop(cmd))
+      applyRtCommand(cmd, n);
 
-if (!anyAB) {
-  const float xf = juce::jlimit(-1.0f, 1.0f, crossfaderSmoothed.getNextValue());
-  const float xfL = (xf < 0.0f) ? 1.0f : (1.0f - xf);
-  const float xfR = (xf > 0.0f) ? 1.0f : (1.0f + xf);
-  L *= xfL;
-  R *= xfR;
-}
-
-// Output
-      L = sanitizeFinite(L);
-      R = sanitizeFinite(R);
-      if (outChs > 0 && out[0]) out[0][i] = L;
-      if (outChs > 1 && out[1]) out[1][i] = R;
-
-      // Master meters
-      meterPeakL = std::max(meterPeakL, std::abs(L));
-      meterPeakR = std::max(meterPeakR, std::abs(R));
-      meterRmsAccL += L * L;
-      meterRmsAccR += R * R;
-    }
-
-    // Advance transport only while actually playing
-    if (playing.load()) samplePos += n;
-
-    // Transport range authority: the engine decides loop / stop-at-end.
-    if (playing.load()) {
-      std::scoped_lock lk(stateMutex);
-      if (transportHasActiveRange()) {
-        const auto startSample = ppqToSamples(transportRangeStartPpq);
-        const auto endSample = ppqToSamples(transportRangeEndPpq);
-        if (samplePos >= endSample) {
-          if (transportLoopEnabled) {
-            const auto loopLen = std::max<juce::int64>(1, endSample - startSample);
-            const auto overflow = samplePos - endSample;
-            samplePos = startSample + (overflow % loopLen);
-            resetSchedulerCursorForPpq(samplesToPpq(samplePos));
-          } else if (transportStopAtEnd) {
-            playing.store(false);
-            playArmed.store(false);
-            playArmCountdownSamples = 0;
-            samplePos = transportReturnToStartOnStop ? startSample : endSample;
-            resetSchedulerCursorForPpq(samplesToPpq(samplePos));
-            panic();
-          }
-        }
-      }
+    // Devices may deliver more frames than the render buffers hold: render in chunks.
+    const int chunkCapacity = juce::jmax(1, busL.getNumSamples());
+    for (int done = 0; done < n;) {
+      const int len = juce::jmin(chunkCapacity, n - done);
+      renderBlock(out, outChs, done, len);
+      done += len;
     }
 
-    // Finalize RMS per block
+    // Finalize RMS per callback
     meterRmsL = (float)std::sqrt(meterRmsAccL / (double)std::max(1, n));
     meterRmsR = (float)std::sqrt(meterRmsAccR / (double)std::max(1, n));
     meterRmsAccL = 0.0;
@@ -1081,6 +939,46 @@ if (!anyAB) {
     }
   }
 
+  // Audio thread, once per device callback: snapshot of meters and transport under the seqlock,
+  // mirrored into the binary transport mapping when one is open. Readers never block this.
+  void publishTelemetry(int n, juce::int64 hostTimeNs) {
+    auto& t = telemetryScratch;
+    t.blockCounter = ++telemetryBlocks;
+    t.hostTimeNs = hostTimeNs;
+    t.samplePos = samplePos;
+    t.ppq = samplesToPpq(samplePos);
+    t.bpm = bpm.load();
+    t.sampleRate = sampleRate;
+    t.blockSize = n;
+    t.playing = (playing.load() || playArmed.load()) ? 1 : 0;
+    t.master = { -1, { meterRmsL, meterRmsR }, { meterPeakL, meterPeakR } };
+
+    const int chs = std::min({ channelCount, (int)meterChPeakL.size(), sls::ipc::kTelemetryChannels });
+    t.numChannels = chs;
+    for (int ch = 0; ch < chs; ++ch) {
+      const auto i = (size_t)ch;
+      t.channels[i] = { ch, { meterChRmsL[i], meterChRmsR[i] }, { meterChPeakL[i], meterChPeakR[i] } };
+    }
+
+    sls::ipc::publishTelemetry(telemetry, t);
+
+    bool resetPeaks = meterPeakReset.exchange(false);
+    sharedTelemetryBusy.store(true);
+    if (auto* shared = sharedTelemetry.load()) {
+      sls::ipc::publishTelemetry(*shared, t);
+      if (shared->peakReset.exchange(0) != 0) resetPeaks = true;
+    }
+    sharedTelemetryBusy.store(false);
+
+    // Peaks hold until a reader has seen them.
+    if (resetPeaks) {
+      meterPeakL = 0.0f;
+      meterPeakR = 0.0f;
+      std::fill(meterChPeakL.begin(), meterChPeakL.end(), 0.0f);
+      std::fill(meterChPeakR.begin(), meterChPeakR.end(), 0.0f);
+    }
+  }
+
 private:
   // ------------------------------ JUCE devices ------------------------------
 
@@ -1090,8 +988,8 @@ private:
   // ------------------------------ Synchronization ------------------------------
 
   std::mutex ioMutex;
-  std::mutex audioMutex;
-  std::mutex stateMutex;
+  std::mutex stateMutex;  // published timeline and project sync (never taken on the audio thread)
+  std::mutex deviceMutex; // device open/close vs. stats readers (never taken on the audio thread)
 
   std::atomic<bool> running { true };
   std::atomic<bool> playing { false };
@@ -1100,6 +998,23 @@ private:
   std::atomic<double> playPrerollMs { 120.0 };
   std::thread stateThread;
 
+  // ------------------------------ Offline render ------------------------------
+
+  struct BounceSettings {
+    juce::File file;
+    juce::String format;
+    int bitDepth = 24;
+    double fromPpq = 0.0;
+    double toPpq = 0.0;
+    double tailSec = 0.0;
+  };
+
+  const bool useAudioDevice;
+  std::thread bounceThread;
+  std::atomic<bool> bouncing { false };
+  std::atomic<bool> bounceCancel { false };
+  std::atomic<bool> bounceSucceeded { false };
+
   // ------------------------------ Engine state ------------------------------
 
   bool ready = false;
@@ -1122,23 +1037,81 @@ private:
   juce::int64 samplePos = 0;
   juce::int64 playArmCountdownSamples = 0;
   juce::int64 playStartSamplePos = 0;
-  juce::String transportPlayMode = "song";
-  double transportRangeStartPpq = 0.0;
-  double transportRangeEndPpq = 0.0;
-  bool transportLoopEnabled = false;
-  bool transportStopAtEnd = true;
-  bool transportReturnToStartOnStop = true;
 
   // ------------------------------ Voices & assets ------------------------------
 
   std::vector<Voice> voices;
   std::vector<SampleVoice> sampleVoices;
 
-  std::unordered_map<juce::String, std::shared_ptr<SampleData>> sampleCache;
-  std::unordered_map<juce::String, InstrumentState> instruments;
+  // Rebuilt by renderSources before each channel fan-out (audio thread).
+  ChannelBuckets synthVoicesByBus;
+  ChannelBuckets sampleVoicesByBus;
+  ChannelBuckets touskiVoicesByBus;
+  std::vector<FmRuntime*> fmByBus; // per channel: FM engines, linked through nextOnBus
+  FmRuntime* fmDrums = nullptr;    // drum kits route each piece to its own bus
+
+  // sampleId -> sample for sampler.load; the data itself lives in samplePool, shared with
+  // samplePath auto-loads and Touski zones loading the same files.
+  std::unordered_map<juce::String, std::shared_ptr<const SampleData>> sampleCache;
+  sls::sampler::SamplePool samplePool { [this](const juce::File& f, bool allowStreaming, double targetRate,
+                                                const sls::sampler::SamplePool::Progress& progress) {
+    return loadSampleFromPath(f.getFullPathName(), allowStreaming, targetRate, progress);
+  } };
+  // Samples a retarget replaced, kept until the voices still playing them let go.
+  RtReleasePool<const SampleData> retiredSamples;
+
+  // Touski loop seams per (sample, loop parameters), analysed by load and param jobs.
+  sls::sampler::LoopPointCache loopPointCache;
+
+  // Guards sampleCache and touskiInstrument against load jobs. Never taken on the audio thread:
+  // scheduled sampler.trigger events carry their sample and Touski notes play from touskiPrograms.
+  std::mutex assetMutex;
+
+  // Heavy loads (sampler.load, touski.program.load, samplePath auto-loads) run here, answered
+  // at once with a jobId and finished by an event; the IPC thread never decodes.
+  sls::sampler::SampleDecoder sampleDecoder { defaultDecoderThreads() };
+  std::atomic<int> nextLoadJobId { 1 };
+  std::atomic<int> loadJobsPending { 0 };
+
+  // sampler.load files longer than the threshold are streamed from disk (0 = always decode fully);
+  // the budget bounds the read-ahead rings of all playing streamed voices.
+  sls::sampler::SampleStreamer sampleStreamer;
+  double sampleStreamThresholdSec = 20.0;
+  int sampleStreamBudgetMB = 64;
+
+  // Decoded samples are converted to the engine rate; keeping the file-rate data as well lets a
+  // later rate change convert from it instead of converting twice.
+  bool sampleKeepOriginal = false;
+
+  // sampleStorage "int16": new fully decoded samples are stored as 16-bit PCM (half the memory of
+  // float, converted back as voices read them). Streamed heads and kept originals stay float.
+  bool sampleStorageInt16 = false;
+
+  // Decoded bytes the pool may hold, unreferenced samples included, before it evicts those (LRU).
+  int samplePoolBudgetMB = (int)(sls::sampler::SamplePool::kDefaultBudgetBytes >> 20);
+
+  // Decoded compressed samples on disk, mapped by later loads instead of decoding (0 MB = off).
+  sls::sampler::PcmDiskCache pcmDiskCache;
+  int pcmCacheMB = (int)(sls::sampler::PcmDiskCache::kDefaultBudgetBytes >> 20);
+
+  std::shared_ptr<const InstrumentTable> instruments; // audio thread
   sls::inst::InstrumentRegistry instrumentRegistry;
   sls::inst::SampleTouskiInstrument touskiInstrument;
-  std::unordered_map<std::string, FmRuntime> fmRuntimes;
+  sls::inst::SampleTouskiRuntime touskiRuntime { kMaxTouskiVoices }; // audio thread (voices, grains)
+
+  // The Touski programs as the audio thread last received them. Every change to touskiInstrument
+  // publishes a copy of its table (publishTouskiPrograms); tables stay pooled until unused.
+  std::shared_ptr<const TouskiProgramTable> touskiPrograms; // audio thread
+  RtReleasePool<const TouskiProgramTable> touskiProgramTables;
+  std::atomic<bool> touskiProgramsStale { false }; // the last publish found the queue full
+
+  // Request side of the instruments: the table last published to the audio thread. inst.create
+  // and inst.param.set build the next one here (states, FM runtimes, compiled patches). Tables and
+  // patches stay pooled until the audio thread has let go of them, and are freed here.
+  std::mutex instrumentMutex;
+  std::shared_ptr<const InstrumentTable> publishedInstruments;
+  RtReleasePool<const InstrumentTable> instrumentTables;
+  sls::engine::fm::FmPatchLibrary fmPatchLibrary;
   std::unordered_map<std::string, VstRuntimeState> vstRuntimes;
 
   // ------------------------------ Mixer & FX ------------------------------
@@ -1149,29 +1122,44 @@ private:
   ChannelDSP masterDsp;
   std::vector<std::unique_ptr<FxUnit>> masterFx;
 
-  // bus buffers (avoid alloc in callback)
-  std::vector<float> busL;
-  std::vector<float> busR;
+  // render buffers (avoid alloc in callback): one channel per mixer channel, plus the OFF / A / B decks and master
+  static constexpr int kRenderBlockSize = 512;
+  juce::AudioBuffer<float> busL;
+  juce::AudioBuffer<float> busR;
+  juce::AudioBuffer<float> offBus;
+  juce::AudioBuffer<float> deckABus;
+  juce::AudioBuffer<float> deckBBus;
+  juce::AudioBuffer<float> masterBus;
+
+  // render graph: per-channel source and strip tasks, shared with renderThreads workers
+  RenderWorkerPool renderPool;
+  int renderThreads = defaultRenderThreads();
+  int segmentStart = 0;
+  int segmentLength = 0;
+  bool stripAnySolo = false;
 
   // ------------------------------ Scheduler ------------------------------
 
-  std::vector<ScheduledEvent> scheduler;
+  // timeline and schedulerCursor (first event not dispatched yet) belong to the audio thread.
+  // publishedTimeline is the request side's latest, guarded by stateMutex.
+  std::shared_ptr<const Timeline> timeline;
   size_t schedulerCursor = 0;
-  double scheduleWindowFromPpq = 0.0;
-  double scheduleWindowToPpq = 0.0;
+  std::shared_ptr<const Timeline> publishedTimeline;
+  RtReleasePool<const Timeline> timelines;
   juce::var lastProjectSync;
   bool schedulerDebug = false;
 
   std::vector<BlockEvent> blockEvents;
 
   static constexpr int kRtQueueCapacity = 2048;
-  std::array<RtCommand, kRtQueueCapacity> rtQueue;
-  std::atomic<uint32_t> rtWriteIdx { 0 };
-  std::atomic<uint32_t> rtReadIdx { 0 };
+  RtEventQueue<RtCommand> rtQueue { (size_t)kRtQueueCapacity };
+  std::vector<BlockEvent> liveEvents; // live events with a sample offset, merged into blockEvents
 
   std::atomic<uint64_t> rtQueueOverflowCount { 0 };
   std::atomic<uint64_t> nanSanitizedSamples { 0 };
 
+  AudioCallbackStats callbackStats;
+
   // ------------------------------ Metering ------------------------------
 
   bool meterSubscribed = false;
@@ -1184,15 +1172,51 @@ private:
 
   std::vector<float>  meterChPeakL, meterChPeakR, meterChRmsL, meterChRmsR;
   std::vector<double> meterChRmsAccL, meterChRmsAccR;
+  std::vector<sls::ipc::ShmMeterFrame> meterFrames; // event pump scratch
+
+  // Telemetry block: written by the audio thread only (publishTelemetry), read through the seqlock.
+  sls::ipc::ShmTelemetry telemetry {};
+  sls::ipc::ShmTelemetryData telemetryScratch {};   // audio thread only
+  sls::ipc::ShmTelemetryData telemetryRead {};      // event pump only
+  uint64_t telemetryBlocks = 0;
+  std::atomic<bool> meterPeakReset { false };       // event pump -> audio thread
+
+  // ------------------------------ Binary IPC ------------------------------
+
+  sls::ipc::ShmIpcTransport shm;
+  std::mutex shmWriteMutex;          // toClient ring producers (event pump, binary reader) and open/close
+  std::thread binaryThread;
+  std::atomic<bool> binaryRunning { false };
+  std::atomic<bool> binaryEvents { true };
+  std::atomic<bool> binaryTelemetry { false };     // periodic meter/transport events replaced by the shared block
+  std::atomic<sls::ipc::ShmTelemetry*> sharedTelemetry { nullptr };
+  std::atomic<bool> sharedTelemetryBusy { false }; // audio thread is writing through sharedTelemetry
+  std::vector<uint8_t> binaryScratch; // event pump only
 
   // ------------------------------ Setup ------------------------------
 
   void setupAudio() {
+    if (!useAudioDevice) {
+      // Headless: behave as if a device had started with the configured format.
+      ready = true;
+      prepareRenderBuffers();
+      {
+        std::scoped_lock lk(assetMutex);
+        touskiInstrument.setSampleRate(sampleRate);
+        publishTouskiPrograms();
+      }
+      touskiRuntime.setSampleRate(sampleRate);
+      retargetSamples(sampleRate);
+      return;
+    }
+    std::scoped_lock lk(deviceMutex);
     deviceManager.initialise(numIn, numOut, nullptr, true, {}, nullptr);
     deviceManager.addAudioCallback(this);
   }
 
   void shutdownAudio() {
+    if (!useAudioDevice) return;
+    std::scoped_lock lk(deviceMutex);
     deviceManager.removeAudioCallback(this);
     deviceManager.closeAudioDevice();
   }
@@ -1206,6 +1230,25 @@ private:
     meterChRmsAccR.assign((size_t)channels, 0.0);
   }
 
+  void prepareRenderBuffers() {
+    const int frames = juce::jmax(kRenderBlockSize, bufferSize);
+    const int buses = juce::jmax(1, channelCount);
+    busL.setSize(buses, frames, false, true, true);
+    busR.setSize(buses, frames, false, true, true);
+    offBus.setSize(2, frames, false, true, true);
+    deckABus.setSize(2, frames, false, true, true);
+    deckBBus.setSize(2, frames, false, true, true);
+    masterBus.setSize(2, frames, false, true, true);
+  }
+
+  static int defaultRenderThreads() {
+    return juce::jlimit(0, 3, juce::SystemStats::getNumPhysicalCpus() - 1);
+  }
+
+  static int defaultDecoderThreads() {
+    return juce::jlimit(1, 4, juce::SystemStats::getNumCpus() - 1);
+  }
+
   InstrumentState defaultsForType(const juce::String& type) const {
     return instrumentRegistry.defaultsForType(type);
   }
@@ -1220,13 +1263,12 @@ private:
     return (juce::int64)std::llround((ppq / std::max(1e-9, bps)) * std::max(1.0, sampleRate));
   }
 
-  bool transportHasActiveRange() const {
-    return transportRangeEndPpq > transportRangeStartPpq;
-  }
-
+  // Audio thread.
   void resetSchedulerCursorForPpq(double ppq) {
-    schedulerCursor = 0;
-    while (schedulerCursor < scheduler.size() && scheduler[schedulerCursor].atPpq < ppq) ++schedulerCursor;
+    const auto& events = *timeline->events;
+    schedulerCursor = (size_t)std::distance(events.begin(),
+        std::lower_bound(events.begin(), events.end(), ppq,
+                         [](const ScheduledEvent& e, double v) { return e.atPpq < v; }));
   }
 
   // ------------------------------ EQ / DSP ------------------------------
@@ -1237,27 +1279,12 @@ private:
     auto& dsp = channelDsp[(size_t)ch];
     const auto& m = mixerStates[(size_t)ch];
 
-    const auto sr = std::max(22050.0, sampleRate);
-
-    dsp.lowL.coefficients  = juce::dsp::IIR::Coefficients<float>::makeLowShelf (sr, 120.0f,  0.707f, juce::Decibels::decibelsToGain(m.eqLow));
-    dsp.lowR.coefficients  = juce::dsp::IIR::Coefficients<float>::makeLowShelf (sr, 120.0f,  0.707f, juce::Decibels::decibelsToGain(m.eqLow));
-    dsp.midL.coefficients  = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sr, 1200.0f, 0.9f,   juce::Decibels::decibelsToGain(m.eqMid));
-    dsp.midR.coefficients  = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sr, 1200.0f, 0.9f,   juce::Decibels::decibelsToGain(m.eqMid));
-    dsp.highL.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sr, 8000.0f,  0.707f, juce::Decibels::decibelsToGain(m.eqHigh));
-    dsp.highR.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sr, 8000.0f,  0.707f, juce::Decibels::decibelsToGain(m.eqHigh));
-
+    dsp.setEq(std::max(22050.0, sampleRate), m.eqLow, m.eqMid, m.eqHigh);
   }
 
 
 void refreshMasterEq() {
-  const auto sr = std::max(22050.0, sampleRate);
-
-  masterDsp.lowL.coefficients  = juce::dsp::IIR::Coefficients<float>::makeLowShelf (sr, 120.0f,  0.707f, juce::Decibels::decibelsToGain(masterEqLow));
-  masterDsp.lowR.coefficients  = juce::dsp::IIR::Coefficients<float>::makeLowShelf (sr, 120.0f,  0.707f, juce::Decibels::decibelsToGain(masterEqLow));
-  masterDsp.midL.coefficients  = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sr, 1200.0f, 0.9f,   juce::Decibels::decibelsToGain(masterEqMid));
-  masterDsp.midR.coefficients  = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sr, 1200.0f, 0.9f,   juce::Decibels::decibelsToGain(masterEqMid));
-  masterDsp.highL.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sr, 8000.0f,  0.707f, juce::Decibels::decibelsToGain(masterEqHigh));
-  masterDsp.highR.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sr, 8000.0f,  0.707f, juce::Decibels::decibelsToGain(masterEqHigh));
+  masterDsp.setEq(std::max(22050.0, sampleRate), masterEqLow, masterEqMid, masterEqHigh);
 }
 
   void refreshDspSpecs() {
@@ -1450,7 +1477,7 @@ void refreshMasterEq() {
     return resOk(op, id, juce::var());
   }
 
-  void processFxChain(std::vector<std::unique_ptr<FxUnit>>& fx, float& l, float& r, int64_t samplePosNow) {
+  void processFxChain(std::vector<std::unique_ptr<FxUnit>>& fx, float* l, float* r, int n, int64_t samplePosNow) {
     for (auto& uPtr : fx) {
       if (!uPtr) continue;
       auto& u = *uPtr;
@@ -1466,7 +1493,7 @@ void refreshMasterEq() {
         p.dryLevel = 1.0f;
         p.width    = juce::jlimit(0.0f, 1.0f, u.getParam("width",    1.0f));
         u.reverb.setParameters(p);
-        u.reverb.processStereo(&l, &r, 1);
+        u.reverb.processStereo(l, r, n);
         continue;
       }
 
@@ -1474,76 +1501,333 @@ void refreshMasterEq() {
         ensureFxDsp(u);
         if (!u.dsp) continue;
 
-        float chansData[2] = { l, r };
-        float* chans[2] = { &chansData[0], &chansData[1] };
-        u.dsp->process(chans, 2, 1, bpm.load(), samplePosNow, playing.load());
-        l = chansData[0];
-        r = chansData[1];
+        float* chans[2] = { l, r };
+        u.dsp->process(chans, 2, n, bpm.load(), samplePosNow, playing.load());
         continue;
       }
     }
   }
 
-  // ------------------------------ Synth voice management ------------------------------
+  // ------------------------------ Block render ------------------------------
 
+  // Renders n frames into out[..][startSample..]. n never exceeds the render buffer size.
+  void renderBlock(float* const* out, int outChs, int startSample, int n) {
+    for (int ch = 0; ch < outChs; ++ch)
+      if (out[ch]) juce::FloatVectorOperations::clear(out[ch] + startSample, n);
 
-  FmRuntime& ensureFmRuntime(const juce::String& instId, int mixCh, const InstrumentState& st, bool syncState) {
-    const auto key = instId.toStdString();
-    auto [it, inserted] = fmRuntimes.try_emplace(key);
-    auto& rt = it->second;
+    if (playArmed.load()) {
+      playArmCountdownSamples -= n;
+      if (playArmCountdownSamples <= 0) {
+        playArmCountdownSamples = 0;
+        playArmed.store(false);
+        playing.store(true);
+      }
+    }
+    if (playArmed.load() && samplePos >= playStartSamplePos) {
+      playArmed.store(false);
+      playing.store(true);
+    }
 
-    const auto desiredPolyRaw = std::max(1, st.polyphony);
-    const auto desiredPoly = juce::jlimit(1, 64, desiredPolyRaw);
-    const bool desiredDrums = st.type.trim().toLowerCase().contains("drum");
-    const auto drumPreparedVoices = juce::jlimit(8, 32, desiredPoly);
+    // Prepare block events (sample accurate offsets)
+    if (playing.load())
+      prepareBlockEvents(n);
+    else
+      blockEvents.clear();
+    mergeLiveEvents(startSample, n);
 
-    if (inserted || rt.type != st.type || rt.polyphony != desiredPoly || rt.drums != desiredDrums) {
-      rt = FmRuntime{};
-      rt.instId = instId;
-      rt.type = st.type;
-      rt.mixCh = juce::jmax(1, mixCh);
-      rt.polyphony = desiredPoly;
-      rt.drums = desiredDrums;
+    busL.clear(0, n);
+    busR.clear(0, n);
 
-      if (rt.drums) {
-        rt.drumRuntime = std::make_unique<sls::engine::DrumRuntime>();
-        rt.drumRuntime->prepare(sampleRate, drumPreparedVoices);
-        rt.drumRuntime->prepare(sampleRate, std::max(12, desiredPoly));
-        rt.drumRuntime->syncFromInstrumentState(st);
-      } else {
-        rt.engine.prepare(sampleRate, desiredPoly);
-        rt.patch = makeFmPatchForState(st);
-        rt.engine.setPatch(rt.patch);
+    // Sources render whole sub-blocks between event offsets
+    size_t nextEv = 0;
+    for (int pos = 0; pos < n;) {
+      while (nextEv < blockEvents.size() && blockEvents[nextEv].offset <= pos) {
+        dispatchOneEvent(blockEvents[nextEv].ev);
+        ++nextEv;
       }
+      const int segEnd = nextEv < blockEvents.size() ? blockEvents[nextEv].offset : n;
+      renderSources(pos, segEnd - pos);
+      pos = segEnd;
     }
 
-    rt.mixCh = juce::jmax(1, mixCh);
+    const bool anyAB = mixChannels(n);
+    renderMaster(out, outChs, startSample, n, anyAB);
 
-    if (syncState) {
-      if (rt.drums) {
-        if (!rt.drumRuntime) {
-          rt.drumRuntime = std::make_unique<sls::engine::DrumRuntime>();
-          rt.drumRuntime->prepare(sampleRate, drumPreparedVoices);
-          rt.drumRuntime->prepare(sampleRate, std::max(12, desiredPoly));
+    // Advance transport only while actually playing
+    if (playing.load()) samplePos += n;
+
+    // Transport range authority: the engine decides loop / stop-at-end.
+    if (playing.load() && timeline->hasRange()) {
+      const auto& tl = *timeline;
+      const auto rangeStartSample = ppqToSamples(tl.rangeStartPpq);
+      const auto endSample = ppqToSamples(tl.rangeEndPpq);
+      if (samplePos >= endSample) {
+        if (tl.loop) {
+          const auto loopLen = std::max<juce::int64>(1, endSample - rangeStartSample);
+          const auto overflow = samplePos - endSample;
+          samplePos = rangeStartSample + (overflow % loopLen);
+          resetSchedulerCursorForPpq(samplesToPpq(samplePos));
+        } else if (tl.stopAtEnd) {
+          playing.store(false);
+          playArmed.store(false);
+          playArmCountdownSamples = 0;
+          samplePos = tl.returnToStartOnStop ? rangeStartSample : endSample;
+          resetSchedulerCursorForPpq(samplesToPpq(samplePos));
+          panic();
         }
-        rt.drumRuntime->syncFromInstrumentState(st);
+      }
+    }
+  }
+
+  // Moves live events that fall in [startSample, startSample + n) into blockEvents, keeping offset order.
+  void mergeLiveEvents(int startSample, int n) {
+    if (liveEvents.empty()) return;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < liveEvents.size(); ++i) {
+      auto& le = liveEvents[i];
+      if (le.offset < startSample + n) {
+        const int offset = juce::jmax(0, le.offset - startSample);
+        const auto at = std::upper_bound(blockEvents.begin(), blockEvents.end(), offset,
+                                         [](int off, const BlockEvent& b) { return off < b.offset; });
+        blockEvents.insert(at, BlockEvent{ offset, std::move(le.ev) });
       } else {
-        rt.patch = makeFmPatchForState(st);
-        rt.engine.setPatch(rt.patch);
+        if (kept != i) liveEvents[kept] = std::move(le);
+        ++kept;
       }
     }
+    liveEvents.erase(liveEvents.begin() + (std::ptrdiff_t)kept, liveEvents.end());
+  }
+
+  // Adds every source into its mixer channel bus for frames [start, start + len).
+  // One task per channel: a voice only ever touches its own channel, and each channel
+  // sums its sources in the same order whether the pool runs it or the caller does.
+  void renderSources(int start, int len) {
+    if (len <= 0) return;
+    segmentStart = start;
+    segmentLength = len;
+    bucketSourcesByBus();
+    renderPool.run(busL.getNumChannels(), &Engine::renderChannelSourcesTask, this);
+  }
+
+  // Sorts the active sources by channel once, so the channel tasks do not each scan them all.
+  void bucketSourcesByBus() {
+    const int numBuses = busL.getNumChannels();
+    const auto busIndex = [numBuses](int mixCh) { return juce::jlimit(0, numBuses - 1, mixCh - 1); };
+
+    sampleVoicesByBus.build((int)sampleVoices.size(), [&](int i) {
+      const auto& sv = sampleVoices[(size_t)i];
+      return sv.active ? busIndex(sv.mixCh) : -1;
+    });
+    synthVoicesByBus.build((int)voices.size(), [&](int i) {
+      const auto& v = voices[(size_t)i];
+      return v.active ? busIndex(v.mixCh) : -1;
+    });
+    const auto& touskiVoices = touskiRuntime.getVoices();
+    touskiVoicesByBus.build((int)touskiVoices.size(), [&](int i) {
+      const auto& tv = touskiVoices[(size_t)i];
+      return tv.active ? busIndex(tv.mixCh) : -1;
+    });
+
+    // Linked in table order; the tails only live for this pass.
+    std::fill(fmByBus.begin(), fmByBus.end(), nullptr);
+    FmRuntime* fmTails[kMaxMixerChannels] {};
+    FmRuntime* drumsTail = nullptr;
+    fmDrums = nullptr;
+    for (const auto& kv : *instruments) {
+      FmRuntime* rt = kv.second.fm.get();
+      if (!rt) continue;
+      rt->nextOnBus = nullptr;
+      if (rt->drums) {
+        if (!rt->drumRuntime) continue;
+        (drumsTail ? drumsTail->nextOnBus : fmDrums) = rt;
+        drumsTail = rt;
+      } else {
+        const auto ch = (size_t)busIndex(rt->mixCh);
+        (fmTails[ch] ? fmTails[ch]->nextOnBus : fmByBus[ch]) = rt;
+        fmTails[ch] = rt;
+      }
+    }
+  }
 
-    return rt;
+  static void renderChannelSourcesTask(void* self, int ch) {
+    auto* e = static_cast<Engine*>(self);
+    e->renderChannelSources(ch, e->segmentStart, e->segmentLength);
+  }
+
+  void renderChannelSources(int ch, int start, int len) {
+    float* l = busL.getWritePointer(ch) + start;
+    float* r = busR.getWritePointer(ch) + start;
+    const int numBuses = busL.getNumChannels();
+
+    // Sample voices
+    for (const int* i = sampleVoicesByBus.begin(ch); i != sampleVoicesByBus.end(ch); ++i)
+      renderSampleVoiceBlock(sampleVoices[(size_t)*i], l, r, len);
+    for (const int* i = touskiVoicesByBus.begin(ch); i != touskiVoicesByBus.end(ch); ++i)
+      touskiRuntime.renderVoice(*i, l, r, len);
+
+    // Synth voices
+    for (FmRuntime* rt = fmByBus[(size_t)ch]; rt; rt = rt->nextOnBus)
+      rt->engine.renderBlock(l, r, len);
+    for (FmRuntime* rt = fmDrums; rt; rt = rt->nextOnBus)
+      rt->drumRuntime->renderBus(ch, numBuses, l, r, len);
+
+    for (const int* i = synthVoicesByBus.begin(ch); i != synthVoicesByBus.end(ch); ++i)
+      renderSynthVoiceBlock(voices[(size_t)*i], l, r, len);
+  }
+
+  // Channel strips (mute/solo, EQ, FX, gain/pan, meters) summed into the OFF / A / B decks.
+  // Strips run as independent tasks; the deck sums stay serial in channel order so the
+  // result does not depend on how many render threads are used.
+  // Returns true when any channel is assigned to deck A or B.
+  bool mixChannels(int n) {
+    stripAnySolo = false;
+    for (const auto& mc : mixerStates) { if (mc.solo) { stripAnySolo = true; break; } }
+
+    const int numChannels = juce::jmin(channelCount, busL.getNumChannels(), (int)mixerStates.size());
+    segmentLength = n;
+    renderPool.run(numChannels, &Engine::processChannelStripTask, this);
+
+    offBus.clear(0, n);
+    deckABus.clear(0, n);
+    deckBBus.clear(0, n);
+    bool anyAB = false;
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+      const int xAssign = mixerStates[(size_t)ch].xAssign;
+      auto& deck = (xAssign == 0) ? deckABus : (xAssign == 1) ? deckBBus : offBus;
+      if (xAssign == 0 || xAssign == 1) anyAB = true;
+      juce::FloatVectorOperations::add(deck.getWritePointer(0), busL.getReadPointer(ch), n);
+      juce::FloatVectorOperations::add(deck.getWritePointer(1), busR.getReadPointer(ch), n);
+    }
+
+    return anyAB;
   }
 
+  static void processChannelStripTask(void* self, int ch) {
+    auto* e = static_cast<Engine*>(self);
+    e->processChannelStrip(ch, e->segmentLength, e->stripAnySolo);
+  }
+
+  void processChannelStrip(int ch, int n, bool anySolo) {
+    float* l = busL.getWritePointer(ch);
+    float* r = busR.getWritePointer(ch);
+    const auto& m = mixerStates[(size_t)ch];
+
+    // Muted channels still run EQ / FX so tails decay naturally
+    if (m.mute || (anySolo && !m.solo)) {
+      juce::FloatVectorOperations::clear(l, n);
+      juce::FloatVectorOperations::clear(r, n);
+    }
+
+    auto& dsp = channelDsp[(size_t)ch];
+    dsp.processEq(l, r, n);
+    processFxChain(dsp.fx, l, r, n, samplePos);
+
+    auto& sm = channelSmoothers[(size_t)ch];
+    if (sm.gain.isSmoothing() || sm.pan.isSmoothing()) {
+      for (int i = 0; i < n; ++i) {
+        const float chGain = sm.gain.getNextValue();
+        const float pan = sm.pan.getNextValue();
+        l[i] = (l[i] * chGain) * (1.0f - pan);
+        r[i] = (r[i] * chGain) * (1.0f + pan);
+      }
+    } else {
+      const float chGain = sm.gain.getTargetValue();
+      const float pan = sm.pan.getTargetValue();
+      juce::FloatVectorOperations::multiply(l, chGain, n);
+      juce::FloatVectorOperations::multiply(r, chGain, n);
+      juce::FloatVectorOperations::multiply(l, 1.0f - pan, n);
+      juce::FloatVectorOperations::multiply(r, 1.0f + pan, n);
+    }
+
+    const auto rangeL = juce::FloatVectorOperations::findMinAndMax(l, n);
+    const auto rangeR = juce::FloatVectorOperations::findMinAndMax(r, n);
+    meterChPeakL[(size_t)ch] = std::max({ meterChPeakL[(size_t)ch], -rangeL.getStart(), rangeL.getEnd() });
+    meterChPeakR[(size_t)ch] = std::max({ meterChPeakR[(size_t)ch], -rangeR.getStart(), rangeR.getEnd() });
+    for (int i = 0; i < n; ++i) {
+      meterChRmsAccL[(size_t)ch] += l[i] * l[i];
+      meterChRmsAccR[(size_t)ch] += r[i] * r[i];
+    }
+  }
+
+  // Crossfader, master EQ / FX / gain, sanitizing and master meters.
+  void renderMaster(float* const* out, int outChs, int startSample, int n, bool anyAB) {
+    float* L = masterBus.getWritePointer(0);
+    float* R = masterBus.getWritePointer(1);
+    const float* offL = offBus.getReadPointer(0);
+    const float* offR = offBus.getReadPointer(1);
+
+    if (!anyAB) {
+      juce::FloatVectorOperations::copy(L, offL, n);
+      juce::FloatVectorOperations::copy(R, offR, n);
+    } else {
+      const float* aL = deckABus.getReadPointer(0);
+      const float* aR = deckABus.getReadPointer(1);
+      const float* bL = deckBBus.getReadPointer(0);
+      const float* bR = deckBBus.getReadPointer(1);
+      for (int i = 0; i < n; ++i) {
+        const float c = juce::jlimit(0.0f, 1.0f, masterCrossSmoothed.getNextValue());
+        // DJ-style additive crossfader law expected by UI:
+        // c=0.0  => A=1.0, B=0.0
+        // c=0.5  => A=1.0, B=1.0
+        // c=1.0  => A=0.0, B=1.0
+        const float gA = (c <= 0.5f) ? 1.0f : juce::jlimit(0.0f, 1.0f, (1.0f - c) * 2.0f);
+        const float gB = (c >= 0.5f) ? 1.0f : juce::jlimit(0.0f, 1.0f, c * 2.0f);
+        L[i] = offL[i] + (aL[i] * gA) + (bL[i] * gB);
+        R[i] = offR[i] + (aR[i] * gA) + (bR[i] * gB);
+      }
+    }
+
+    masterDsp.processEq(L, R, n);
+
+    // Master FX
+    processFxChain(masterFx, L, R, n, samplePos);
+
+    float* outL = (outChs > 0 && out[0]) ? out[0] + startSample : nullptr;
+    float* outR = (outChs > 1 && out[1]) ? out[1] + startSample : nullptr;
+
+    for (int i = 0; i < n; ++i) {
+      // Master gain
+      const float mg = masterGainSmoothed.getNextValue();
+      float l = L[i] * mg;
+      float r = R[i] * mg;
+
+      if (!anyAB) {
+        const float xf = juce::jlimit(-1.0f, 1.0f, crossfaderSmoothed.getNextValue());
+        const float xfL = (xf < 0.0f) ? 1.0f : (1.0f - xf);
+        const float xfR = (xf > 0.0f) ? 1.0f : (1.0f + xf);
+        l *= xfL;
+        r *= xfR;
+      }
+
+      // Output
+      l = sanitizeFinite(l);
+      r = sanitizeFinite(r);
+      if (outL) outL[i] = l;
+      if (outR) outR[i] = r;
+
+      // Master meters
+      meterPeakL = std::max(meterPeakL, std::abs(l));
+      meterPeakR = std::max(meterPeakR, std::abs(r));
+      meterRmsAccL += l * l;
+      meterRmsAccR += r * r;
+    }
+  }
+
+  // ------------------------------ Synth voice management ------------------------------
+
+
+  // Instruments are created on the request side (publishInstrument, ensureNoteInstrument); a note
+  // for one that has not reached the audio thread yet is dropped rather than built here.
   void startVoice(const juce::String& instId, int mixCh, int note, float velocity) {
-    auto it = instruments.find(instId);
-    if (it == instruments.end())
-      it = instruments.emplace(instId, defaultsForType("piano")).first;
+    const auto it = instruments->find(instId);
+    if (it == instruments->end()) return;
 
-    auto& st = it->second;
-    if (isFmManagedType(st.type)) {
-      auto& rt = ensureFmRuntime(instId, mixCh, st, false);
+    const auto& st = *it->second.state;
+    if (it->second.fm) {
+      auto& rt = *it->second.fm;
+      rt.mixCh = juce::jmax(1, mixCh);
       const float vel = juce::jlimit(0.0f, 1.0f, velocity);
       if (rt.drums) {
         if (rt.drumRuntime) rt.drumRuntime->noteOn(instId, note, vel, mixCh);
@@ -1569,33 +1853,38 @@ void refreshMasterEq() {
     v.release = st.release;
     v.waveform = st.waveform;
 
+    auto rates = sls::engine::EnvelopeRates::compute(v.attack, v.decay, v.sustain, v.release, sampleRate);
+    rates.setExponentialRelease(v.release, sampleRate, 0.0001f);
+    v.envelope.setRates(rates);
+    v.envelope.noteOn();
+
     const double hz = 440.0 * std::pow(2.0, (note - 69) / 12.0);
     v.phaseInc = kTwoPi * hz / std::max(1.0, sampleRate);
 
+    // Fixed pool: with every voice busy the note is dropped.
     for (auto& s : voices) {
       if (!s.active) { s = v; return; }
     }
-    if ((int)voices.size() < kMaxSynthVoices) voices.push_back(v);
   }
 
   void stopVoice(const juce::String& instId, int mixCh, int note) {
-    auto it = instruments.find(instId);
-    if (it != instruments.end() && isFmManagedType(it->second.type)) {
-      const auto key = instId.toStdString();
-      if (auto itRt = fmRuntimes.find(key); itRt != fmRuntimes.end()) {
-        if (itRt->second.drums) {
-          if (itRt->second.drumRuntime) itRt->second.drumRuntime->noteOff(note);
-        } else {
-          itRt->second.engine.noteOff(note);
-        }
+    const auto it = instruments->find(instId);
+    if (it != instruments->end() && it->second.fm) {
+      auto& rt = *it->second.fm;
+      if (rt.drums) {
+        if (rt.drumRuntime) rt.drumRuntime->noteOff(note);
+      } else {
+        rt.engine.noteOff(note);
       }
       return;
     }
 
     for (auto& v : voices) {
       if (!v.active) continue;
-      if (v.instId == instId && v.mixCh == mixCh && v.note == note)
+      if (v.instId == instId && v.mixCh == mixCh && v.note == note && !v.releasing) {
         v.releasing = true;
+        v.envelope.noteOff();
+      }
     }
   }
 
@@ -1615,60 +1904,387 @@ void refreshMasterEq() {
 
   void panic() {
     for (auto& v : voices) v.active = false;
-    for (auto& sv : sampleVoices) sv.active = false;
-    for (auto& kv : fmRuntimes) {
-      kv.second.engine.reset();
-      if (kv.second.drumRuntime) kv.second.drumRuntime->reset();
+    for (auto& sv : sampleVoices) {
+      sv.active = false;
+      sv.releaseStream();
+    }
+    touskiRuntime.stopAll();
+    for (const auto& kv : *instruments) {
+      if (!kv.second.fm) continue;
+      kv.second.fm->engine.reset();
+      if (kv.second.fm->drumRuntime) kv.second.fm->drumRuntime->reset();
     }
   }
 
   // ------------------------------ Sample IO ------------------------------
 
-  std::shared_ptr<SampleData> loadSampleFromPath(const juce::String& p) {
-    juce::File f(p);
-    if (p.isEmpty() || !f.existsAsFile()) return {};
+  // allowStreaming: long files keep only their head in memory and play through the SampleStreamer.
+  // Voices that loop (Touski) need the whole sample and must not pass it. Fully decoded files
+  // are converted to targetRate (0 keeps the file rate); streamed ones play at the file rate.
+  // Compressed files come from pcmDiskCache when it holds them, and are written to it once decoded.
+  // Load-job threads (decodes through sampleDecoder, long files in parallel chunks).
+  std::shared_ptr<SampleData> loadSampleFromPath(const juce::String& p, bool allowStreaming, double targetRate,
+                                                 const sls::sampler::SampleDecoder::Progress& progress = {}) {
+    juce::File f(p);
+    if (p.isEmpty() || !f.existsAsFile()) return {};
+
+    // The cache holds converted data only, so it is bypassed while file-rate originals are kept.
+    const bool diskCached = !sampleKeepOriginal && sls::sampler::PcmDiskCache::isCacheable(f);
+    if (diskCached) {
+      if (auto sd = pcmDiskCache.load(f, targetRate, sampleStorageInt16)) {
+        juce::AudioBuffer<float> widened;
+        sd->pitchMarks = sls::sampler::PitchMarks::analyse(sd->getFloatFrames(widened));
+        return sd;
+      }
+    }
+
+    auto r = std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(f));
+    if (!r) {
+      std::cerr << "[SLS][sample.load.fail] no reader for: " << p << std::endl;
+      return {};
+    }
+
+    auto sd = std::make_shared<SampleData>();
+    sd->sampleRate = r->sampleRate;
+    sd->sourceSampleRate = r->sampleRate;
+
+    juce::int64 framesToDecode = r->lengthInSamples;
+    const double streamAboveFrames = sampleStreamThresholdSec * r->sampleRate;
+    if (allowStreaming && sampleStreamThresholdSec > 0.0 && (double)r->lengthInSamples > streamAboveFrames) {
+      sd->stream = sls::sampler::StreamSource::open(formatManager, f);
+      if (sd->stream) framesToDecode = std::min<juce::int64>(framesToDecode, sls::sampler::SampleStreamer::kHeadFrames);
+    }
+
+    const int numChannels = (int)r->numChannels;
+    r.reset();
+    sd->buffer.setSize(numChannels, (int)framesToDecode);
+    if (!sampleDecoder.decode(formatManager, f, sd->buffer, framesToDecode, progress)) {
+      std::cerr << "[SLS][sample.load.fail] decode error: " << p << std::endl;
+      return {};
+    }
+    if (!sd->stream && targetRate > 0.0 && !juce::approximatelyEqual(sd->sampleRate, targetRate)) {
+      auto converted = sls::sampler::convertSampleRate(sd->buffer, sd->sampleRate, targetRate);
+      if (sampleKeepOriginal) sd->original = std::make_shared<const juce::AudioBuffer<float>>(std::move(sd->buffer));
+      sd->buffer = std::move(converted);
+      sd->sampleRate = targetRate;
+    }
+    sd->addGuardFrames();
+    if (!sd->stream) {
+      sd->pitchMarks = sls::sampler::PitchMarks::analyse(sd->buffer);
+      if (sampleStorageInt16) sd->compactToInt16();
+      if (diskCached) pcmDiskCache.store(f, targetRate, *sd);
+    }
+    return sd;
+  }
+
+  // Pool converter: a copy of a fully decoded sample at rate, from the file-rate data when it
+  // was kept. nullptr when the sample is already at rate or streamed.
+  std::shared_ptr<const SampleData> convertSampleToRate(const SampleData& src, double rate) {
+    if (src.stream || juce::approximatelyEqual(src.sampleRate, rate)) return nullptr;
+
+    auto sd = std::make_shared<SampleData>();
+    sd->sourceSampleRate = src.sourceSampleRate;
+    sd->original = src.original;
+    juce::AudioBuffer<float> widened;
+    sd->buffer = src.original ? sls::sampler::convertSampleRate(*src.original, src.sourceSampleRate, rate)
+                              : sls::sampler::convertSampleRate(src.getFloatFrames(widened), src.sampleRate, rate);
+    sd->sampleRate = rate;
+    sd->addGuardFrames();
+    sd->pitchMarks = sls::sampler::PitchMarks::analyse(sd->buffer);
+    if (src.isCompact()) sd->compactToInt16();
+    return sd;
+  }
+
+  // The engine rate is (re)set: new decodes are converted to it, and a load job converts the
+  // pooled samples made for the previous rate and swaps them into sampleCache and the Touski
+  // programs (whose loops are analysed again). Playing voices finish on the data they started with;
+  // the replaced samples wait in retiredSamples so the audio thread never drops the last reference.
+  void retargetSamples(double rate) {
+    if (juce::approximatelyEqual(samplePool.getTargetRate(), rate)) return;
+    loadJobsPending.fetch_add(1);
+    sampleDecoder.submit([this, rate] {
+      const auto replaced = samplePool.retarget(rate, [this](const SampleData& src, double r) {
+        return convertSampleToRate(src, r);
+      });
+      if (!replaced.empty()) {
+        for (const auto& [from, to] : replaced) retiredSamples.add(from);
+        const auto remap = [&replaced](const std::shared_ptr<const SampleData>& old) -> std::shared_ptr<const SampleData> {
+          for (const auto& [from, to] : replaced)
+            if (from == old) return to;
+          return nullptr;
+        };
+
+        std::vector<juce::String> programs;
+        {
+          std::scoped_lock lk(assetMutex);
+          for (auto& kv : sampleCache)
+            if (auto to = remap(kv.second)) kv.second = std::move(to);
+          programs = touskiInstrument.replaceSamples(remap);
+          publishTouskiPrograms();
+        }
+
+        for (const auto& instId : programs) {
+          sls::inst::SampleTouskiInstrument::ProgramState program;
+          {
+            std::scoped_lock lk(assetMutex);
+            if (const auto* installed = touskiInstrument.getProgram(instId)) program = *installed;
+            else continue;
+          }
+          analyseTouskiLoops(program);
+          std::scoped_lock lk(assetMutex);
+          touskiInstrument.adoptLoopPoints(instId, program);
+          publishTouskiPrograms();
+        }
+      }
+      loadJobsPending.fetch_sub(1);
+    });
+  }
+
+  // ------------------------------ Engine config / init ------------------------------
+
+  void handleEngineConfigSet(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
+    sampleRate = std::max(22050.0, getDoubleProp(d, "sampleRate", sampleRate));
+    bufferSize = std::max(64, getIntProp(d, "bufferSize", bufferSize));
+    numOut     = std::max(1, getIntProp(d, "numOut", numOut));
+    numIn      = std::max(0, getIntProp(d, "numIn", numIn));
+    playPrerollMs.store(std::max(0.0, getDoubleProp(d, "playPrerollMs", playPrerollMs.load())));
+    schedulerDebug = getBoolProp(d, "schedulerDebug", schedulerDebug);
+    renderThreads = juce::jlimit(0, 15, getIntProp(d, "renderThreads", renderThreads));
+    sampleStreamThresholdSec = std::max(0.0, getDoubleProp(d, "sampleStreamThresholdSec", sampleStreamThresholdSec));
+    sampleKeepOriginal = getBoolProp(d, "sampleKeepOriginal", sampleKeepOriginal);
+    sampleStorageInt16 = getStringProp(d, "sampleStorage", sampleStorageInt16 ? "int16" : "float") == "int16";
+    samplePoolBudgetMB = juce::jlimit(0, 1 << 20, getIntProp(d, "samplePoolBudgetMB", samplePoolBudgetMB));
+    samplePool.setBudgetBytes((size_t)samplePoolBudgetMB << 20);
+    pcmCacheMB = juce::jlimit(0, 1 << 24, getIntProp(d, "pcmCacheMB", pcmCacheMB));
+    const auto pcmCacheDir = getStringProp(d, "pcmCacheDir", pcmDiskCache.getDirectory().getFullPathName());
+    pcmDiskCache.configure(juce::File::isAbsolutePath(pcmCacheDir) ? juce::File(pcmCacheDir) : pcmDiskCache.getDirectory(),
+                           (juce::int64)pcmCacheMB << 20);
+    const int streamBudgetMB = juce::jlimit(0, 4096, getIntProp(d, "sampleStreamBudgetMB", sampleStreamBudgetMB));
+
+    shutdownAudio();
+    if (streamBudgetMB != sampleStreamBudgetMB) {
+      // Rings are reallocated: streamed voices cannot survive it, and no load job may claim one meanwhile.
+      sampleDecoder.waitUntilIdle();
+      // Queued voice starts may hold a claimed ring: apply them first so they are released below.
+      RtCommand cmd;
+      while (rtQueue.tryPop(cmd)) applyRtCommand(cmd, bufferSize);
+      for (auto& sv : sampleVoices) {
+        if (!sv.stream) continue;
+        sv.active = false;
+        sv.releaseStream();
+      }
+      sampleStreamBudgetMB = streamBudgetMB;
+      sampleStreamer.configure((size_t)sampleStreamBudgetMB << 20);
+    }
+    renderPool.start(renderThreads, bufferSize, sampleRate);
+    setupAudio();
+    refreshDspSpecs();
+
+    resOk(op, id, engineConfig());
+  }
+
+  // ------------------------------ Offline render ------------------------------
+
+  // render.bounce: renders [fromPpq, toPpq) of the scheduler timeline to WAV/FLAC as fast as the CPU allows.
+  void handleRenderBounce(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
+    if (!d) return resErr(op, id, "E_BAD_REQUEST", "Missing data");
+
+    BounceSettings s;
+    const auto path = getStringProp(d, "path", "");
+    if (path.isEmpty() || !juce::File::isAbsolutePath(path))
+      return resErr(op, id, "E_BAD_REQUEST", "path must be an absolute file path");
+    s.file = juce::File(path);
+
+    s.format = getStringProp(d, "format", s.file.hasFileExtension("flac") ? "flac" : "wav").toLowerCase();
+    s.bitDepth = getIntProp(d, "bitDepth", 24);
+    if (s.format == "wav") {
+      if (s.bitDepth != 16 && s.bitDepth != 24 && s.bitDepth != 32)
+        return resErr(op, id, "E_BAD_REQUEST", "wav bitDepth must be 16, 24 or 32 (float)");
+    } else if (s.format == "flac") {
+      if (s.bitDepth != 16 && s.bitDepth != 24)
+        return resErr(op, id, "E_BAD_REQUEST", "flac bitDepth must be 16 or 24");
+    } else {
+      return resErr(op, id, "E_BAD_REQUEST", "format must be wav or flac");
+    }
+
+    s.fromPpq = std::max(0.0, getDoubleProp(d, "fromPpq", 0.0));
+    s.toPpq = getDoubleProp(d, "toPpq", -1.0);
+    if (s.toPpq <= s.fromPpq) {
+      // Default end: the last scheduled note release.
+      std::scoped_lock lk(stateMutex);
+      for (const auto& ev : *publishedTimeline->events)
+        s.toPpq = std::max(s.toPpq, ev.atPpq + std::max(0.0, ev.durPpq));
+    }
+    if (s.toPpq <= s.fromPpq) return resErr(op, id, "E_BAD_REQUEST", "Empty render range");
+    s.tailSec = juce::jlimit(0.0, 60.0, getDoubleProp(d, "tailSec", 0.0));
+
+    if (bouncing.exchange(true)) return resErr(op, id, "E_BUSY", "Offline render in progress");
+    if (bounceThread.joinable()) bounceThread.join();
+
+    bounceCancel.store(false);
+    bounceSucceeded.store(false);
+
+    juce::DynamicObject::Ptr r = new juce::DynamicObject();
+    r->setProperty("path", s.file.getFullPathName());
+    r->setProperty("format", s.format);
+    r->setProperty("bitDepth", s.bitDepth);
+    r->setProperty("fromPpq", s.fromPpq);
+    r->setProperty("toPpq", s.toPpq);
+    r->setProperty("sampleRate", sampleRate);
+    resOk(op, id, juce::var(r.get()));
+
+    bounceThread = std::thread([this, s] { runBounce(s); });
+  }
+
+  std::unique_ptr<juce::AudioFormatWriter> createBounceWriter(const BounceSettings& s, juce::String& error) {
+    s.file.deleteFile();
+    if (!s.file.getParentDirectory().createDirectory()) {
+      error = "Cannot create output directory";
+      return {};
+    }
+
+    auto fileStream = std::make_unique<juce::FileOutputStream>(s.file);
+    if (fileStream->failedToOpen()) {
+      error = "Cannot open output file";
+      return {};
+    }
+    std::unique_ptr<juce::OutputStream> stream = std::move(fileStream);
+
+    using Options = juce::AudioFormatWriterOptions;
+    const auto options = Options{}
+      .withSampleRate(sampleRate)
+      .withNumChannels(2)
+      .withBitsPerSample(s.bitDepth)
+      .withSampleFormat(s.bitDepth == 32 ? Options::SampleFormat::floatingPoint : Options::SampleFormat::integral);
+
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    if (s.format == "flac") writer = juce::FlacAudioFormat().createWriterFor(stream, options);
+    else                    writer = juce::WavAudioFormat().createWriterFor(stream, options);
+
+    if (!writer) error = "Unsupported output format";
+    return writer;
+  }
+
+  // Bounce thread. The device callback is detached for the duration, so this thread is the
+  // only one rendering and runs exactly the same renderAudio() path as live playback.
+  void runBounce(BounceSettings s) {
+    const double startedMs = juce::Time::getMillisecondCounterHiRes();
+
+    // Samples and programs requested before the bounce are part of it.
+    sampleDecoder.waitUntilIdle();
+
+    if (useAudioDevice) deviceManager.removeAudioCallback(this);
 
-    auto r = std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(f));
-    if (!r) {
-      std::cerr << "[SLS][sample.load.fail] no reader for: " << p << std::endl;
-      return {};
+    // Everything queued before the bounce (mixer.init, inst.create, transport...) applies before the first frame.
+    RtCommand cmd;
+    while (rtQueue.tryPop(cmd)) applyRtCommand(cmd, bufferSize);
+
+    const juce::int64 savedSamplePos = samplePos;
+    const bool savedPlaying = playing.load();
+    const bool savedPlayArmed = playArmed.load();
+    const juce::int64 savedArmCountdown = playArmCountdownSamples;
+    const juce::int64 savedPlayStart = playStartSamplePos;
+    const auto savedTimeline = timeline;
+
+    // The bounce owns the range: no loop / stop-at-end while rendering.
+    auto bounceTimeline = std::make_shared<Timeline>(*savedTimeline);
+    bounceTimeline->rangeStartPpq = 0.0;
+    bounceTimeline->rangeEndPpq = 0.0;
+    timeline = std::move(bounceTimeline);
+    playArmed.store(false);
+    playArmCountdownSamples = 0;
+    playing.store(false);
+    samplePos = ppqToSamples(s.fromPpq);
+    resetSchedulerCursorForPpq(s.fromPpq);
+
+    panic();
+    prepareRenderBuffers();
+    playing.store(true);
+
+    juce::String error;
+    auto writer = createBounceWriter(s, error);
+
+    const juce::int64 musicalFrames = std::max<juce::int64>(0, ppqToSamples(s.toPpq) - ppqToSamples(s.fromPpq));
+    const juce::int64 totalFrames = musicalFrames + (juce::int64)std::llround(s.tailSec * sampleRate);
+    const int blockSize = juce::jmax(64, bufferSize);
+    juce::AudioBuffer<float> block(2, blockSize);
+
+    juce::int64 done = 0;
+    double lastProgressMs = startedMs;
+    while (writer && done < totalFrames && !bounceCancel.load()) {
+      // Split at the musical end so the transport stops exactly there; the tail only rings out.
+      const juce::int64 limit = done < musicalFrames ? musicalFrames : totalFrames;
+      const int n = (int)std::min<juce::int64>(blockSize, limit - done);
+
+      sampleStreamer.fillNow(); // faster than realtime: do not wait for the read-ahead thread
+      renderAudio(block.getArrayOfWritePointers(), 2, n);
+      if (!writer->writeFromAudioSampleBuffer(block, 0, n)) {
+        error = "Write failed";
+        break;
+      }
+      done += n;
+      if (done >= musicalFrames) playing.store(false);
+
+      const double nowHiRes = juce::Time::getMillisecondCounterHiRes();
+      if (nowHiRes - lastProgressMs >= 250.0) {
+        lastProgressMs = nowHiRes;
+        juce::DynamicObject::Ptr p = new juce::DynamicObject();
+        p->setProperty("path", s.file.getFullPathName());
+        p->setProperty("frames", (double)done);
+        p->setProperty("totalFrames", (double)totalFrames);
+        p->setProperty("progress", totalFrames > 0 ? (double)done / (double)totalFrames : 1.0);
+        emitEvt("render.progress", juce::var(p.get()));
+      }
     }
+    writer.reset(); // flushes the header / FLAC stream
 
-    auto sd = std::make_shared<SampleData>();
-    sd->sampleRate = r->sampleRate;
-    sd->buffer.setSize((int)r->numChannels, (int)r->lengthInSamples);
-    r->read(&sd->buffer, 0, (int)r->lengthInSamples, 0, true, true);
-    return sd;
-  }
+    const bool cancelled = bounceCancel.load() && done < totalFrames;
+    if (cancelled || error.isNotEmpty()) s.file.deleteFile();
 
-  // ------------------------------ Engine config / init ------------------------------
+    // Restore the live transport exactly where and as it was (playing, armed or stopped).
+    playing.store(false);
+    panic();
+    samplePos = savedSamplePos;
+    timeline = savedTimeline;
+    resetSchedulerCursorForPpq(samplesToPpq(samplePos));
+    playArmCountdownSamples = savedArmCountdown;
+    playStartSamplePos = savedPlayStart;
+    playArmed.store(savedPlayArmed);
+    playing.store(savedPlaying);
 
-  void handleEngineConfigSet(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
-    sampleRate = std::max(22050.0, getDoubleProp(d, "sampleRate", sampleRate));
-    bufferSize = std::max(64, getIntProp(d, "bufferSize", bufferSize));
-    numOut     = std::max(1, getIntProp(d, "numOut", numOut));
-    numIn      = std::max(0, getIntProp(d, "numIn", numIn));
-    playPrerollMs.store(std::max(0.0, getDoubleProp(d, "playPrerollMs", playPrerollMs.load())));
-    schedulerDebug = getBoolProp(d, "schedulerDebug", schedulerDebug);
+    if (useAudioDevice) deviceManager.addAudioCallback(this);
+    emitEvt("transport.state", transportState());
 
-    shutdownAudio();
-    setupAudio();
-    refreshDspSpecs();
+    const double elapsedSec = (juce::Time::getMillisecondCounterHiRes() - startedMs) / 1000.0;
+    const double audioSec = (double)done / std::max(1.0, sampleRate);
 
-    resOk(op, id, engineConfig());
+    juce::DynamicObject::Ptr r = new juce::DynamicObject();
+    r->setProperty("path", s.file.getFullPathName());
+    if (error.isNotEmpty() || cancelled) {
+      r->setProperty("code", cancelled ? "E_CANCELLED" : "E_RENDER");
+      r->setProperty("message", cancelled ? juce::String("Render cancelled") : error);
+      emitEvt("render.error", juce::var(r.get()));
+    } else {
+      r->setProperty("frames", (double)done);
+      r->setProperty("seconds", audioSec);
+      r->setProperty("elapsedSec", elapsedSec);
+      r->setProperty("realtimeFactor", elapsedSec > 0.0 ? audioSec / elapsedSec : 0.0);
+      bounceSucceeded.store(true);
+      emitEvt("render.done", juce::var(r.get()));
+    }
+
+    bouncing.store(false);
   }
 
   void applyMixerInitRt(const juce::DynamicObject* d) {
-    channelCount = juce::jlimit(1, 64, getIntProp(d, "channels", channelCount));
+    channelCount = juce::jlimit(1, kMaxMixerChannels, getIntProp(d, "channels", channelCount));
 
     mixerStates.resize((size_t)channelCount);
     channelDsp.resize((size_t)channelCount);
     resizeMeters(channelCount);
 
     refreshDspSpecs();
-
-    busL.assign((size_t)juce::jmax(1, channelCount), 0.0f);
-    busR.assign((size_t)juce::jmax(1, channelCount), 0.0f);
+    prepareRenderBuffers();
   }
 
   void handleMixerInit(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
@@ -1687,19 +2303,30 @@ void refreshMasterEq() {
   // ------------------------------ Scheduler ------------------------------
 
   void handleScheduleClear(const juce::String& op, const juce::String& id) {
-    std::scoped_lock lk(stateMutex);
-    scheduler.clear();
-    schedulerCursor = 0;
+    {
+      std::scoped_lock lk(stateMutex);
+      auto t = std::make_shared<Timeline>(*publishedTimeline);
+      t->events = std::make_shared<const std::vector<ScheduledEvent>>();
+      if (!publishTimeline(std::move(t)))
+        return resErr(op, id, "E_BUSY", "Audio command queue full");
+    }
     if (schedulerDebug) juce::Logger::writeToLog("[SLS][engine.schedule.clear]");
     resOk(op, id, juce::var());
   }
 
   void handleScheduleSetWindow(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
-    std::scoped_lock lk(stateMutex);
-    scheduleWindowFromPpq = getDoubleProp(d, "fromPpq", 0.0);
-    scheduleWindowToPpq   = getDoubleProp(d, "toPpq",   0.0);
+    const double fromPpq = getDoubleProp(d, "fromPpq", 0.0);
+    const double toPpq   = getDoubleProp(d, "toPpq",   0.0);
+    {
+      std::scoped_lock lk(stateMutex);
+      auto t = std::make_shared<Timeline>(*publishedTimeline);
+      t->windowFromPpq = fromPpq;
+      t->windowToPpq = toPpq;
+      if (!publishTimeline(std::move(t)))
+        return resErr(op, id, "E_BUSY", "Audio command queue full");
+    }
     if (schedulerDebug) {
-      juce::Logger::writeToLog("[SLS][engine.schedule.setWindow] from=" + juce::String(scheduleWindowFromPpq) + " to=" + juce::String(scheduleWindowToPpq));
+      juce::Logger::writeToLog("[SLS][engine.schedule.setWindow] from=" + juce::String(fromPpq) + " to=" + juce::String(toPpq));
     }
     resOk(op, id, juce::var());
   }
@@ -1708,8 +2335,10 @@ void refreshMasterEq() {
     if (!d || !d->hasProperty("events") || !d->getProperty("events").isArray())
       return resErr(op, id, "E_BAD_REQUEST", "schedule.push events[] required");
 
-    std::scoped_lock lk(stateMutex);
-
+    // sampler.trigger events take their sample now if it is decoded; otherwise samplePath is
+    // loaded in the background and the event finds it in the cache when it fires.
+    std::vector<ScheduledEvent> added;
+    juce::StringArray preload;
     for (const auto& ev : *d->getProperty("events").getArray()) {
       auto* eo = ev.getDynamicObject();
       if (!eo) continue;
@@ -1723,19 +2352,71 @@ void refreshMasterEq() {
       se.vel    = (float)getDoubleProp(eo, "vel", getDoubleProp(eo, "velocity", 0.85));
       se.durPpq = getDoubleProp(eo, "durPpq", 0.25);
       se.payload = ev;
+      if (se.type == "sampler.trigger") {
+        se.sample = resolveSamplerSample(eo);
+        const auto samplePath = getStringProp(eo, "samplePath", "");
+        if (!se.sample && samplePath.isNotEmpty() && !preload.contains(samplePath)) {
+          preload.add(samplePath);
+          const auto key = samplerCacheKey(eo);
+          submitLoadJob(nextLoadJobId.fetch_add(1), "sampler.load", [this, key, samplePath](int job, const sls::sampler::SamplePool::Progress& progress) {
+            if (loadSamplerSample(job, key, samplePath, progress)) attachScheduledSamples();
+          });
+        }
+      }
 
-      scheduler.push_back(se);
+      if (isNoteOnType(se.type)) ensureNoteInstrument(se.instId);
+      added.push_back(std::move(se));
     }
 
-    std::sort(scheduler.begin(), scheduler.end(),
-              [](const auto& a, const auto& b) { return a.atPpq < b.atPpq; });
+    size_t total = 0;
+    {
+      std::scoped_lock lk(stateMutex);
+      if (!publishScheduledEvents(std::move(added)))
+        return resErr(op, id, "E_BUSY", "Audio command queue full");
+      total = publishedTimeline->events->size();
+    }
 
     if (schedulerDebug) {
-      juce::Logger::writeToLog("[SLS][engine.schedule.push] added=" + juce::String((int)d->getProperty("events").getArray()->size()) + " total=" + juce::String((int)scheduler.size()) + " cursor=" + juce::String((int)schedulerCursor));
+      juce::Logger::writeToLog("[SLS][engine.schedule.push] added=" + juce::String((int)d->getProperty("events").getArray()->size()) + " total=" + juce::String((int)total));
     }
     resOk(op, id, juce::var());
   }
 
+  // Load jobs: gives the scheduled sampler.trigger events still without a sample the one that is
+  // now loaded, and publishes the schedule again if any changed. Samples are resolved outside
+  // stateMutex; events are matched by their payload object, which timeline copies share.
+  void attachScheduledSamples() {
+    std::shared_ptr<const Timeline> snapshot;
+    {
+      std::scoped_lock lk(stateMutex);
+      snapshot = publishedTimeline;
+    }
+
+    std::vector<std::pair<const juce::DynamicObject*, std::shared_ptr<const SampleData>>> resolved;
+    for (const auto& ev : *snapshot->events) {
+      if (ev.sample || ev.type != "sampler.trigger") continue;
+      if (auto* p = ev.payload.getDynamicObject())
+        if (auto sd = resolveSamplerSample(p)) resolved.emplace_back(p, std::move(sd));
+    }
+    if (resolved.empty()) return;
+
+    std::scoped_lock lk(stateMutex);
+    std::shared_ptr<std::vector<ScheduledEvent>> events;
+    const auto& current = *publishedTimeline->events;
+    for (size_t i = 0; i < current.size(); ++i) {
+      if (current[i].sample || current[i].type != "sampler.trigger") continue;
+      const auto* p = current[i].payload.getDynamicObject();
+      const auto it = std::find_if(resolved.begin(), resolved.end(), [p](const auto& r) { return r.first == p; });
+      if (it == resolved.end()) continue;
+      if (!events) events = std::make_shared<std::vector<ScheduledEvent>>(current);
+      (*events)[i].sample = it->second;
+    }
+    if (!events) return;
+    auto t = std::make_shared<Timeline>(*publishedTimeline);
+    t->events = std::move(events);
+    publishTimeline(std::move(t));
+  }
+
   void prepareBlockEvents(int nSamples) {
     blockEvents.clear();
     if (nSamples <= 0) return;
@@ -1745,15 +2426,14 @@ void refreshMasterEq() {
     const double fromPpq = samplesToPpq(blockStartSample);
     const double toPpqLinear = samplesToPpq(blockEndSample);
 
-    std::scoped_lock lk(stateMutex);
-
-    const bool hasRange = transportHasActiveRange();
-    const bool wrapsLoop = hasRange && transportLoopEnabled && transportRangeEndPpq > transportRangeStartPpq &&
-                           toPpqLinear >= transportRangeEndPpq && fromPpq < transportRangeEndPpq;
+    const auto& tl = *timeline;
+    const auto& scheduler = *tl.events;
+    const bool wrapsLoop = tl.hasRange() && tl.loop &&
+                           toPpqLinear >= tl.rangeEndPpq && fromPpq < tl.rangeEndPpq;
 
-    const auto inWindow = [this](double ppq) {
-      return (scheduleWindowToPpq <= scheduleWindowFromPpq) ||
-             (ppq >= scheduleWindowFromPpq && ppq <= scheduleWindowToPpq);
+    const auto inWindow = [&tl](double ppq) {
+      return (tl.windowToPpq <= tl.windowFromPpq) ||
+             (ppq >= tl.windowFromPpq && ppq <= tl.windowToPpq);
     };
 
     const auto pushEventAtPpq = [&](const ScheduledEvent& ev, double eventPpq) {
@@ -1777,8 +2457,8 @@ void refreshMasterEq() {
       while (schedulerCursor < scheduler.size() && scheduler[schedulerCursor].atPpq < toPpqLinear)
         ++schedulerCursor;
     } else {
-      const double loopStartPpq = transportRangeStartPpq;
-      const double loopEndPpq = transportRangeEndPpq;
+      const double loopStartPpq = tl.rangeStartPpq;
+      const double loopEndPpq = tl.rangeEndPpq;
       const double loopLenPpq = std::max(1.0e-9, loopEndPpq - loopStartPpq);
       const double wrappedToPpq = loopStartPpq + std::fmod(std::max(0.0, toPpqLinear - loopEndPpq), loopLenPpq);
 
@@ -1813,7 +2493,7 @@ void refreshMasterEq() {
   }
 
   void dispatchOneEvent(const ScheduledEvent& ev) {
-    // NOTE: this is called from audio thread under audioMutex.
+    // NOTE: this is called from the audio thread only.
     const auto t = ev.type.toLowerCase();
 
     if (t == "note.on" || t == "midi.noteon") {
@@ -1827,10 +2507,11 @@ void refreshMasterEq() {
     }
 
     if (t == "touski.note.on") {
+      const auto it = touskiPrograms->find(ev.instId);
+      if (it == touskiPrograms->end()) return;
       sls::inst::SampleTouskiInstrument::VoiceSpec spec;
-      juce::String err;
-      if (touskiInstrument.buildVoiceOn(ev.instId, juce::jmax(1, ev.mixCh), ev.note, ev.vel, spec, &err))
-        spawnTouskiVoiceFromSpec(spec, nullptr);
+      if (sls::inst::SampleTouskiInstrument::buildVoiceOn(*it->second, ev.instId, juce::jmax(1, ev.mixCh), ev.note, ev.vel, spec))
+        touskiRuntime.spawnVoice(spec);
       return;
     }
 
@@ -1842,7 +2523,7 @@ void refreshMasterEq() {
     if (t == "sampler.trigger") {
       // Use ev.payload to trigger sample
       if (auto* p = ev.payload.getDynamicObject())
-        triggerSampleFromObject(p, /*isFromScheduler*/true);
+        triggerSampleFromObject(p, /*isFromScheduler*/true, ev.sample);
       return;
     }
   }
@@ -1853,7 +2534,9 @@ void refreshMasterEq() {
     if (!d) return resErr(op, id, "E_BAD_REQUEST", "Missing data");
     const auto instId = getStringProp(d, "instId", "");
     if (instId.isEmpty()) return resErr(op, id, "E_BAD_REQUEST", "instId required");
-    instruments[instId] = defaultsForType(getStringProp(d, "type", "piano"));
+    std::scoped_lock lk(instrumentMutex);
+    if (!publishInstrument(instId, defaultsForType(getStringProp(d, "type", "piano"))))
+      return resErr(op, id, "E_BUSY", "Audio command queue full");
     resOk(op, id, juce::var());
   }
 
@@ -1881,13 +2564,82 @@ void refreshMasterEq() {
     if (!d) return resErr(op, id, "E_BAD_REQUEST", "Missing data");
     const auto instId = getStringProp(d, "instId", "");
     if (instId.isEmpty()) return resErr(op, id, "E_BAD_REQUEST", "instId required");
+    if (!setInstrumentParams(instId, d))
+      return resErr(op, id, "E_BUSY", "Audio command queue full");
+    resOk(op, id, juce::var());
+  }
+
+  // inst.param.set from either transport. Returns false when the queue is full.
+  bool setInstrumentParams(const juce::String& instId, const juce::DynamicObject* d) {
+    std::scoped_lock lk(instrumentMutex);
+    const auto it = publishedInstruments->find(instId);
+    auto st = it != publishedInstruments->end() ? *it->second.state : defaultsForType(getStringProp(d, "type", "piano"));
+    applyInstParams(st, d);
+    return publishInstrument(instId, std::move(st));
+  }
+
+  // A note for an instrument nobody created plays the piano defaults; the instrument is
+  // published before the note is queued. Any thread except the audio thread.
+  void ensureNoteInstrument(const juce::String& instId) {
+    std::scoped_lock lk(instrumentMutex);
+    if (publishedInstruments->count(instId) == 0) publishInstrument(instId, defaultsForType("piano"));
+  }
+
+  // Caller holds instrumentMutex. Publishes the table with instId set to st. FM-managed types get a
+  // new runtime built here when the type, polyphony or drum kit changes; otherwise the current
+  // runtime is kept (its voices play on) and only takes the new patch on the audio thread.
+  // Returns false when the queue is full; nothing is published then.
+  bool publishInstrument(const juce::String& instId, InstrumentState st) {
+    instrumentTables.collect();
+    fmPatchLibrary.collect();
+
+    RtCommand cmd;
+    cmd.type = RtCommandType::InstrumentsSet;
+
+    InstrumentEntry entry;
+    if (isFmManagedType(st.type)) {
+      std::shared_ptr<FmRuntime> current;
+      if (const auto it = publishedInstruments->find(instId); it != publishedInstruments->end()) current = it->second.fm;
+
+      if (current && !current->drums && !isFmDrumType(st.type) &&
+          current->type == st.type && current->polyphony == fmPolyphonyFor(st)) {
+        cmd.fmRuntime = current;
+        cmd.fmPatch = fmPatchLibrary.compile(makeFmPatchForState(st), current->sampleRate);
+        entry.fm = std::move(current);
+      } else {
+        entry.fm = makeFmRuntime(instId, st);
+      }
+    }
+    entry.state = std::make_shared<const InstrumentState>(std::move(st));
+
+    auto table = std::make_shared<InstrumentTable>(*publishedInstruments);
+    (*table)[instId] = std::move(entry);
+    cmd.instruments = instrumentTables.add(std::move(table));
+    if (!enqueueRtCommand(cmd)) return false;
+    publishedInstruments = cmd.instruments;
+    return true;
+  }
 
-    auto it = instruments.find(instId);
-    if (it == instruments.end())
-      it = instruments.emplace(instId, defaultsForType(getStringProp(d, "type", "piano"))).first;
+  // Request side: a runtime for st, prepared for the current sample rate with its patch compiled.
+  std::shared_ptr<FmRuntime> makeFmRuntime(const juce::String& instId, const InstrumentState& st) {
+    auto rt = std::make_shared<FmRuntime>();
+    rt->instId = instId;
+    rt->type = st.type;
+    rt->polyphony = fmPolyphonyFor(st);
+    rt->drums = isFmDrumType(st.type);
+    rt->sampleRate = sampleRate;
 
-    auto& st = it->second;
+    if (rt->drums) {
+      rt->drumRuntime = std::make_unique<sls::engine::DrumRuntime>(fmPatchLibrary);
+      rt->drumRuntime->prepare(sampleRate, std::max(12, rt->polyphony));
+      rt->drumRuntime->syncFromInstrumentState(st);
+    } else {
+      rt->engine.prepare(rt->polyphony, fmPatchLibrary.compile(makeFmPatchForState(st), sampleRate));
+    }
+    return rt;
+  }
 
+  void applyInstParams(InstrumentState& st, const juce::DynamicObject* d) const {
     if (d->hasProperty("type")) {
       st = defaultsForType(d->getProperty("type").toString());
     }
@@ -1898,14 +2650,6 @@ void refreshMasterEq() {
     }
 
     if (d->hasProperty("juceSpec")) st.juceSpec = d->getProperty("juceSpec");
-
-    if (isFmManagedType(st.type)) {
-      int mixCh = 1;
-      if (auto itRt = fmRuntimes.find(instId.toStdString()); itRt != fmRuntimes.end()) mixCh = itRt->second.mixCh;
-      ensureFmRuntime(instId, mixCh, st, true);
-    }
-
-    resOk(op, id, juce::var());
   }
 
   // ------------------------------ Sampler / Sample Pattern ------------------------------
@@ -1915,22 +2659,122 @@ void refreshMasterEq() {
 
     const auto sampleId = getStringProp(d, "sampleId", "");
     const auto path = getStringProp(d, "path", "");
+    if (sampleId.isEmpty() || path.isEmpty() || !juce::File(path).existsAsFile())
+      return resErr(op, id, "E_LOAD_FAIL", "Invalid sample");
 
-    auto sd = loadSampleFromPath(path);
-    if (sampleId.isEmpty() || !sd) return resErr(op, id, "E_LOAD_FAIL", "Invalid sample");
-
-    sampleCache[sampleId] = sd;
-    resOk(op, id, juce::var());
+    const int jobId = nextLoadJobId.fetch_add(1);
+    resOk(op, id, loadJobData(jobId));
+    submitLoadJob(jobId, op, [this, sampleId, path](int job, const sls::sampler::SamplePool::Progress& progress) {
+      loadSamplerSample(job, sampleId, path, progress);
+    });
   }
 
   void handleSamplerTrigger(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
     if (!d) return resErr(op, id, "E_BAD_REQUEST", "Missing data");
-    if (!triggerSampleFromObject(d, /*isFromScheduler*/false))
+
+    const auto samplePath = getStringProp(d, "samplePath", "");
+    if (!resolveSamplerSample(d) && juce::File(samplePath).existsAsFile()) {
+      // Not decoded yet: load in the background and start the voice when it is ready.
+      const int jobId = nextLoadJobId.fetch_add(1);
+      resOk(op, id, loadJobData(jobId));
+      const juce::var payload(const_cast<juce::DynamicObject*>(d));
+      submitLoadJob(jobId, "sampler.load", [this, payload, samplePath](int job, const sls::sampler::SamplePool::Progress& progress) {
+        auto* p = payload.getDynamicObject();
+        auto sd = loadSamplerSample(job, samplerCacheKey(p), samplePath, progress);
+        SampleVoice sv;
+        if (sd && makeSampleVoiceFromObject(p, sv, /*onAudioThread*/false, sd)) enqueueSampleVoice(sv);
+      });
+      return;
+    }
+
+    SampleVoice sv;
+    if (!makeSampleVoiceFromObject(d, sv, /*onAudioThread*/false))
       return resErr(op, id, "E_TRIGGER_FAIL", "sampler.trigger failed");
-    resOk(op, id, juce::var());
+    handleSampleVoiceStart(op, id, sv);
+  }
+
+  bool triggerSampleFromObject(const juce::DynamicObject* d, bool isFromScheduler, std::shared_ptr<const SampleData> sample = {}) {
+    SampleVoice sv;
+    if (!makeSampleVoiceFromObject(d, sv, isFromScheduler, std::move(sample))) return false;
+    startSampleVoice(sv);
+    return true;
+  }
+
+  // Voices are fully prepared by the caller; only slot assignment happens on the audio thread.
+  bool startSampleVoice(const SampleVoice& sv) {
+    for (auto& x : sampleVoices) {
+      if (!x.active) { x = sv; return true; }
+    }
+    if ((int)sampleVoices.size() < kMaxSampleVoices) {
+      sampleVoices.push_back(sv);
+      return true;
+    }
+    if (sv.stream) sv.stream->release();
+    return false;
+  }
+
+  // sampleId from sampler.load, else an already decoded samplePath. Never loads (see loadSamplerSample).
+  // Not on the audio thread: scheduled triggers carry the sample resolved here (ScheduledEvent::sample).
+  std::shared_ptr<const SampleData> resolveSamplerSample(const juce::DynamicObject* d) {
+    const auto sampleId = getStringProp(d, "sampleId", "");
+    {
+      std::scoped_lock lk(assetMutex);
+      if (auto it = sampleCache.find(sampleId); it != sampleCache.end()) return it->second;
+    }
+
+    const auto samplePath = getStringProp(d, "samplePath", "");
+    if (samplePath.isEmpty()) return {};
+    return samplePool.find(samplePath, /*allowStreaming*/true);
+  }
+
+  // sampleCache key of a sampler.trigger payload that auto-loads samplePath.
+  juce::String samplerCacheKey(const juce::DynamicObject* d) const {
+    const auto sampleId = getStringProp(d, "sampleId", "");
+    return sampleId.isNotEmpty() ? sampleId : "adhoc:" + getStringProp(d, "samplePath", "");
   }
 
-  bool triggerSampleFromObject(const juce::DynamicObject* d, bool /*isFromScheduler*/) {
+  // Load-job thread: decodes (or finds) path in the pool, caches it under sampleId and reports sampler.load.done.
+  // Auto-loads ("adhoc:" keys) are not pinned in sampleCache: they resolve through the pool, which
+  // keeps them while its budget allows.
+  std::shared_ptr<const SampleData> loadSamplerSample(int jobId, const juce::String& sampleId, const juce::String& path,
+                                                      const sls::sampler::SamplePool::Progress& progress) {
+    auto sd = samplePool.acquire(path, /*allowStreaming*/true, progress);
+    if (sd && !sampleId.startsWith("adhoc:")) {
+      std::shared_ptr<const SampleData> replaced;
+      {
+        std::scoped_lock lk(assetMutex);
+        replaced = std::exchange(sampleCache[sampleId], sd);
+      }
+      if (replaced && replaced != sd) {
+        replaced.reset();
+        samplePool.trim();
+      }
+    }
+
+    juce::DynamicObject::Ptr r = new juce::DynamicObject();
+    r->setProperty("jobId", jobId);
+    r->setProperty("sampleId", sampleId);
+    r->setProperty("path", path);
+    r->setProperty("ok", sd != nullptr);
+    if (sd) {
+      r->setProperty("frames", (double)sd->getNumFrames());
+      r->setProperty("sampleRate", sd->sampleRate);
+      r->setProperty("sourceSampleRate", sd->sourceSampleRate);
+      r->setProperty("channels", sd->getNumChannels());
+      r->setProperty("streamed", sd->stream != nullptr);
+      r->setProperty("storage", sd->isCompact() ? "int16" : "float");
+    } else {
+      r->setProperty("error", "Cannot decode sample");
+    }
+    emitEvt("sampler.load.done", juce::var(r.get()));
+    return sd;
+  }
+
+  // onAudioThread: scheduled triggers, which play the sample resolved when they were scheduled
+  // (nothing is looked up); a streamed voice then only takes a ring it can prime from the
+  // decoded head (no disk access), otherwise it plays the head alone.
+  bool makeSampleVoiceFromObject(const juce::DynamicObject* d, SampleVoice& sv, bool onAudioThread,
+                                 std::shared_ptr<const SampleData> sample = {}) {
     // Required:
     //  - sampleId
     // Optional:
@@ -1940,23 +2784,10 @@ void refreshMasterEq() {
     //  - velocity/gain/pan/mixCh
     //  - durationSec or patternSteps/patternBeats + bpm
 
-    juce::String sampleId = getStringProp(d, "sampleId", "");
-    auto it = sampleCache.find(sampleId);
-    if (it == sampleCache.end()) {
-      const auto samplePath = getStringProp(d, "samplePath", "");
-      if (samplePath.isNotEmpty()) {
-        auto loaded = loadSampleFromPath(samplePath);
-        if (loaded) {
-          if (sampleId.isEmpty()) sampleId = "adhoc:" + samplePath;
-          sampleCache[sampleId] = loaded;
-          it = sampleCache.find(sampleId);
-        }
-      }
-    }
-    if (it == sampleCache.end()) return false;
+    const auto sd = sample ? std::move(sample) : (onAudioThread ? nullptr : resolveSamplerSample(d));
+    if (!sd) return false;
 
-    const auto sd = it->second;
-    const int total = sd->buffer.getNumSamples();
+    const int total = (int)std::min<juce::int64>(sd->getNumFrames(), std::numeric_limits<int>::max());
     if (total <= 1) return false;
 
     const double startNorm = juce::jlimit(0.0, 1.0, getDoubleProp(d, "startNorm", 0.0));
@@ -1995,7 +2826,7 @@ void refreshMasterEq() {
       }
     }
 
-    SampleVoice sv;
+    sv = SampleVoice{};
     sv.active = true;
     sv.releasing = false;
     sv.instId = "sampler";
@@ -2004,10 +2835,10 @@ void refreshMasterEq() {
     sv.sample = sd;
     sv.start = st;
     sv.end = en;
-    sv.pos = (double)st;
+    sv.setPosition((double)st);
 
     // CRITICAL: compensate sample SR -> engine SR
-    sv.rate = std::max(0.0001, rate * (sd->sampleRate / std::max(1.0, sampleRate)));
+    sv.setRate(std::max(0.0001, rate * (sd->sampleRate / std::max(1.0, sampleRate))));
 
     const float vel = (float)juce::jlimit(0.0, 1.0, getDoubleProp(d, "velocity", getDoubleProp(d, "vel", 0.85)));
     const float gain = (float)std::max(0.0, getDoubleProp(d, "gain", 1.0));
@@ -2020,100 +2851,104 @@ void refreshMasterEq() {
     sv.gainR = g * (1.0f + pan);
     sv.mixCh = mixCh;
 
-    for (auto& x : sampleVoices) {
-      if (!x.active) { x = sv; return true; }
-    }
-    if ((int)sampleVoices.size() < kMaxSampleVoices) sampleVoices.push_back(sv);
+    if (sd->stream) sv.stream = sampleStreamer.claim(sd, st, /*mayReadDisk*/!onAudioThread);
 
     return true;
   }
 
-  bool spawnTouskiVoiceFromSpec(const sls::inst::SampleTouskiInstrument::VoiceSpec& spec, juce::String* errorMessage = nullptr) {
-    if (!spec.valid || spec.samplePath.isEmpty()) {
-      if (errorMessage) *errorMessage = "Invalid Touski voice spec";
-      return false;
-    }
-
-    auto chosen = loadSampleFromPath(spec.samplePath);
-    if (!chosen) {
-      if (errorMessage) *errorMessage = "Failed to load Touski sample";
-      return false;
-    }
-
-    const int total = chosen->buffer.getNumSamples();
-    if (total <= 1) {
-      if (errorMessage) *errorMessage = "Sample buffer empty";
-      return false;
-    }
-
-    SampleVoice sv;
-    sv.active = true;
-    sv.releasing = spec.releasing;
-    sv.instId = spec.instId;
-    sv.note = spec.note;
-    sv.sample = chosen;
-    sv.start = juce::jlimit(0, std::max(0, total - 1), (int)std::floor((double)spec.posAction * total));
-    sv.loopStart = juce::jlimit(0, std::max(0, total - 1), (int)std::floor((double)spec.posLoopStart * total));
-    sv.loopEnd = juce::jlimit(sv.loopStart + 1, std::max(sv.loopStart + 1, total), (int)std::ceil((double)spec.posLoopEnd * total));
-    if (spec.loopEnabled && sv.zeroCrossSearchSamples > 0 && chosen->buffer.getNumSamples() > 8) {
-      const int minGap = std::max(32, sv.loopCrossfadeSamples + 8);
-      refineLoopPoints(chosen->buffer, sv.zeroCrossSearchSamples, minGap, sv.loopStart, sv.loopEnd);
-    }
-    sv.releaseEnd = juce::jlimit(sv.loopEnd, std::max(sv.loopEnd, total), (int)std::ceil((double)spec.posRelease * total));
-    sv.end = std::max(sv.loopEnd, sv.releaseEnd);
-    sv.pos = (double)sv.start;
-    sv.loopEnabled = spec.loopEnabled;
-    sv.fadeInTotal = std::max(0, spec.fadeInSamples);
-    sv.fadeInRemaining = sv.fadeInTotal;
-    sv.loopCrossfadeSamples = std::max(0, spec.loopCrossfadeSamples);
-    sv.zeroCrossSearchSamples = std::max(0, spec.zeroCrossSearchSamples);
-    sv.releaseTailSamples = std::max(0, spec.releaseTailSamples);
-    sv.fadeOutTotal = 0;
-    sv.fadeOutRemaining = 0;
-    sv.rate = std::max(0.0001, spec.rateRatio * (chosen->sampleRate / std::max(1.0, sampleRate)));
-    sv.gainL = spec.gainL;
-    sv.gainR = spec.gainR;
-    sv.mixCh = spec.mixCh;
-
-    for (auto& x : sampleVoices) {
-      if (!x.active) { x = sv; return true; }
-    }
-    if ((int)sampleVoices.size() < kMaxSampleVoices) {
-      sampleVoices.push_back(sv);
-      return true;
-    }
-
-    if (errorMessage) *errorMessage = "No free Touski sample voices";
-    return false;
-  }
-
+  // Audio thread.
   bool releaseTouskiVoice(const juce::String& instId, int mixCh, int note) {
-    const bool holdLoopThenRelease = touskiInstrument.shouldHoldLoopOnNoteOff(instId);
-    bool changed = false;
-    for (auto& sv : sampleVoices) {
-      if (!sv.active) continue;
-      if (sv.instId != instId || sv.mixCh != mixCh || sv.note != note) continue;
-      sv.releasing = true;
-      if (holdLoopThenRelease) {
-        sv.loopEnabled = false;
-        sv.end = std::max(1, sv.releaseEnd > 0 ? sv.releaseEnd : sv.end);
-      }
-      sv.fadeOutTotal = 0;
-      sv.fadeOutRemaining = 0;
-      changed = true;
-    }
-    return changed;
+    const auto it = touskiPrograms->find(instId);
+    const bool holdLoopThenRelease = it != touskiPrograms->end() && it->second->holdLoopOnNoteOff;
+    return touskiRuntime.noteOff(sls::inst::SampleTouskiInstrument::instKeyFor(instId), mixCh, note, holdLoopThenRelease);
   }
 
   // ------------------------------ Touski ------------------------------
 
+  // Caller holds assetMutex. Hands the installed programs to the audio thread; when the queue is
+  // full the event pump publishes them again.
+  void publishTouskiPrograms() {
+    touskiProgramTables.collect();
+    RtCommand cmd;
+    cmd.type = RtCommandType::TouskiProgramsSet;
+    cmd.touskiPrograms = touskiProgramTables.add(std::make_shared<const TouskiProgramTable>(touskiInstrument.programs()));
+    touskiProgramsStale.store(!enqueueRtCommand(cmd));
+  }
+
   void handleTouskiProgramLoad(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
     if (!d) return resErr(op, id, "E_BAD_REQUEST", "Missing data");
     const auto instId = getStringProp(d, "instId", "touski");
-    juce::String err;
-    if (!touskiInstrument.loadProgram(instId, juce::var(const_cast<juce::DynamicObject*>(d)), &err))
-      return resErr(op, id, "E_LOAD_FAIL", err.isNotEmpty() ? err : juce::String("Failed to load touski program"));
-    resOk(op, id, juce::var());
+
+    const int jobId = nextLoadJobId.fetch_add(1);
+    resOk(op, id, loadJobData(jobId));
+
+    const juce::var payload(const_cast<juce::DynamicObject*>(d));
+    submitLoadJob(jobId, op, [this, instId, payload](int job, const sls::sampler::SamplePool::Progress& progress) {
+      int samplesLoaded = 0;
+      const sls::inst::SampleTouskiInstrument::LoadSampleFn loadZone = [&](const juce::String& path) {
+        auto sd = samplePool.acquire(path, /*allowStreaming*/false, progress);
+        emitLoadJobProgress(job, "touski.program.load", 1.0, ++samplesLoaded);
+        return sd;
+      };
+
+      sls::inst::SampleTouskiInstrument::ProgramState program;
+      juce::String err;
+      const bool ok = touskiInstrument.prepareProgram(payload, program, loadZone, &err);
+      std::shared_ptr<const sls::inst::SampleTouskiInstrument::ProgramState> replaced;
+      if (ok) {
+        analyseTouskiLoops(program);
+        std::scoped_lock lk(assetMutex);
+        replaced = touskiInstrument.installProgram(instId, std::move(program));
+        publishTouskiPrograms();
+      }
+      // Released here, outside the lock; once no published table holds it either, its samples
+      // become evictable.
+      replaced.reset();
+      samplePool.trim();
+
+      juce::DynamicObject::Ptr r = new juce::DynamicObject();
+      r->setProperty("jobId", job);
+      r->setProperty("instId", instId);
+      r->setProperty("ok", ok);
+      r->setProperty("samples", samplesLoaded);
+      if (!ok) r->setProperty("error", err.isNotEmpty() ? err : juce::String("Failed to load touski program"));
+      emitEvt("touski.program.ready", juce::var(r.get()));
+    });
+  }
+
+  // ------------------------------ Load jobs ------------------------------
+
+  juce::var loadJobData(int jobId) {
+    juce::DynamicObject::Ptr r = new juce::DynamicObject();
+    r->setProperty("jobId", jobId);
+    r->setProperty("pending", true);
+    return juce::var(r.get());
+  }
+
+  // Runs work(jobId, progress) on a decoder thread; progress becomes job.progress events (<= 10 Hz).
+  void submitLoadJob(int jobId, const juce::String& op,
+                     std::function<void(int, const sls::sampler::SamplePool::Progress&)> work) {
+    loadJobsPending.fetch_add(1);
+    sampleDecoder.submit([this, jobId, op, work = std::move(work)] {
+      double lastProgressMs = 0.0;
+      const sls::sampler::SamplePool::Progress progress = [&](double fraction) {
+        const double now = juce::Time::getMillisecondCounterHiRes();
+        if (now - lastProgressMs < 100.0) return;
+        lastProgressMs = now;
+        emitLoadJobProgress(jobId, op, fraction);
+      };
+      work(jobId, progress);
+      loadJobsPending.fetch_sub(1);
+    });
+  }
+
+  void emitLoadJobProgress(int jobId, const juce::String& op, double fraction, int samplesLoaded = -1) {
+    juce::DynamicObject::Ptr p = new juce::DynamicObject();
+    p->setProperty("jobId", jobId);
+    p->setProperty("op", op);
+    p->setProperty("progress", juce::jlimit(0.0, 1.0, fraction));
+    if (samplesLoaded >= 0) p->setProperty("samples", samplesLoaded);
+    emitEvt("job.progress", juce::var(p.get()));
   }
 
   void handleTouskiParamSet(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
@@ -2121,9 +2956,39 @@ void refreshMasterEq() {
     const auto instId = getStringProp(d, "instId", "touski");
     juce::ignoreUnused(instId);
     juce::String err;
-    if (!touskiInstrument.setParams(instId, juce::var(const_cast<juce::DynamicObject*>(d)), &err))
+    bool ok = false;
+    sls::inst::SampleTouskiInstrument::ProgramState program;
+    {
+      std::scoped_lock lk(assetMutex);
+      ok = touskiInstrument.setParams(instId, juce::var(const_cast<juce::DynamicObject*>(d)), &err);
+      if (ok) {
+        program = *touskiInstrument.getProgram(instId);
+        publishTouskiPrograms();
+      }
+    }
+    if (!ok)
       return resErr(op, id, "E_PARAM_SET_FAIL", err.isNotEmpty() ? err : juce::String("Failed to update touski params"));
     resOk(op, id, juce::var());
+
+    // Notes keep the requested loop points until the new seams are in (usually a cache hit).
+    loadJobsPending.fetch_add(1);
+    sampleDecoder.submit([this, instId, program = std::move(program)]() mutable {
+      analyseTouskiLoops(program);
+      {
+        std::scoped_lock lk(assetMutex);
+        touskiInstrument.adoptLoopPoints(instId, program);
+        publishTouskiPrograms();
+      }
+      loadJobsPending.fetch_sub(1);
+    });
+  }
+
+  // Decoder threads.
+  void analyseTouskiLoops(sls::inst::SampleTouskiInstrument::ProgramState& program) {
+    touskiInstrument.analyseLoops(program, [this](const std::shared_ptr<const SampleData>& sample,
+                                                  const sls::sampler::LoopSpec& spec) {
+      return loopPointCache.get(sample, spec);
+    });
   }
 
   void handleTouskiNoteOn(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
@@ -2135,20 +3000,32 @@ void refreshMasterEq() {
 
     sls::inst::SampleTouskiInstrument::VoiceSpec spec;
     juce::String err;
-    if (!touskiInstrument.buildVoiceOn(instId, mixCh, note, vel, spec, &err))
+    bool built = false;
+    {
+      std::scoped_lock lk(assetMutex);
+      built = touskiInstrument.buildVoiceOn(instId, mixCh, note, vel, spec, &err);
+    }
+    if (!built)
       return resErr(op, id, "E_NOT_LOADED", err.isNotEmpty() ? err : juce::String("Touski program not loaded"));
-    if (!spawnTouskiVoiceFromSpec(spec, &err))
-      return resErr(op, id, "E_VOICE_ALLOC", err.isNotEmpty() ? err : juce::String("Failed to spawn Touski voice"));
+    if (!spec.sample)
+      return resErr(op, id, "E_VOICE_ALLOC", "Touski sample not loaded");
+
+    RtCommand cmd;
+    cmd.type = RtCommandType::TouskiVoiceStart;
+    cmd.touskiVoice = spec;
+    if (!enqueueRtCommand(cmd))
+      return resErr(op, id, "E_BUSY", "Audio command queue full");
     resOk(op, id, juce::var());
   }
 
   void handleTouskiNoteOff(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
     if (!d) return resErr(op, id, "E_BAD_REQUEST", "Missing data");
-    const auto instId = getStringProp(d, "instId", "touski");
-    const int note = getIntProp(d, "note", 60);
-    const int mixCh = juce::jmax(1, getIntProp(d, "mixCh", 1));
-    releaseTouskiVoice(instId, mixCh, note);
-    resOk(op, id, juce::var());
+    ScheduledEvent ev;
+    ev.type   = "touski.note.off";
+    ev.instId = getStringProp(d, "instId", "touski");
+    ev.mixCh  = juce::jmax(1, getIntProp(d, "mixCh", 1));
+    ev.note   = getIntProp(d, "note", 60);
+    handleLiveEvent(op, id, ev);
   }
 
   // ------------------------------ Mixer ------------------------------
@@ -2288,42 +3165,279 @@ void refreshMasterEq() {
     resOk(op, id, juce::var());
   }
 
+  // Collects the subscribed meter frames from the latest telemetry snapshot (event pump thread),
+  // then asks the audio thread to restart peak hold.
+  void collectMeterFrames(std::vector<sls::ipc::ShmMeterFrame>& frames) {
+    frames.clear();
+
+    sls::ipc::ShmTelemetryData snapshot;
+    if (sls::ipc::readTelemetry(telemetry, snapshot)) telemetryRead = snapshot;
+
+    if (meterChannels.count(-1))
+      frames.push_back(telemetryRead.master);
+
+    for (int ch = 0; ch < telemetryRead.numChannels; ++ch)
+      if (meterChannels.count(ch))
+        frames.push_back(telemetryRead.channels[(size_t)ch]);
+
+    meterPeakReset.store(true);
+  }
+
   juce::var meterData() {
-    juce::Array<juce::var> frames;
+    collectMeterFrames(meterFrames);
 
-    auto addFrame = [&](int ch, float rL, float rR, float pL, float pR) {
+    juce::Array<juce::var> frames;
+    for (const auto& m : meterFrames) {
       juce::DynamicObject::Ptr f = new juce::DynamicObject();
-      juce::Array<juce::var> rms { rL, rR };
-      juce::Array<juce::var> peak { pL, pR };
-      f->setProperty("ch", ch);
+      juce::Array<juce::var> rms { m.rms[0], m.rms[1] };
+      juce::Array<juce::var> peak { m.peak[0], m.peak[1] };
+      f->setProperty("ch", m.ch);
       f->setProperty("rms", juce::var(rms));
       f->setProperty("peak", juce::var(peak));
       frames.add(juce::var(f.get()));
-    };
+    }
 
-    if (meterChannels.count(-1))
-      addFrame(-1, meterRmsL, meterRmsR, meterPeakL, meterPeakR);
+    juce::DynamicObject::Ptr d = new juce::DynamicObject();
+    d->setProperty("frames", juce::var(frames));
+    return juce::var(d.get());
+  }
 
-    for (int ch = 0; ch < channelCount; ++ch) {
-      if (!meterChannels.count(ch)) continue;
+  // ------------------------------ Binary IPC (shared memory) ------------------------------
+
+  static juce::File defaultBinaryIpcFile() {
+    const auto name = "sls-ipc-" + juce::String(SLS_GET_PID()) + ".shm";
+   #if JUCE_LINUX
+    const juce::File shmDir("/dev/shm"); // tmpfs: the mapping never touches disk
+    if (shmDir.isDirectory()) return shmDir.getChildFile(name);
+   #endif
+    return juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile(name);
+  }
+
+  void handleBinaryOpen(const juce::String& op, const juce::String& id, const juce::DynamicObject* d) {
+    const auto path = getStringProp(d, "path", "");
+    if (path.isNotEmpty() && !juce::File::isAbsolutePath(path))
+      return resErr(op, id, "E_BAD_REQUEST", "path must be an absolute file path");
+
+    closeBinaryTransport();
+
+    const juce::File file = path.isNotEmpty() ? juce::File(path) : defaultBinaryIpcFile();
+    const auto ringBytes = (uint32_t)juce::jlimit(0, 16 << 20, getIntProp(d, "ringBytes", 1 << 20));
+    juce::String error;
+    {
+      std::scoped_lock lk(shmWriteMutex);
+      if (!shm.open(file, ringBytes, error)) return resErr(op, id, "E_IPC", error);
+    }
+    binaryEvents.store(getBoolProp(d, "events", true));
+    binaryTelemetry.store(getBoolProp(d, "telemetry", true));
+    sharedTelemetry.store(shm.telemetry());
+    binaryRunning.store(true);
+    binaryThread = std::thread([this] { serveBinaryRequests(); });
+
+    juce::DynamicObject::Ptr r = new juce::DynamicObject();
+    r->setProperty("path", file.getFullPathName());
+    r->setProperty("version", (int)sls::ipc::kShmVersion);
+    r->setProperty("ringBytes", (int)shm.getRingBytes());
+    r->setProperty("toEngineOffset", (int)shm.getToEngineOffset());
+    r->setProperty("toClientOffset", (int)shm.getToClientOffset());
+    r->setProperty("telemetryOffset", (int)shm.getTelemetryOffset());
+    r->setProperty("events", binaryEvents.load());
+    r->setProperty("telemetry", binaryTelemetry.load());
+    resOk(op, id, juce::var(r.get()));
+  }
+
+  void closeBinaryTransport() {
+    binaryRunning.store(false);
+    if (binaryThread.joinable()) binaryThread.join();
+
+    // Detach the audio thread from the mapping before it goes away.
+    binaryTelemetry.store(false);
+    sharedTelemetry.store(nullptr);
+    while (sharedTelemetryBusy.load()) std::this_thread::yield();
+
+    std::scoped_lock lk(shmWriteMutex);
+    if (!shm.isOpen()) return;
+    const auto file = shm.getFile();
+    shm.close();
+    file.deleteFile();
+  }
+
+  // Reader thread: drains the client ring, then backs off to short sleeps when idle.
+  void serveBinaryRequests() {
+    int idle = 0;
+    while (binaryRunning.load()) {
+      const int n = shm.toEngine().read(
+          [this](sls::ipc::ShmMsgType type, const uint8_t* payload, uint32_t size) {
+            dispatchBinaryMessage(type, payload, size);
+          },
+          [this](sls::ipc::ShmMsgType type) { sendBinaryError(type, sls::ipc::ShmErrorCode::BadMessage); },
+          256);
+
+      if (n > 0) { idle = 0; continue; }
+      if (++idle < 64) std::this_thread::yield();
+      else std::this_thread::sleep_for(std::chrono::microseconds(250));
+    }
+  }
+
+  template <typename T>
+  static bool readBinaryPayload(const uint8_t* payload, uint32_t size, T& out) {
+    if (size < sizeof(T)) return false;
+    std::memcpy(&out, payload, sizeof(T));
+    return true;
+  }
+
+  // Same effect as the matching JSON op, without the JSON round trip. Errors go back on the ring.
+  void dispatchBinaryMessage(sls::ipc::ShmMsgType type, const uint8_t* payload, uint32_t size) {
+    using Msg = sls::ipc::ShmMsgType;
+    using sls::ipc::fixedString;
+
+    switch (type) {
+      case Msg::NoteOn:
+      case Msg::NoteOff: {
+        sls::ipc::ShmNote m;
+        if (!readBinaryPayload(payload, size, m)) break;
+        if (bouncing.load()) return sendBinaryError(type, sls::ipc::ShmErrorCode::Busy);
+        RtCommand cmd;
+        cmd.type = RtCommandType::LiveEvent;
+        cmd.event.type = type == Msg::NoteOn ? "note.on" : "note.off";
+        cmd.event.instId = fixedString(m.instId);
+        if (cmd.event.instId.isEmpty()) cmd.event.instId = "global";
+        cmd.event.mixCh = m.mixCh;
+        cmd.event.note = m.note;
+        cmd.event.vel = m.velocity;
+        cmd.sampleOffset = std::max(0, m.sampleOffset);
+        if (type == Msg::NoteOn) ensureNoteInstrument(cmd.event.instId);
+        if (!enqueueRtCommand(cmd)) sendBinaryError(type, sls::ipc::ShmErrorCode::QueueFull);
+        return;
+      }
+
+      case Msg::InstParamSet: {
+        sls::ipc::ShmInstParam m;
+        if (!readBinaryPayload(payload, size, m) || m.instId[0] == '\0' || m.param[0] == '\0') break;
+        if (bouncing.load()) return sendBinaryError(type, sls::ipc::ShmErrorCode::Busy);
+        juce::DynamicObject::Ptr params = new juce::DynamicObject();
+        params->setProperty(juce::Identifier(fixedString(m.param)), m.value);
+        juce::DynamicObject::Ptr o = new juce::DynamicObject();
+        o->setProperty("instId", fixedString(m.instId));
+        o->setProperty("params", juce::var(params.get()));
+        if (!setInstrumentParams(fixedString(m.instId), o.get()))
+          sendBinaryError(type, sls::ipc::ShmErrorCode::QueueFull);
+        return;
+      }
+
+      case Msg::MixerParamSet: {
+        sls::ipc::ShmMixerParam m;
+        if (!readBinaryPayload(payload, size, m) || m.param[0] == '\0') break;
+        if (bouncing.load()) return sendBinaryError(type, sls::ipc::ShmErrorCode::Busy);
+        juce::DynamicObject::Ptr o = new juce::DynamicObject();
+        o->setProperty("scope", m.scope == 0 ? "master" : "ch");
+        o->setProperty("ch", m.ch);
+        o->setProperty("param", fixedString(m.param));
+        o->setProperty("value", m.value);
+        if (!enqueueRtCommand(RtCommandType::MixerParamSet, juce::var(o.get())))
+          sendBinaryError(type, sls::ipc::ShmErrorCode::QueueFull);
+        return;
+      }
 
-      addFrame(ch,
-               meterChRmsL[(size_t)ch], meterChRmsR[(size_t)ch],
-               meterChPeakL[(size_t)ch], meterChPeakR[(size_t)ch]);
+      case Msg::SchedulePush: {
+        sls::ipc::ShmSchedulePush h;
+        if (!readBinaryPayload(payload, size, h)) break;
+        if ((uint64_t)size < sizeof(h) + (uint64_t)h.count * sizeof(sls::ipc::ShmScheduleEvent)) break;
+        if (bouncing.load()) return sendBinaryError(type, sls::ipc::ShmErrorCode::Busy);
+
+        static const char* const kKinds[] = { "note.on", "note.off", "touski.note.on", "touski.note.off" };
+        std::vector<ScheduledEvent> added;
+        added.reserve(h.count);
+        for (uint32_t i = 0; i < h.count; ++i) {
+          sls::ipc::ShmScheduleEvent e;
+          std::memcpy(&e, payload + sizeof(h) + (size_t)i * sizeof(e), sizeof(e));
+          if (e.kind < 0 || e.kind > 3) continue;
+
+          ScheduledEvent se;
+          se.atPpq = e.atPpq;
+          se.durPpq = e.durPpq;
+          se.type = kKinds[e.kind];
+          se.instId = fixedString(e.instId);
+          if (se.instId.isEmpty()) se.instId = "global";
+          se.mixCh = e.mixCh;
+          se.note = e.note;
+          se.vel = e.velocity;
+          if (e.kind == 0) ensureNoteInstrument(se.instId);
+          added.push_back(std::move(se));
+        }
+        std::scoped_lock lk(stateMutex);
+        if (!publishScheduledEvents(std::move(added)))
+          sendBinaryError(type, sls::ipc::ShmErrorCode::QueueFull);
+        return;
+      }
+
+      case Msg::Transport: {
+        sls::ipc::ShmTransport m;
+        if (!readBinaryPayload(payload, size, m)) break;
+        if (bouncing.load()) return sendBinaryError(type, sls::ipc::ShmErrorCode::Busy);
+
+        bool queued = true;
+        switch ((sls::ipc::ShmTransportAction)m.action) {
+          case sls::ipc::ShmTransportAction::Play:        queued = transportPlay(); break;
+          case sls::ipc::ShmTransportAction::Stop:        queued = transportStop(); break;
+          case sls::ipc::ShmTransportAction::SeekPpq:     queued = transportSeek(ppqToSamples(m.value)); break;
+          case sls::ipc::ShmTransportAction::SeekSamples: queued = transportSeek((juce::int64)m.value); break;
+          case sls::ipc::ShmTransportAction::SetTempo:    bpm.store(std::max(20.0, m.value)); break;
+          default: return sendBinaryError(type, sls::ipc::ShmErrorCode::BadMessage);
+        }
+        if (!queued) return sendBinaryError(type, sls::ipc::ShmErrorCode::QueueFull);
+        sendBinaryTransportState();
+        return;
+      }
 
-      // reset peaks for reported channels
-      meterChPeakL[(size_t)ch] = 0.0f;
-      meterChPeakR[(size_t)ch] = 0.0f;
+      // Padding and engine -> client messages are not requests.
+      case Msg::Pad:
+      case Msg::MeterLevel:
+      case Msg::TransportState:
+      case Msg::Error:
+      default:
+        break;
     }
 
-    juce::DynamicObject::Ptr d = new juce::DynamicObject();
-    d->setProperty("frames", juce::var(frames));
+    sendBinaryError(type, sls::ipc::ShmErrorCode::BadMessage);
+  }
 
-    // reset master peaks after reporting
-    meterPeakL = 0.0f;
-    meterPeakR = 0.0f;
+  bool writeBinary(sls::ipc::ShmMsgType type, const void* payload, uint32_t size) {
+    std::scoped_lock lk(shmWriteMutex);
+    return shm.isOpen() && shm.toClient().write(type, payload, size);
+  }
 
-    return juce::var(d.get());
+  void sendBinaryError(sls::ipc::ShmMsgType type, sls::ipc::ShmErrorCode code) {
+    sls::ipc::ShmError e {};
+    e.msgType = (uint16_t)type;
+    e.code = (int32_t)code;
+    writeBinary(sls::ipc::ShmMsgType::Error, &e, sizeof(e));
+  }
+
+  // Returns false when telemetry should go out as JSON instead.
+  bool sendBinaryTransportState() {
+    if (!binaryEvents.load() || !binaryRunning.load()) return false;
+
+    sls::ipc::ShmTransportState st {};
+    st.playing = (playing.load() || playArmed.load()) ? 1 : 0;
+    st.bpm = bpm.load();
+    st.samplePos = samplePos;
+    st.ppq = samplesToPpq(st.samplePos);
+    writeBinary(sls::ipc::ShmMsgType::TransportState, &st, sizeof(st));
+    return true;
+  }
+
+  bool sendBinaryMeters() {
+    if (!binaryEvents.load() || !binaryRunning.load()) return false;
+
+    collectMeterFrames(meterFrames);
+    sls::ipc::ShmMeterLevel h {};
+    h.count = (uint32_t)meterFrames.size();
+    binaryScratch.resize(sizeof(h) + meterFrames.size() * sizeof(sls::ipc::ShmMeterFrame));
+    std::memcpy(binaryScratch.data(), &h, sizeof(h));
+    if (!meterFrames.empty())
+      std::memcpy(binaryScratch.data() + sizeof(h), meterFrames.data(), meterFrames.size() * sizeof(sls::ipc::ShmMeterFrame));
+    writeBinary(sls::ipc::ShmMsgType::MeterLevel, binaryScratch.data(), (uint32_t)binaryScratch.size());
+    return true;
   }
 
   // ------------------------------ JSON I/O ------------------------------
@@ -2386,6 +3500,12 @@ void refreshMasterEq() {
     caps->setProperty("touski", true);
     caps->setProperty("sampler", true);
     caps->setProperty("vstHost", false);
+    caps->setProperty("offlineBounce", true);
+
+    juce::DynamicObject::Ptr binaryIpc = new juce::DynamicObject();
+    binaryIpc->setProperty("transport", "shm-ring");
+    binaryIpc->setProperty("version", (int)sls::ipc::kShmVersion);
+    caps->setProperty("binaryIpc", juce::var(binaryIpc.get()));
 
     juce::DynamicObject::Ptr d = new juce::DynamicObject();
     d->setProperty("protocol", "SLS-IPC/1.0");
@@ -2402,8 +3522,73 @@ void refreshMasterEq() {
     d->setProperty("ready", ready);
     d->setProperty("sampleRate", sampleRate);
     d->setProperty("bufferSize", bufferSize);
-    d->setProperty("cpuLoad", 0.0);
-    d->setProperty("xruns", 0);
+    d->setProperty("cpuLoad", callbackStats.snapshot().loadPercent / 100.0);
+    d->setProperty("xruns", (double)xrunCount());
+    d->setProperty("stats", engineStats());
+    return juce::var(d.get());
+  }
+
+  // Device-reported xruns (-1 when the driver does not report them).
+  int deviceXRunCount() {
+    std::scoped_lock lk(deviceMutex);
+    auto* device = useAudioDevice ? deviceManager.getCurrentAudioDevice() : nullptr;
+    return device ? device->getXRunCount() : -1;
+  }
+
+  uint64_t xrunCount() {
+    return callbackStats.getOverrunCount() + (uint64_t)juce::jmax(0, deviceXRunCount());
+  }
+
+  juce::var engineStats() {
+    const auto st = callbackStats.snapshot();
+    const int deviceXRuns = deviceXRunCount();
+
+    juce::DynamicObject::Ptr d = new juce::DynamicObject();
+    d->setProperty("blocks", (double)st.blocks);
+    d->setProperty("loadPct", st.loadPercent);
+    d->setProperty("loadP50Pct", st.p50Percent);
+    d->setProperty("loadP99Pct", st.p99Percent);
+    d->setProperty("loadMaxPct", st.maxPercent);
+    d->setProperty("blockUs", st.lastMicros);
+    d->setProperty("blockMaxUs", st.maxMicros);
+    d->setProperty("deadlineUs", st.deadlineMicros);
+    d->setProperty("overruns", (double)st.overruns);
+    d->setProperty("deviceXruns", deviceXRuns);
+    d->setProperty("xruns", (double)(st.overruns + (uint64_t)juce::jmax(0, deviceXRuns)));
+    d->setProperty("rtQueueOverflows", (double)rtQueueOverflowCount.load(std::memory_order_relaxed));
+    d->setProperty("nanSanitizedSamples", (double)nanSanitizedSamples.load(std::memory_order_relaxed));
+    d->setProperty("renderThreads", renderPool.getNumWorkers());
+    d->setProperty("loadJobsPending", loadJobsPending.load());
+
+    const auto ss = sampleStreamer.getStats();
+    juce::DynamicObject::Ptr stream = new juce::DynamicObject();
+    stream->setProperty("rings", ss.rings);
+    stream->setProperty("ringsInUse", ss.ringsInUse);
+    stream->setProperty("underruns", (double)ss.underruns);
+    stream->setProperty("claimFailures", (double)ss.claimFailures);
+    stream->setProperty("ringMB", (double)ss.ringBytes / (1024.0 * 1024.0));
+    d->setProperty("sampleStream", juce::var(stream.get()));
+
+    const auto ps = samplePool.getStats();
+    juce::DynamicObject::Ptr pool = new juce::DynamicObject();
+    pool->setProperty("entries", ps.entries);
+    pool->setProperty("referenced", ps.referenced);
+    pool->setProperty("hits", (double)ps.hits);
+    pool->setProperty("misses", (double)ps.misses);
+    pool->setProperty("deduplicated", (double)ps.deduplicated);
+    pool->setProperty("evictions", (double)ps.evictions);
+    pool->setProperty("MB", (double)ps.bytes / (1024.0 * 1024.0));
+    pool->setProperty("cachedMB", (double)ps.cachedBytes / (1024.0 * 1024.0));
+    pool->setProperty("budgetMB", (double)ps.budgetBytes / (1024.0 * 1024.0));
+    d->setProperty("samplePool", juce::var(pool.get()));
+
+    const auto cs = pcmDiskCache.getStats();
+    juce::DynamicObject::Ptr pcm = new juce::DynamicObject();
+    pcm->setProperty("hits", (double)cs.hits);
+    pcm->setProperty("misses", (double)cs.misses);
+    pcm->setProperty("writes", (double)cs.writes);
+    pcm->setProperty("evictions", (double)cs.evictions);
+    d->setProperty("pcmCache", juce::var(pcm.get()));
     return juce::var(d.get());
   }
 
@@ -2416,6 +3601,14 @@ void refreshMasterEq() {
     d->setProperty("channels", channelCount);
     d->setProperty("playPrerollMs", playPrerollMs.load());
     d->setProperty("schedulerDebug", schedulerDebug);
+    d->setProperty("renderThreads", renderThreads);
+    d->setProperty("sampleStreamThresholdSec", sampleStreamThresholdSec);
+    d->setProperty("sampleStreamBudgetMB", sampleStreamBudgetMB);
+    d->setProperty("sampleKeepOriginal", sampleKeepOriginal);
+    d->setProperty("sampleStorage", sampleStorageInt16 ? "int16" : "float");
+    d->setProperty("samplePoolBudgetMB", samplePoolBudgetMB);
+    d->setProperty("pcmCacheMB", pcmCacheMB);
+    d->setProperty("pcmCacheDir", pcmDiskCache.getDirectory().getFullPathName());
     return juce::var(d.get());
   }
 
@@ -2425,37 +3618,70 @@ void refreshMasterEq() {
     d->setProperty("bpm", bpm.load());
     d->setProperty("ppq", samplesToPpq(samplePos));
     d->setProperty("samplePos", (int)samplePos);
-    d->setProperty("mode", transportPlayMode);
-    d->setProperty("rangeStartPpq", transportRangeStartPpq);
-    d->setProperty("rangeEndPpq", transportRangeEndPpq);
-    d->setProperty("loopEnabled", transportLoopEnabled);
-    d->setProperty("stopAtEnd", transportStopAtEnd);
-    d->setProperty("returnToStartOnStop", transportReturnToStartOnStop);
+
+    std::shared_ptr<const Timeline> t;
+    {
+      std::scoped_lock lk(stateMutex);
+      t = publishedTimeline;
+    }
+    d->setProperty("mode", t->playMode);
+    d->setProperty("rangeStartPpq", t->rangeStartPpq);
+    d->setProperty("rangeEndPpq", t->rangeEndPpq);
+    d->setProperty("loopEnabled", t->loop);
+    d->setProperty("stopAtEnd", t->stopAtEnd);
+    d->setProperty("returnToStartOnStop", t->returnToStartOnStop);
     return juce::var(d.get());
   }
 
   // ------------------------------ Event pump thread ------------------------------
 
+  // Frees what the audio thread has let go of since the last publish, so a quiet session does
+  // not hold on to replaced instruments.
+  void collectReleased() {
+    instrumentTables.collect();
+    fmPatchLibrary.collect();
+    timelines.collect();
+    touskiProgramTables.collect();
+    retiredSamples.collect();
+  }
+
   void pumpEvents() {
     // Emit transport.state regularly so UI can be engine-authoritative.
     // Emit meter.level at requested fps.
+    // Emit engine.state (with callback statistics) once per second.
     juce::int64 lastTransport = 0;
     juce::int64 lastMeter = 0;
+    juce::int64 lastEngineState = nowMs();
 
     while (running.load()) {
       std::this_thread::sleep_for(std::chrono::milliseconds(10));
       const auto t = nowMs();
 
-      if (t - lastTransport >= 50) { // 20 Hz
+      // Not during a bounce: the program table the bounce started with is the one it renders.
+      if (touskiProgramsStale.load() && !bouncing.load()) {
+        std::scoped_lock lk(assetMutex);
+        if (touskiProgramsStale.load()) publishTouskiPrograms();
+      }
+
+      // A client reading the shared telemetry block polls meters and position itself.
+      const bool sharedTelemetryOn = binaryTelemetry.load() && binaryRunning.load();
+
+      if (t - lastTransport >= 50 && !sharedTelemetryOn) { // 20 Hz
         lastTransport = t;
-        emitEvt("transport.state", transportState());
+        if (!sendBinaryTransportState()) emitEvt("transport.state", transportState());
       }
 
-      if (meterSubscribed) {
+      if (t - lastEngineState >= 1000) { // 1 Hz
+        lastEngineState = t;
+        emitEvt("engine.state", engineState());
+        collectReleased();
+      }
+
+      if (meterSubscribed && !sharedTelemetryOn) {
         const int ms = std::max(1, 1000 / std::max(1, meterFps));
         if (t - lastMeter >= ms) {
           lastMeter = t;
-          emitEvt("meter.level", meterData());
+          if (!sendBinaryMeters()) emitEvt("meter.level", meterData());
         }
       }
     }
@@ -2464,7 +3690,46 @@ void refreshMasterEq() {
 
 } // namespace
 
-int main() {
+// sls-audio-engine --bounce <requests.jsonl>
+// Headless offline render: replays IPC requests (project setup, schedule.push..., render.bounce)
+// from a JSON-lines file without opening an audio device, waiting for each bounce to finish.
+static int runBounceCli(const char* requestsPath) {
+  const juce::File requests = juce::File::getCurrentWorkingDirectory().getChildFile(requestsPath);
+  if (!requests.existsAsFile()) {
+    std::cerr << "sls-audio-engine: cannot read " << requestsPath << std::endl;
+    return 2;
+  }
+  juce::StringArray lines;
+  requests.readLines(lines);
+
+  Engine engine(false);
+  bool bounced = false;
+  for (const auto& line : lines) {
+    if (line.trim().isEmpty()) continue;
+    juce::var msg;
+    if (!juce::JSON::parse(line, msg).wasOk()) continue;
+    engine.handle(msg);
+    engine.waitForLoadJobs();
+    engine.drainRtCommandsOffline();
+
+    if (engine.isBouncing()) {
+      bounced = true;
+      while (engine.isBouncing()) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      if (!engine.lastBounceSucceeded()) return 1;
+    }
+  }
+
+  if (!bounced) {
+    std::cerr << "sls-audio-engine: no render.bounce request in " << requestsPath << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc >= 3 && juce::String(argv[1]) == "--bounce")
+    return runBounceCli(argv[2]);
+
   Engine engine;
   std::string line;
 